@@ -0,0 +1,97 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fmt/format.h>
+
+#include "utils/ByteSearch.h"
+#include "utils/PerformanceAnalyzer.h"
+
+using namespace esynet::utils;
+
+/* 在 1 KB / 64 KB / 4 MB 的数据中查找位于末尾的分隔符，即整段扫描一遍
+ * search: 改造前的做法，每次构造临时 std::string 后调用 std::search
+ * 其余为 ByteSearch 中的各组实现，dispatch 为运行时选中的实现
+ * CRLF* 为每 4 个字节出现一次 '\r' 而其后不是 '\n' 的数据，衡量首字节密集时的表现 */
+
+const size_t kTotalBytes = 1024UL * 1024 * 1024;
+
+static void report(const char* name, const char* delimiter, size_t size, int64_t elapsed, size_t rounds) {
+    double seconds = static_cast<double>(elapsed) / 1e9;
+    fmt::print("{:8s} {:5s} size: {:>8}, rounds: {:>7}, GB/s: {:6.2f}\n",
+               name, delimiter, size, rounds, static_cast<double>(size) * rounds / seconds / 1e9);
+}
+
+int main() {
+    std::vector<const search::Kernels*> kernels { &search::kScalar };
+#ifdef ESYNET_SEARCH_X86
+    kernels.push_back(&search::kSse2);
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) kernels.push_back(&search::kAvx2);
+#endif
+    fmt::print("dispatch: {}\n", search::kernels().name);
+
+    TimeAnalyzer analyzer;
+    for(size_t size : { 1024UL, 64UL * 1024, 4UL * 1024 * 1024 }) {
+        std::string data(size, 'x');
+        data[size - 2] = '\r';
+        data[size - 1] = '\n';
+        const char* begin = data.data();
+        const char* end = begin + size;
+        size_t rounds = kTotalBytes / size;
+        size_t found = 0;
+
+        int64_t elapsed = analyzer.func([&] {
+            for(size_t i = 0; i < rounds; ++i) {
+                std::string eol = "\n";
+                found += std::search(begin, end, eol.begin(), eol.end()) - begin;
+            }
+        });
+        report("search", "EOL", size, elapsed, rounds);
+        elapsed = analyzer.func([&] {
+            for(size_t i = 0; i < rounds; ++i) {
+                std::string crlf = "\r\n";
+                found += std::search(begin, end, crlf.begin(), crlf.end()) - begin;
+            }
+        });
+        report("search", "CRLF", size, elapsed, rounds);
+
+        for(const search::Kernels* kernel : kernels) {
+            elapsed = analyzer.func([&] {
+                for(size_t i = 0; i < rounds; ++i) {
+                    found += kernel->findByte(begin, end, '\n') - begin;
+                }
+            });
+            report(kernel->name, "EOL", size, elapsed, rounds);
+            elapsed = analyzer.func([&] {
+                for(size_t i = 0; i < rounds; ++i) {
+                    found += kernel->findPair(begin, end, '\r', '\n') - begin;
+                }
+            });
+            report(kernel->name, "CRLF", size, elapsed, rounds);
+        }
+
+        std::string dense(size, 'x');
+        for(size_t i = 3; i + 2 < size; i += 4) dense[i] = '\r';
+        dense[size - 2] = '\r';
+        dense[size - 1] = '\n';
+        begin = dense.data();
+        end = begin + size;
+        elapsed = analyzer.func([&] {
+            for(size_t i = 0; i < rounds; ++i) {
+                std::string crlf = "\r\n";
+                found += std::search(begin, end, crlf.begin(), crlf.end()) - begin;
+            }
+        });
+        report("search", "CRLF*", size, elapsed, rounds);
+        for(const search::Kernels* kernel : kernels) {
+            elapsed = analyzer.func([&] {
+                for(size_t i = 0; i < rounds; ++i) {
+                    found += kernel->findPair(begin, end, '\r', '\n') - begin;
+                }
+            });
+            report(kernel->name, "CRLF*", size, elapsed, rounds);
+        }
+        if(found == 0) fmt::print("unexpected\n");
+    }
+    return 0;
+}
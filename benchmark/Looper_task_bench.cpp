@@ -0,0 +1,114 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <fmt/format.h>
+#include <sys/eventfd.h>
+#include <sys/poll.h>
+
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "utils/PerformanceAnalyzer.h"
+
+using namespace esynet;
+using namespace esynet::utils;
+
+/* 跨线程投递任务的吞吐对比
+ * legacy: 改造前的实现，互斥锁 + vector，每次跨线程 run 都写一次 eventfd
+ * looper: 无锁 MPSC 队列，仅使队列由空变为非空的生产者写 eventfd */
+
+const int kProducers = 4;
+const int kTasksPerProducer = 200000;
+
+class LegacyLooper {
+public:
+    LegacyLooper(): wakeupFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+    ~LegacyLooper() { close(wakeupFd_); }
+
+    void start() {
+        struct pollfd pfd{wakeupFd_, POLLIN, 0};
+        while(!stop_) {
+            if(::poll(&pfd, 1, Looper::kPollTimeMs) > 0) {
+                uint64_t temp;
+                eventfd_read(wakeupFd_, &temp);
+            }
+            std::vector<std::function<void()>> tasks;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                tasks.swap(tasks_);
+            }
+            for(auto& task : tasks) {
+                task();
+            }
+        }
+    }
+    void stop() { stop_ = true; wakeup(); }
+    void run(std::function<void()> func) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            tasks_.push_back(func);
+        }
+        wakeup();
+    }
+    uint64_t numOfWakeups() const { return numOfWakeups_; }
+
+private:
+    void wakeup() {
+        ++numOfWakeups_;
+        eventfd_write(wakeupFd_, 1);
+    }
+
+    int wakeupFd_;
+    std::mutex mutex_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> numOfWakeups_{0};
+    std::vector<std::function<void()>> tasks_;
+};
+
+/* 在 looper 线程中运行 LooperType，由 kProducers 个线程各投递 kTasksPerProducer 个任务 */
+template<typename LooperType>
+void bench(const char* name) {
+    const int total = kProducers * kTasksPerProducer;
+    int done = 0;
+    uint64_t wakeups = 0;
+    LooperType* looper = nullptr;
+    std::atomic<bool> ready{false};
+
+    std::thread loopThread([&] {
+        LooperType loop;
+        looper = &loop;
+        ready = true;
+        loop.start();
+        wakeups = loop.numOfWakeups();
+    });
+    while(!ready) std::this_thread::yield();
+
+    TimeAnalyzer analyzer;
+    int64_t elapsed = analyzer.func([&] {
+        std::vector<std::thread> producers;
+        for(int i = 0; i < kProducers; ++i) {
+            producers.emplace_back([&] {
+                for(int j = 0; j < kTasksPerProducer; ++j) {
+                    looper->run([&] {
+                        if(++done == total) looper->stop();
+                    });
+                }
+            });
+        }
+        for(auto& producer : producers) producer.join();
+        loopThread.join();
+    });
+    double seconds = TimeAnalyzer::toSeconds(elapsed);
+    fmt::print("{:8s} tasks: {}, time: {}, tasks/sec: {:.0f}, eventfd writes: {}, writes/sec: {:.0f}\n",
+               name, total, TimeAnalyzer::toString(elapsed, TimeAnalyzer::MILLISECONDS),
+               total / seconds, wakeups, wakeups / seconds);
+}
+
+int main() {
+    Logger::setLogger([](const std::string&) {});
+
+    bench<LegacyLooper>("legacy");
+    bench<Looper>("looper");
+    return 0;
+}
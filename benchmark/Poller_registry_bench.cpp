@@ -0,0 +1,58 @@
+#include <map>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <fmt/format.h>
+
+#include "net/poller/Poller.h"
+#include "utils/PerformanceAnalyzer.h"
+
+using namespace esynet;
+using namespace esynet::utils;
+
+/* 就绪事件分发时 fd -> Event* 的查找开销对比
+ * map:   改造前的 std::map<int, Event*>
+ * table: 以 fd 为下标的 poller::EventTable
+ * 每一轮模拟一次 poll 返回 kReadyPerPoll 个随机就绪的 fd */
+
+const int kReadyPerPoll = 64;
+const int kLookups = 2 * 1000 * 1000;
+
+static Event* fakeEvent(int fd) {
+    return reinterpret_cast<Event*>(static_cast<uintptr_t>(fd + 1) * 64);
+}
+
+template<typename Lookup>
+void bench(const char* name, size_t numFds, const std::vector<int>& ready, Lookup lookup) {
+    uintptr_t sum = 0;
+    TimeAnalyzer analyzer;
+    int64_t elapsed = analyzer.func([&] {
+        for(int i = 0; i < kLookups; i += kReadyPerPoll) {
+            for(int j = 0; j < kReadyPerPoll; ++j) {
+                sum += reinterpret_cast<uintptr_t>(lookup(ready[i + j]));
+            }
+        }
+    });
+    fmt::print("{:6s} fds: {:8d}, lookups: {}, time: {}, ns/lookup: {:.2f} (checksum {})\n",
+               name, numFds, kLookups, TimeAnalyzer::toString(elapsed, TimeAnalyzer::MILLISECONDS),
+               static_cast<double>(elapsed) / kLookups, sum % 1000);
+}
+
+int main() {
+    std::mt19937 rng(20240601);
+    for(size_t numFds : { 10000, 100000, 1000000 }) {
+        std::map<int, Event*> map;
+        poller::EventTable table;
+        for(size_t fd = 0; fd < numFds; ++fd) {
+            map[fd] = fakeEvent(fd);
+            table.insert(fd, fakeEvent(fd));
+        }
+        std::uniform_int_distribution<int> dist(0, numFds - 1);
+        std::vector<int> ready(kLookups);
+        for(int& fd : ready) fd = dist(rng);
+
+        bench("map", numFds, ready, [&](int fd) { return map.at(fd); });
+        bench("table", numFds, ready, [&](int fd) { return table.find(fd); });
+    }
+    return 0;
+}
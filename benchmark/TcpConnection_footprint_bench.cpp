@@ -0,0 +1,120 @@
+#include <memory>
+#include <vector>
+#include <malloc.h>
+#include <fmt/format.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "net/TcpConnection.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+
+using namespace esynet;
+using namespace esynet::utils;
+
+/* 空闲连接的内存占用：建立 kConnections 个不收发数据的连接，统计每个连接占用的堆内存
+ * copied:  改造前的方式，make_shared 分配，每个连接各自设置（拷贝）全部回调
+ * shared:  与 TcpServer 相同，分配在创建连接的 Looper 的 Slab 中，所有连接共享同一张回调表与配置
+ * limited: 同 shared，且每个连接都设置了带宽限制，扩展状态随之分配
+ * 每种方式在单独的子进程中运行，互不影响堆与 Buffer 内存块池的状态
+ *
+ * shared 方式下各阶段的结果：
+ *   改造前:                                  sizeof(TcpConnection): 824, heap bytes/conn: 1505
+ *   共享 Options，不常用状态移入扩展状态后:   sizeof(TcpConnection): 568, heap bytes/conn: 1249
+ *   ChainBuffer 以 vector 代替 deque 后:     sizeof(TcpConnection): 520, heap bytes/conn: 609 */
+
+const size_t kConnections = 10000;
+
+/* 以 std::bind 绑定的成员函数，与应用中常见的写法一致 */
+struct Handler {
+    void onConnection(TcpConnection&) {}
+    void onMessage(TcpConnection&, Buffer& buffer, Timestamp) { buffer.retrieveAll(); }
+    void onWriteComplete(TcpConnection&) {}
+    void onClose(TcpConnection&) {}
+    void onError(TcpConnection&) {}
+};
+
+static size_t heapBytes() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+enum Mode { kCopied, kShared, kLimited };
+
+static void bench(Mode mode, size_t connections) {
+    static const char* const kNames[] = { "copied", "shared", "limited" };
+    using namespace std::placeholders;
+    Looper looper;
+    Handler handler;
+    TcpConnection::Callbacks callbacks {
+        std::bind(&Handler::onConnection, &handler, _1),
+        std::bind(&Handler::onMessage, &handler, _1, _2, _3),
+        std::bind(&Handler::onWriteComplete, &handler, _1),
+        TcpConnection::defaultHighWaterMarkCallback,
+        std::bind(&Handler::onClose, &handler, _1),
+        std::bind(&Handler::onError, &handler, _1),
+    };
+    auto table = std::make_shared<const TcpConnection::Callbacks>(callbacks);
+    auto prefix = std::make_shared<const std::string>("Footprint");
+    std::vector<TcpConnection::TcpConnectionPtr> conns;
+    std::vector<int> peers;
+    conns.reserve(connections);
+    peers.reserve(connections);
+
+    size_t before = heapBytes();
+    for(size_t i = 0; i < connections; ++i) {
+        int fds[2];
+        if(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) break;
+        peers.push_back(fds[1]);
+        TcpConnection::TcpConnectionPtr conn;
+        if(mode != kCopied) {
+            conn = std::allocate_shared<TcpConnection>(SlabAllocator<TcpConnection>(looper.slab()),
+                                                       looper, i, prefix, Socket(fds[0]), NetAddress(), NetAddress());
+            conn->setCallbacks(table);
+        } else {
+            conn = std::make_shared<TcpConnection>(looper, i, prefix, Socket(fds[0]), NetAddress(), NetAddress());
+            conn->setConnectionCallback(callbacks.connection);
+            conn->setMessageCallback(callbacks.message);
+            conn->setWriteCompleteCallback(callbacks.writeComplete);
+            conn->setCloseCallback(callbacks.close);
+            conn->setErrorCallback(callbacks.error);
+        }
+        if(mode == kLimited) {
+            conn->setRateLimit(1e9, 1e9);
+        }
+        conn->connectComplete();
+        conns.push_back(std::move(conn));
+    }
+    size_t used = heapBytes() - before;
+    /* conns 与 peers 预先分配，不计入差值 */
+    fmt::print("{:7s} connections: {}, sizeof(TcpConnection): {}, heap bytes/conn: {:.0f}\n",
+               kNames[mode], conns.size(), sizeof(TcpConnection),
+               conns.empty() ? 0.0 : static_cast<double>(used) / conns.size());
+
+    for(auto& conn : conns) conn->forceCloseWithoutCallback();
+    for(int fd : peers) ::close(fd);
+}
+
+int main() {
+    Logger::setLogger([](const std::string&) {});
+
+    /* 每个连接占用两个描述符 */
+    struct rlimit limit;
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    size_t connections = std::min<size_t>(kConnections, (limit.rlim_cur - 64) / 2);
+
+    for(Mode mode : { kCopied, kShared, kLimited }) {
+        pid_t pid = ::fork();
+        if(pid == 0) {
+            bench(mode, connections);
+            return 0;
+        }
+        ::waitpid(pid, nullptr, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <fmt/format.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "utils/PerformanceAnalyzer.h"
+
+using namespace esynet;
+using namespace esynet::utils;
+
+/* 回环上的 echo 吞吐对比
+ * epoll:    EpollPoller + 就绪式 I/O（read/write 系统调用）
+ * uring-rd: IoUringPoller + 就绪式 I/O
+ * uring-cp: IoUringPoller + 完成式 I/O（multishot recv + 内核挑选缓冲区）
+ * 每个客户端连接以 ping-pong 的方式发送 kRounds 条消息，统计服务端的消息数与字节数 */
+
+const int kConnections = 8;
+const int kRounds = 20000;
+const int kBasePort = 23400;
+
+struct Config {
+    const char* name;
+    Looper::Backend backend;
+    TcpConnection::IoMode ioMode;
+};
+
+static int connectTo(int port) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for(int retry = 0; retry < 100; ++retry) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0) {
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+            return fd;
+        }
+        ::close(fd);
+        usleep(10000);
+    }
+    return -1;
+}
+
+static bool pingPong(int fd, const std::string& message, std::string& buffer) {
+    size_t size = message.size();
+    for(int i = 0; i < kRounds; ++i) {
+        if(::write(fd, message.data(), size) != static_cast<ssize_t>(size)) return false;
+        size_t got = 0;
+        while(got < size) {
+            ssize_t n = ::read(fd, buffer.data() + got, size - got);
+            if(n <= 0) return false;
+            got += n;
+        }
+    }
+    return true;
+}
+
+void bench(const Config& config, size_t messageSize, int port) {
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::thread serverThread([&] {
+        TcpServer echo(port, "Echo", config.backend);
+        echo.setIoMode(config.ioMode);
+        echo.setConnectionCallback([](TcpConnection&) {});
+        echo.setWriteCompleteCallback([](TcpConnection&) {});
+        echo.setCloseCallback([](TcpConnection&) {});
+        echo.setMessageCallback([](TcpConnection& conn, Buffer& buffer, Timestamp) {
+            conn.send(buffer.retrieveAllAsString());
+        });
+        server = &echo;
+        ready = true;
+        echo.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    std::atomic<int> failed{0};
+    std::vector<int> fds;
+    for(int i = 0; i < kConnections; ++i) {
+        fds.push_back(connectTo(port));
+    }
+
+    TimeAnalyzer analyzer;
+    int64_t elapsed = analyzer.func([&] {
+        std::vector<std::thread> clients;
+        for(int fd : fds) {
+            clients.emplace_back([&, fd] {
+                std::string message(messageSize, 'x');
+                std::string buffer(messageSize, '\0');
+                if(fd < 0 || !pingPong(fd, message, buffer)) ++failed;
+            });
+        }
+        for(auto& client : clients) client.join();
+    });
+    for(int fd : fds) {
+        if(fd >= 0) ::close(fd);
+    }
+    uint64_t changes = 0, commits = 0;
+    server->looper().run([&] {
+        changes = server->looper().poller().numOfChanges();
+        commits = server->looper().poller().numOfCommits();
+        server->shutdown();
+    });
+    serverThread.join();
+
+    double seconds = TimeAnalyzer::toSeconds(elapsed);
+    double messages = static_cast<double>(kConnections) * kRounds;
+    fmt::print("{:8s} size: {:6d}, time: {}, msgs/sec: {:.0f}, MB/sec: {:.1f}, "
+               "interest changes: {}, committed: {}{}\n",
+               config.name, messageSize, TimeAnalyzer::toString(elapsed, TimeAnalyzer::MILLISECONDS),
+               messages / seconds, messages * messageSize / seconds / 1024 / 1024,
+               changes, commits, failed ? fmt::format(", failed connections: {}", failed.load()) : "");
+}
+
+int main() {
+    Logger::setLogger([](const std::string&) {});
+
+    const Config configs[] = {
+        { "epoll",    Looper::kEpoll,   TcpConnection::kReadiness  },
+        { "uring-rd", Looper::kIoUring, TcpConnection::kReadiness  },
+        { "uring-cp", Looper::kIoUring, TcpConnection::kCompletion },
+    };
+    int port = kBasePort;
+    for(size_t messageSize : { 64, 4096, 16384 }) {
+        for(const Config& config : configs) {
+            bench(config, messageSize, port++);
+        }
+    }
+    return 0;
+}
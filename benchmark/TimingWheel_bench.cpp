@@ -0,0 +1,67 @@
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <fmt/format.h>
+
+#include "net/timer/TimingWheel.h"
+#include "utils/PerformanceAnalyzer.h"
+
+using namespace esynet::timer;
+using namespace esynet::utils;
+
+/* 连接空闲超时场景：kTimers 个定时器，每次 I/O 取消旧定时器并以新的到期刻度重新添加
+ * map:   改造前按到期时间排序的 std::multimap（允许相同到期时间）
+ * wheel: 分层时间轮，节点为 Timer 自身 */
+
+const int kTimers = 500 * 1000;
+const int kRounds = 4;
+const uint64_t kTimeout = 30 * 1000;
+
+int main() {
+    std::mt19937 rng(20240601);
+    std::uniform_int_distribution<uint64_t> jitter(0, 1000);
+    std::vector<std::unique_ptr<Timer>> timers;
+    for(int i = 0; i < kTimers; ++i) {
+        timers.push_back(std::make_unique<Timer>([] {}, Timestamp(), 0));
+    }
+    std::vector<uint64_t> deadlines(static_cast<size_t>(kTimers) * kRounds);
+    for(size_t i = 0; i < deadlines.size(); ++i) {
+        deadlines[i] = kTimeout + i / 1000 + jitter(rng);
+    }
+
+    using TimerMap = std::multimap<uint64_t, Timer*>;
+    TimerMap map;
+    std::vector<TimerMap::iterator> positions(kTimers);
+    TimeAnalyzer analyzer;
+    int64_t elapsed = analyzer.func([&] {
+        for(int i = 0; i < kTimers; ++i) {
+            positions[i] = map.emplace(deadlines[i], timers[i].get());
+        }
+        for(size_t i = kTimers; i < deadlines.size(); ++i) {
+            size_t index = i % kTimers;
+            map.erase(positions[index]);
+            positions[index] = map.emplace(deadlines[i], timers[index].get());
+        }
+    });
+    fmt::print("{:6s} timers: {}, reschedules: {}, time: {}, ns/op: {:.1f}\n",
+               "map", kTimers, deadlines.size(), TimeAnalyzer::toString(elapsed, TimeAnalyzer::MILLISECONDS),
+               static_cast<double>(elapsed) / deadlines.size());
+
+    TimingWheel wheel(0);
+    elapsed = analyzer.func([&] {
+        for(int i = 0; i < kTimers; ++i) {
+            wheel.insert(timers[i].get(), deadlines[i]);
+        }
+        for(size_t i = kTimers; i < deadlines.size(); ++i) {
+            Timer* timer = timers[i % kTimers].get();
+            wheel.remove(timer);
+            wheel.insert(timer, deadlines[i]);
+        }
+    });
+    fmt::print("{:6s} timers: {}, reschedules: {}, time: {}, ns/op: {:.1f}\n",
+               "wheel", kTimers, deadlines.size(), TimeAnalyzer::toString(elapsed, TimeAnalyzer::MILLISECONDS),
+               static_cast<double>(elapsed) / deadlines.size());
+    return 0;
+}
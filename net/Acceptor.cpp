@@ -8,6 +8,8 @@
 
 using esynet::Acceptor;
 
+const int Acceptor::kEdgeAcceptBudget = 64;
+
 Acceptor::Acceptor(Looper& looper, const NetAddress& localAddr):
                     looper_(looper),
                     acceptEvent_(looper, acceptSocket_.fd()),
@@ -29,6 +31,11 @@ Acceptor::~Acceptor() {
 void Acceptor::setAcceptCallback(AcceptCallback cb) {
     acceptCb_ = std::move(cb);
 }
+void Acceptor::setEdgeTriggered(bool on) {
+    looper_.run([this, on] {
+        acceptEvent_.setEdgeTriggered(on);
+    });
+}
 bool Acceptor::listening() const {
     return listen_;
 }
@@ -45,17 +52,44 @@ void Acceptor::shutdown() {
     listen_ = false;
     acceptEvent_.cancel();
 }
+void Acceptor::pause() {
+    looper_.assert();
+
+    if(!listen_ || paused_) return;
+    paused_ = true;
+    acceptEvent_.disableRead();
+}
+void Acceptor::resume() {
+    looper_.assert();
+
+    if(!listen_ || !paused_) return;
+    paused_ = false;
+    acceptEvent_.enableRead();
+}
+bool Acceptor::paused() const {
+    return paused_;
+}
 
+/* 水平触发时每次就绪只接受一个连接，边沿触发时接受至 EAGAIN 或预算耗尽 */
 void Acceptor::onAccept() {
     looper_.assert();
 
-    NetAddress peerAddr;
-    try {
-        Socket connSocket = acceptSocket_.accept(peerAddr);
-        if(acceptCb_) {
-            acceptCb_(connSocket, peerAddr);
+    /* 暂停之前被推迟的事件 */
+    if(paused_) return;
+    for(int round = 0; round < kEdgeAcceptBudget; ++round) {
+        NetAddress peerAddr;
+        try {
+            Socket connSocket = acceptSocket_.accept(peerAddr);
+            if(acceptCb_) {
+                acceptCb_(connSocket, peerAddr);
+            }
+        } catch(exception::NetworkException& e) {
+            if(e.err() != EAGAIN && e.err() != EWOULDBLOCK) {
+                LOG_ERROR("{}", e.detail());
+            }
+            return;
         }
-    } catch(exception::NetworkException& e) {
-        LOG_ERROR("{}", e.detail());
+        if(!acceptEvent_.edgeTriggered()) return;
     }
+    acceptEvent_.defer(Event::kReadEvent);
 }
\ No newline at end of file
@@ -18,14 +18,22 @@ class Acceptor : public utils::NonCopyable {
 private:
     using AcceptCallback = std::function<void(Socket, const NetAddress&)>;
 
+public:
+    static const int kEdgeAcceptBudget;     /* 边沿触发时单次事件至多接受的连接数 */
+
 public:
     Acceptor(Looper&, const NetAddress& localAddr);
     ~Acceptor();
 
     void setAcceptCallback(AcceptCallback);
+    void setEdgeTriggered(bool);
     bool listening() const;
     void listen();
     void shutdown();
+    /* 暂停与恢复接受新连接，暂停期间新连接留在内核的 backlog 中 */
+    void pause();
+    void resume();
+    bool paused() const;
 
 private:
     void onAccept();
@@ -36,6 +44,7 @@ private:
     Event  acceptEvent_;
     AcceptCallback acceptCb_;
     std::atomic<bool> listen_{false};
+    std::atomic<bool> paused_{false};
 };
 
 } /* namespace esynet */
\ No newline at end of file
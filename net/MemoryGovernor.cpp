@@ -0,0 +1,150 @@
+#include "net/MemoryGovernor.h"
+
+/* Standard headers */
+#include <algorithm>
+
+/* Local headers */
+#include "logger/Logger.h"
+#include "net/Acceptor.h"
+#include "net/base/Looper.h"
+
+using esynet::MemoryGovernor;
+
+MemoryGovernor::MemoryGovernor(Acceptor& acceptor): acceptor_(acceptor) {}
+
+void MemoryGovernor::setBudget(Budget budget) {
+    budget_ = budget;
+    limit_.store(budget.limit, std::memory_order_relaxed);
+}
+auto MemoryGovernor::budget() const -> const Budget& {
+    return budget_;
+}
+
+auto MemoryGovernor::stats() const -> Stats {
+    Stats stats;
+    stats.usage         = usage_.load(std::memory_order_relaxed);
+    stats.limit         = limit_.load(std::memory_order_relaxed);
+    stats.level         = static_cast<Level>(level_.load(std::memory_order_relaxed));
+    stats.pausedReaders = numOfPaused_.load(std::memory_order_relaxed);
+    stats.reconciles    = reconciles_.load(std::memory_order_relaxed);
+    stats.acceptPauses  = acceptPauses_.load(std::memory_order_relaxed);
+    stats.readPauses    = readPauses_.load(std::memory_order_relaxed);
+    stats.sheds         = sheds_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+auto MemoryGovernor::threshold(double ratio) const -> size_t {
+    return static_cast<size_t>(static_cast<double>(budget_.limit) * ratio);
+}
+
+/* 各级响应互相独立地判断，占用一次越过多个阈值时在同一次汇总中全部生效 */
+void MemoryGovernor::reconcile(size_t usage, const ConnectionMap& connections) {
+    increase(reconciles_, 1);
+    usage_.store(usage, std::memory_order_relaxed);
+    if(budget_.limit == 0) return;
+
+    Level level = kNormal;
+    if(usage >= threshold(budget_.acceptRatio)) {
+        level = kNoAccept;
+        if(!acceptPaused_ && acceptor_.listening()) {
+            LOG_WARN("Buffer usage {} of {} bytes, stop accepting", usage, budget_.limit);
+            acceptor_.pause();
+            acceptPaused_ = true;
+            increase(acceptPauses_, 1);
+        }
+    }
+    if(usage >= threshold(budget_.pauseRatio)) {
+        level = kPauseRead;
+        pauseLargest(usage, connections);
+    }
+    if(usage >= threshold(budget_.shedRatio)) {
+        level = kShed;
+        shedLargest(usage, connections);
+    }
+    if(usage < threshold(budget_.resumeRatio)) {
+        release();
+    }
+    level_.store(level, std::memory_order_relaxed);
+}
+
+void MemoryGovernor::release() {
+    if(acceptPaused_) {
+        LOG_INFO("Buffer usage {} of {} bytes, resume accepting", usage_.load(), budget_.limit);
+        acceptor_.resume();
+        acceptPaused_ = false;
+    }
+    resumeReaders();
+}
+
+auto MemoryGovernor::largest(const ConnectionMap& connections, bool skipPaused) const -> std::vector<TcpConnectionPtr> {
+    /* 占用在其他线程中变化，先取一次快照再排序，保证比较的一致 */
+    std::vector<std::pair<size_t, TcpConnectionPtr>> ranked;
+    ranked.reserve(connections.size());
+    for(const TcpConnectionPtr& conn : connections) {
+        if(skipPaused && isPaused(*conn)) continue;
+        size_t footprint = conn->bufferFootprint();
+        if(footprint > 0) ranked.emplace_back(footprint, conn);
+    }
+    size_t count = std::min(ranked.size(), budget_.maxVictims);
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                      [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+    std::vector<TcpConnectionPtr> victims;
+    victims.reserve(count);
+    for(size_t i = 0; i < count; ++i) {
+        victims.push_back(std::move(ranked[i].second));
+    }
+    return victims;
+}
+
+/* 暂停读取不会立即释放内存，只阻止占用最大的连接继续增长，
+ * 被暂停的连接的占用之和覆盖超出 resumeRatio 的部分即可 */
+void MemoryGovernor::pauseLargest(size_t usage, const ConnectionMap& connections) {
+    size_t excess = usage - std::min(usage, threshold(budget_.resumeRatio));
+    size_t covered = 0;
+    for(auto iter = pausedReaders_.begin(); iter != pausedReaders_.end(); ) {
+        if(auto paused = iter->second.lock()) {
+            covered += paused->bufferFootprint();
+            ++iter;
+        } else {
+            iter = pausedReaders_.erase(iter);
+        }
+    }
+    if(covered >= excess) return;
+    for(const TcpConnectionPtr& conn : largest(connections, true)) {
+        if(covered >= excess) break;
+        covered += conn->bufferFootprint();
+        conn->pauseReading();
+        pausedReaders_[conn.get()] = conn;
+        increase(readPauses_, 1);
+        LOG_WARN("Buffer usage {} of {} bytes, pause reading {}", usage, budget_.limit, conn->name());
+    }
+    numOfPaused_.store(pausedReaders_.size(), std::memory_order_relaxed);
+}
+
+/* 关闭在连接所属的 Looper 中进行，占用在下一次汇总时才会反映出来 */
+void MemoryGovernor::shedLargest(size_t usage, const ConnectionMap& connections) {
+    size_t target = threshold(budget_.pauseRatio);
+    for(const TcpConnectionPtr& conn : largest(connections, false)) {
+        if(usage < target) break;
+        usage -= std::min(usage, conn->bufferFootprint());
+        increase(sheds_, 1);
+        LOG_WARN("Buffer usage exceeds {} bytes, shed {} holding {} bytes",
+                 budget_.limit, conn->name(), conn->bufferFootprint());
+        conn->looper().run([conn] {
+            conn->forceClose();
+        });
+    }
+}
+
+void MemoryGovernor::resumeReaders() {
+    for(auto& [conn, weak] : pausedReaders_) {
+        if(auto paused = weak.lock()) paused->resumeReading();
+    }
+    pausedReaders_.clear();
+    numOfPaused_.store(0, std::memory_order_relaxed);
+}
+
+bool MemoryGovernor::isPaused(const TcpConnection& conn) const {
+    auto iter = pausedReaders_.find(&conn);
+    return iter != pausedReaders_.end() && !iter->second.expired();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+/* Standard headers */
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+/* Local headers */
+#include "net/TcpConnection.h"
+#include "utils/NonCopyable.h"
+#include "utils/SlotMap.h"
+
+namespace esynet {
+
+class Acceptor;
+
+/* 所有 Reactor 上连接读写缓冲区的总内存预算
+ *
+ * 各 Looper 以原子加无锁地累计本线程连接的缓冲区占用（LooperMetrics::Snapshot::bufferBytes），
+ * 由主 Looper 周期性地汇总，按占用比例逐级响应：
+ *   acceptRatio 以上  暂停 Acceptor 接受新连接
+ *   pauseRatio  以上  暂停占用最大的若干连接的读取，直到它们的占用覆盖超出的部分
+ *   shedRatio   以上  强制关闭占用最大的连接，直到预计的占用回到 pauseRatio 以下
+ * 占用降到 resumeRatio 以下时恢复接受与被暂停的读取
+ * 除 stats() 外非线程安全，只在主 Looper 线程中使用 */
+class MemoryGovernor : public utils::NonCopyable {
+public:
+    using TcpConnectionPtr = TcpConnection::TcpConnectionPtr;
+    using ConnectionMap    = utils::SlotMap<TcpConnectionPtr>;
+
+    enum Level { kNormal, kNoAccept, kPauseRead, kShed };
+
+    struct Budget {
+        size_t limit        {0};        /* 字节数，0 表示不限制 */
+        double acceptRatio  {0.8};
+        double pauseRatio   {0.9};
+        double shedRatio    {1.0};
+        double resumeRatio  {0.7};
+        double intervalMs   {100.0};    /* 汇总的周期 */
+        size_t maxVictims   {64};       /* 每次至多暂停或关闭的连接数 */
+    };
+
+    struct Stats {
+        size_t   usage          {0};    /* 最近一次汇总的占用 */
+        size_t   limit          {0};
+        Level    level          {kNormal};
+        size_t   pausedReaders  {0};    /* 当前被暂停读取的连接数 */
+        uint64_t reconciles     {0};
+        uint64_t acceptPauses   {0};    /* 暂停接受新连接的次数 */
+        uint64_t readPauses     {0};    /* 暂停读取的连接数，累计 */
+        uint64_t sheds          {0};    /* 强制关闭的连接数，累计 */
+    };
+
+public:
+    explicit MemoryGovernor(Acceptor&);
+
+    void setBudget(Budget);
+    auto budget() const -> const Budget&;
+    /* 以各 Reactor 汇总的占用做一次调整，connections 为服务器当前的全部连接 */
+    void reconcile(size_t usage, const ConnectionMap& connections);
+    /* 恢复接受与全部被暂停的读取 */
+    void release();
+
+    /* 线程安全 */
+    auto stats() const -> Stats;
+
+private:
+    auto threshold(double ratio) const -> size_t;
+    /* 按占用从大到小排列，至多 maxVictims 个，跳过已被暂停的连接 */
+    auto largest(const ConnectionMap&, bool skipPaused) const -> std::vector<TcpConnectionPtr>;
+    void pauseLargest(size_t usage, const ConnectionMap&);
+    void shedLargest(size_t usage, const ConnectionMap&);
+    void resumeReaders();
+    bool isPaused(const TcpConnection&) const;
+
+    static void increase(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    Acceptor& acceptor_;
+    Budget budget_;
+    bool acceptPaused_ {false};
+    /* 已失效的 weak_ptr 表示连接已经析构，地址可能被新连接复用 */
+    std::unordered_map<const TcpConnection*, std::weak_ptr<TcpConnection>> pausedReaders_;
+
+    std::atomic<size_t>   usage_         {0};
+    std::atomic<size_t>   limit_         {0};
+    std::atomic<int>      level_         {kNormal};
+    std::atomic<size_t>   numOfPaused_   {0};
+    std::atomic<uint64_t> reconciles_    {0};
+    std::atomic<uint64_t> acceptPauses_  {0};
+    std::atomic<uint64_t> readPauses_    {0};
+    std::atomic<uint64_t> sheds_         {0};
+};
+
+} /* namespace esynet */
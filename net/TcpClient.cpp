@@ -8,9 +8,10 @@ using esynet::Looper;
 
 TcpClient::TcpClient(NetAddress addr,
                     utils::StringPiece name,
-                    bool useEpoll) :
-                    looper_(useEpoll),
-                    name_(name.asString()) {
+                    Looper::Backend backend) :
+                    looper_(backend),
+                    name_(name.asString()),
+                    namePrefix_(std::make_shared<const std::string>(name_)) {
     connector_ = std::make_unique<Connector>(looper_, addr);
     connectionCb_    = TcpConnection::defaultConnectionCallback;
     messageCb_       = TcpConnection::defaultMessageCallback;
@@ -91,9 +92,9 @@ void TcpClient::onConnection(Socket socket, NetAddress peer) {
     } else {
         local = localPkg.value();
     }
-    std::string name = name_ + peer.ip() + std::to_string(peer.port());
     TcpConnectionPtr conn = std::make_shared<TcpConnection>(looper_,
-                                                            name,
+                                                            nextId_++,
+                                                            namePrefix_,
                                                             socket,
                                                             local,
                                                             peer);
@@ -28,7 +28,7 @@ private:
 public:
     TcpClient(NetAddress serverAddr,
               utils::StringPiece name = "Client",
-              bool useEpoll = true);
+              Looper::Backend backend = Looper::kEpoll);
     ~TcpClient();
 
     void connect();
@@ -65,6 +65,9 @@ private:
     WriteCompleteCallback writeCompleteCb_;
 
     const std::string name_;
+    const TcpConnection::NamePtr namePrefix_;
+    /* 每次重新连接使用新的编号 */
+    TcpConnection::ID nextId_ {1};
 };
 
 } /* namespace esynet */
\ No newline at end of file
@@ -1,17 +1,107 @@
 #include "net/TcpConnection.h"
 
+/* Standard headers */
+#include <cmath>
+#include <chrono>
+#include <climits>
+#include <algorithm>
+#include <fmt/format.h>
+
 /* Local headers */
 #include "logger/Logger.h"
 #include "net/base/NetAddress.h"
 #include "net/base/Looper.h"
+#include "net/base/ZeroCopyReaper.h"
+#include "net/poller/IoUringPoller.h"
 #include "exception/SocketException.h"
+#include "net/timer/TimerQueue.h"
+
+/* Linux headers */
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
 
 using esynet::TcpConnection;
 using esynet::NetAddress;
 using esynet::Looper;
+using esynet::Logger;
 using std::optional;
+using esynet::poller::IoUringPoller;
+using esynet::timer::TimerQueue;
 using TcpInfo = esynet::Socket::TcpInfo;
 
+/* 边沿触发时单次事件处理的读写预算，耗尽后推迟到下一轮，避免饿死其他连接 */
+const size_t TcpConnection::kEdgeBytesBudget  = 256_KB;
+const int    TcpConnection::kEdgeRoundsBudget = 16;
+/* 更短的数据锁定页面与处理完成通知的开销超过拷贝本身 */
+const size_t TcpConnection::kZeroCopyThreshold = 32_KB;
+/* 积攒的令牌太少时恢复读写只能传输很少的数据，唤醒的开销与传输的数据不成比例 */
+const size_t TcpConnection::kRateQuantum = 4_KB;
+/* 读取大小估计的下限，以及新样本的权重 1 / 2^kReadEstimateShift */
+static const size_t kMinReadSize       = 512_B;
+static const int    kReadEstimateShift = 2;
+
+/* 完成式发送不能使用 sendfile，文件分段每次读入这么多字节再提交 */
+static const size_t kFileChunkSize = 64_KB;
+
+/* 接收缓冲区组被取空后重新提交接收请求的间隔，以及告警的最小间隔，单位：毫秒 */
+static const double  kNoBufferRetryMs        = 1.0;
+static const int64_t kNoBufferWarnIntervalMs = 1000;
+
+/* 同一 Looper 上的连接共享缓冲区组，告警按线程限频，期间被抑制的次数随下一次告警输出 */
+static void warnNoBuffer(int fd) {
+    thread_local int64_t lastWarnMs = INT64_MIN / 2;
+    thread_local uint64_t suppressed = 0;
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count();
+    if(now - lastWarnMs < kNoBufferWarnIntervalMs) {
+        ++suppressed;
+        return;
+    }
+    LOG_WARN("No receive buffer available(fd: {}, suppressed: {})", fd, suppressed);
+    lastWarnMs = now;
+    suppressed = 0;
+}
+
+/* 完成式 I/O 请求的标记 */
+static const uint8_t kRecvTag = 1;
+static const uint8_t kSendTag = 2;
+
+/* 完成式发送中交给内核的数据与 msghdr，请求结束之前必须保持有效 */
+struct TcpConnection::InflightSend {
+    utils::ChainBuffer data;
+    std::vector<struct iovec> iov;
+    struct msghdr msg;
+};
+
+/* 不常用的功能的状态，由第一次用到的 setter 或 connectComplete 分配，之后保持到连接析构 */
+struct TcpConnection::Extension {
+    /* 带宽限制 */
+    RateMeter readMeter;
+    RateMeter writeMeter;
+    timer::Timer::ID readThrottle  {-1};
+    timer::Timer::ID writeThrottle {-1};
+
+    /* 零拷贝发送：每次成功的 MSG_ZEROCOPY 发送占用一个序号，数据保持到对应的完成通知到达，
+     * 关闭时仍未完成的发送连同套接字交给 Looper 的 ZeroCopyReaper */
+    size_t zeroCopyThreshold {0};
+    uint32_t zeroCopySeq {0};
+    size_t zeroCopyBytes {0};      /* 等待完成通知的字节数，计入内存占用 */
+    std::vector<ZeroCopyReaper::Send> zeroCopyPending;
+
+    /* 流量控制 */
+    std::weak_ptr<TcpConnection> backpressureTarget;
+    bool throttled {false};
+    timer::Timer::ID evictTimer {-1};
+
+    /* 完成式 I/O */
+    uint64_t completionKey {0};
+    bool recvArmed {false};
+    bool sending   {false};
+    std::shared_ptr<InflightSend> inflight;
+};
+
 void TcpConnection::defaultConnectionCallback(TcpConnection& conn) {
     LOG_INFO("Connection from {}:{}", conn.peerAddress().ip(), conn.peerAddress().port());
 }
@@ -31,28 +121,39 @@ void TcpConnection::defaultWriteCompleteCallback(TcpConnection& conn) {
 void TcpConnection::defaultHighWaterMarkCallback(TcpConnection& conn, size_t size) {
     LOG_WARN("{} reaches high water mark {}", conn.peerAddress().ip(), size);
 }
+auto TcpConnection::defaultCallbacks() -> const CallbacksPtr& {
+    static const CallbacksPtr callbacks = std::make_shared<const Callbacks>(Callbacks {
+        defaultConnectionCallback,
+        defaultMessageCallback,
+        defaultWriteCompleteCallback,
+        defaultHighWaterMarkCallback,
+        defaultCloseCallback,
+        defaultErrorCallback
+    });
+    return callbacks;
+}
+auto TcpConnection::defaultOptions() -> const OptionsPtr& {
+    static const OptionsPtr options = std::make_shared<const Options>();
+    return options;
+}
 
 TcpConnection::TcpConnection(Looper& looper,
-                            utils::StringPiece name,
+                            ID id,
+                            NamePtr prefix,
                             Socket sock,
                             const NetAddress& localAddr,
-                            const NetAddress& peerAddr):
+                            const NetAddress& peerAddr,
+                            OptionsPtr options):
                             looper_(looper),
-                            name_(name.asString()),
+                            id_(id),
+                            prefix_(std::move(prefix)),
+                            event_(looper, sock.fd()),
                             socket_(sock),
-                            localAddr_(localAddr),
                             peerAddr_(peerAddr),
-                            event_(looper, sock.fd()) {
-    connectionCb_    = std::bind(&TcpConnection::defaultConnectionCallback, std::placeholders::_1);
-    messageCb_       = std::bind(&TcpConnection::defaultMessageCallback, std::placeholders::_1,
-                                                                         std::placeholders::_2,
-                                                                         std::placeholders::_3);
-    writeCompleteCb_ = std::bind(&TcpConnection::defaultWriteCompleteCallback, std::placeholders::_1);
-    highWaterMarkCb_ = std::bind(&TcpConnection::defaultHighWaterMarkCallback, std::placeholders::_1,
-                                                                               std::placeholders::_2);
-    closeCb_         = std::bind(&TcpConnection::defaultCloseCallback, std::placeholders::_1);
-    errorCb_         = std::bind(&TcpConnection::defaultErrorCallback, std::placeholders::_1);
-
+                            localAddr_(localAddr),
+                            callbacks_(defaultCallbacks()),
+                            options_(std::move(options)),
+                            readBuffer_(0) {
     event_.setReadCallback([this] {
         handleRead();
     });
@@ -63,13 +164,31 @@ TcpConnection::TcpConnection(Looper& looper,
         handleClose();
     });
     event_.setErrorCallback([this] {
-        errorCb_(*this);
+        handleError();
+    });
+    event_.setFlushCallback([this] {
+        flushOutput();
     });
     socket_.setKeepAlive(true);
 }
-TcpConnection::~TcpConnection() {}
+TcpConnection::~TcpConnection() {
+    /* Looper 已经退出时发送队列中可能还有未处理的数据 */
+    OutboxNode* node = outbox_.popAll();
+    while(node) {
+        OutboxNode* next = node->next;
+        delete node;
+        node = next;
+    }
+    /* 没有经过关闭流程（例如 Looper 已经退出）时，未完成的零拷贝发送同样不能随连接释放 */
+    if(ext_ && !ext_->zeroCopyPending.empty()) {
+        looper_.run([&looper = looper_, fd = socket_.fd(), sends = std::move(ext_->zeroCopyPending)]() mutable {
+            looper.zeroCopyReaper().adopt(fd, std::move(sends));
+        });
+    }
+    looper_.addBufferBytes(-static_cast<int64_t>(footprint_.load()));
+}
 
-const std::string& TcpConnection::name()         const { return name_; }
+TcpConnection::ID  TcpConnection::id()           const { return id_; }
 Looper&            TcpConnection::looper()       const { return looper_; }
 optional<TcpInfo>  TcpConnection::tcpInfo()      const { return socket_.getTcpInfo(); }
 bool               TcpConnection::connected()    const { return state_ == kConnected; }
@@ -78,99 +197,615 @@ const NetAddress&  TcpConnection::peerAddress()  const { return peerAddr_; }
 const NetAddress&  TcpConnection::localAddress() const { return localAddr_; }
 bool               TcpConnection::disconnected() const { return state_ == kDisconnected; }
 const std::any&    TcpConnection::getContext()   const { return context_; }
+TcpConnection::IoMode TcpConnection::ioMode()    const { return ioMode_; }
+size_t             TcpConnection::bufferFootprint() const { return footprint_; }
+std::string TcpConnection::name() const {
+    return fmt::format("{}-{}:{}-{:#x}", prefix_ ? *prefix_ : "Connection", peerAddr_.ip(), peerAddr_.port(), id_);
+}
 
 void TcpConnection::setTcpNoDelay(bool on) {
     looper_.run([this, on]{
         socket_.setTcpNoDelay(on);
     });
 }
+void TcpConnection::setIoMode(IoMode mode) {
+    looper_.run([this, mode] {
+        ownOptions().ioMode = mode;
+    });
+}
+void TcpConnection::setEdgeTriggered(bool on) {
+    looper_.run([this, on] {
+        ownOptions().edgeTriggered = on;
+    });
+}
+void TcpConnection::setIdleTimeout(double readIdle, double writeIdle, double allIdle) {
+    auto toMs = [](double ms) { return ms > 0.0 ? static_cast<uint64_t>(std::ceil(ms)) : 0; };
+    looper_.run([this, read = toMs(readIdle), write = toMs(writeIdle), all = toMs(allIdle)] {
+        Options& options    = ownOptions();
+        options.readIdleMs  = read;
+        options.writeIdleMs = write;
+        options.allIdleMs   = all;
+    });
+}
+void TcpConnection::setReadBudget(ReadBudget budget) {
+    budget.bytes = std::max<size_t>(budget.bytes, 1);
+    budget.reads = std::max(budget.reads, 1);
+    looper_.run([this, budget] {
+        ownOptions().readBudget = budget;
+    });
+}
+void TcpConnection::setQueryReadable(bool on) {
+    looper_.run([this, on] {
+        ownOptions().queryReadable = on;
+    });
+}
+void TcpConnection::setShrinkPolicy(ShrinkPolicy policy) {
+    policy.rounds = std::max(policy.rounds, 1);
+    looper_.run([this, policy] {
+        ownOptions().shrinkPolicy = policy;
+    });
+}
+void TcpConnection::setCorked(bool on) {
+    looper_.run([this, on] {
+        ownOptions().corked = on;
+    });
+}
+void TcpConnection::setZeroCopy(size_t threshold) {
+    looper_.run([this, threshold] {
+        size_t applied = threshold > 0 && socket_.setZeroCopy(true) ? threshold : 0;
+        if(applied > 0 || ext_) ext().zeroCopyThreshold = applied;
+    });
+}
+void TcpConnection::setFlowControl(FlowControl control) {
+    control.lowWaterMark = std::min(control.lowWaterMark, control.highWaterMark);
+    looper_.run([this, control] {
+        ownOptions().flowControl = control;
+    });
+}
+void TcpConnection::setBackpressureTarget(const TcpConnectionPtr& target) {
+    looper_.run([this, weak = std::weak_ptr<TcpConnection>(target)] {
+        ext().backpressureTarget = weak;
+    });
+}
+void TcpConnection::setRateLimit(double readBytesPerSec, double writeBytesPerSec, size_t burst) {
+    auto bucket = [burst](double rate) -> std::shared_ptr<utils::TokenBucket> {
+        if(rate <= 0.0) return nullptr;
+        return std::make_shared<utils::TokenBucket>(rate, burst > 0 ? burst : static_cast<size_t>(rate));
+    };
+    looper_.run([this, read = bucket(readBytesPerSec), write = bucket(writeBytesPerSec)] {
+        Extension& ext = this->ext();
+        ext.readMeter.own  = read;
+        ext.writeMeter.own = write;
+    });
+}
+void TcpConnection::setSharedRateLimit(std::shared_ptr<utils::TokenBucket> read,
+                                       std::shared_ptr<utils::TokenBucket> write) {
+    looper_.run([this, read = std::move(read), write = std::move(write)] {
+        Extension& ext = this->ext();
+        ext.readMeter.shared  = read;
+        ext.writeMeter.shared = write;
+    });
+}
 void TcpConnection::setContext(const std::any& context) {
-    looper_.run([this, &context] {
+    looper_.run([this, context] {
         context_ = context;
     });
 }
+void TcpConnection::setOptions(OptionsPtr options) {
+    looper_.run([this, options = std::move(options)] {
+        options_    = options;
+        ownOptions_ = nullptr;
+    });
+}
+void TcpConnection::setCallbacks(CallbacksPtr callbacks) {
+    looper_.run([this, callbacks = std::move(callbacks)] {
+        callbacks_    = callbacks;
+        ownCallbacks_ = nullptr;
+    });
+}
 void TcpConnection::setConnectionCallback(const ConnectionCallback& cb) {
-    looper_.run([this, &cb] {
-        connectionCb_ = std::move(cb);
+    looper_.run([this, cb] {
+        ownCallbacks().connection = cb;
     });
 }
 void TcpConnection::setMessageCallback(const MessageCallback& cb) {
-    looper_.run([this, &cb] {
-        messageCb_ = std::move(cb);
+    looper_.run([this, cb] {
+        ownCallbacks().message = cb;
     });
 }
 void TcpConnection::setWriteCompleteCallback(const WriteCompleteCallback& cb) {
-    looper_.run([this, &cb] {
-        writeCompleteCb_ = std::move(cb);
+    looper_.run([this, cb] {
+        ownCallbacks().writeComplete = cb;
     });
 }
 void TcpConnection::setCloseCallback(const CloseCallback& cb) {
-    looper_.run([this, &cb] {
-        closeCb_ = std::move(cb);
+    looper_.run([this, cb] {
+        ownCallbacks().close = cb;
     });
 }
 void TcpConnection::setErrorCallback(const ErrorCallback& cb) {
-    looper_.run([this, &cb] {
-        errorCb_ = std::move(cb);
+    looper_.run([this, cb] {
+        ownCallbacks().error = cb;
     });
 }
 void TcpConnection::setHighWaterMarkCallback(const HighWaterMarkCallback& cb, size_t mark) {
-    looper_.run([this, &cb, mark] {
-        highWaterMarkCb_ = std::move(cb);
-        highWaterMark_   = mark;
+    looper_.run([this, cb, mark] {
+        ownCallbacks().highWaterMark = cb;
+        highWaterMark_ = mark;
     });
 }
+/* 共享的表保持不变，其他连接与仍在执行中的回调不受影响 */
+auto TcpConnection::ownCallbacks() -> Callbacks& {
+    if(!ownCallbacks_) {
+        auto own = std::make_shared<Callbacks>(*callbacks_);
+        ownCallbacks_ = own.get();
+        callbacks_    = std::move(own);
+    }
+    return *ownCallbacks_;
+}
+auto TcpConnection::ownOptions() -> Options& {
+    if(!ownOptions_) {
+        auto own = std::make_shared<Options>(*options_);
+        ownOptions_ = own.get();
+        options_    = std::move(own);
+    }
+    return *ownOptions_;
+}
 
 void TcpConnection::send(const utils::StringPiece msg) {
     send(msg.data(), msg.size());
 }
+void TcpConnection::send(const char* msg) {
+    send(msg, strlen(msg));
+}
+/* 在所属 Looper 线程中直接发送；其他线程中调用时 data 在返回后可能失效，先拷贝一份 */
 void TcpConnection::send(const void* data, size_t len) {
     if (state_ != kConnected) return;
     LOG_DEBUG("Send {} bytes to {}", len, peerAddress().ip());
-    looper_.run([&] {
-        size_t wrote = 0;
-        bool error = false;
+    if(looper_.isInLoopThread()) {
+        sendInLoop(data, len, nullptr);
+        return;
+    }
+    auto owner = std::make_shared<std::string>(static_cast<const char*>(data), len);
+    post(owner->data(), owner->size(), owner);
+}
+void TcpConnection::send(std::string&& data) {
+    if(data.size() < utils::ChainBuffer::kLinkThreshold && looper_.isInLoopThread()) {
+        send(data.data(), data.size());
+        return;
+    }
+    if (state_ != kConnected) return;
+    LOG_DEBUG("Send {} bytes to {}", data.size(), peerAddress().ip());
+    auto owner = std::make_shared<std::string>(std::move(data));
+    post(owner->data(), owner->size(), owner);
+}
+void TcpConnection::send(utils::Buffer&& data) {
+    if (state_ != kConnected) return;
+    send(std::make_shared<const utils::Buffer>(std::move(data)));
+}
+void TcpConnection::send(std::shared_ptr<const utils::Buffer> data) {
+    if (state_ != kConnected || !data) return;
+    LOG_DEBUG("Send {} bytes to {}", data->readableBytes(), peerAddress().ip());
+    post(data->beginRead(), data->readableBytes(), data);
+}
+void TcpConnection::send(const void* data, size_t len, ReleaseCallback release) {
+    std::shared_ptr<const void> owner = utils::ChainBuffer::releaseOwner(data, std::move(release));
+    if (state_ != kConnected) return;
+    LOG_DEBUG("Send {} bytes to {}", len, peerAddress().ip());
+    post(static_cast<const char*>(data), len, std::move(owner));
+}
+void TcpConnection::send(const utils::SharedPayload& payload) {
+    if (state_ != kConnected || payload.empty()) return;
+    LOG_DEBUG("Send {} shared bytes to {}", payload.size(), peerAddress().ip());
+    post(payload.data(), payload.size(), payload.owner());
+}
+void TcpConnection::sendFile(int fd, off_t offset, size_t length, ReleaseCallback release) {
+    std::shared_ptr<const void> owner = utils::ChainBuffer::releaseOwner(this, std::move(release));
+    if (state_ != kConnected || length == 0) return;
+    if(offset < 0) {
+        LOG_ERROR("Invalid offset {} of file(fd: {})", offset, fd);
+        return;
+    }
+    LOG_DEBUG("Send {} bytes of file(fd: {}) to {}", length, fd, peerAddress().ip());
+    if(looper_.isInLoopThread()) {
+        sendFileInLoop(fd, offset, length, std::move(owner));
+        return;
+    }
+    post(new OutboxNode { nullptr, nullptr, length, std::move(owner), fd, offset });
+}
+bool TcpConnection::sendFile(const std::string& path, off_t offset, size_t length) {
+    if(state_ != kConnected) return false;
+    if(offset < 0) {
+        LOG_ERROR("Invalid offset {} of file {}", offset, path);
+        return false;
+    }
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        LOG_ERROR("Open {} failed: {}", path, errnoStr(errno));
+        return false;
+    }
+    struct stat st;
+    if(::fstat(fd, &st) < 0 || offset > st.st_size) {
+        LOG_ERROR("Invalid file {} or offset {}", path, offset);
+        ::close(fd);
+        return false;
+    }
+    length = std::min<size_t>(length, st.st_size - offset);
+    sendFile(fd, offset, length, [fd] {
+        ::close(fd);
+    });
+    return true;
+}
+void TcpConnection::post(const char* data, size_t len, std::shared_ptr<const void> owner) {
+    if(looper_.isInLoopThread()) {
+        sendInLoop(data, len, std::move(owner));
+        return;
+    }
+    post(new OutboxNode { nullptr, data, len, std::move(owner) });
+}
+/* 只有使队列由空变为非空的生产者投递任务，之后的发送在该任务执行前都会合并进去 */
+void TcpConnection::post(OutboxNode* node) {
+    if(outbox_.push(node)) {
+        looper_.run([self = shared_from_this()] {
+            self->drainOutbox();
+        });
+    }
+}
+void TcpConnection::drainOutbox() {
+    looper_.assert();
 
-        bool isFirstSend = !event_.writable() && sendBuffer_.readableBytes() == 0;
+    OutboxNode* node = outbox_.popAll();
+    while(node) {
+        std::unique_ptr<OutboxNode> guard(node);
+        node = node->next;
+        if(state_ == kDisconnected) continue;
+        if(guard->fd >= 0) {
+            sendFileInLoop(guard->fd, guard->offset, guard->len, std::move(guard->owner));
+        } else {
+            sendInLoop(guard->data, guard->len, std::move(guard->owner));
+        }
+    }
+}
+/* owner 为空时数据由调用者持有，未能立刻写出的部分需要拷贝；
+ * 否则剩余部分连同 owner 一起挂入发送缓冲区 */
+void TcpConnection::sendInLoop(const void* data, size_t len, std::shared_ptr<const void> owner) {
+    if(ioMode_ == kCompletion) {
+        size_t dataInBuffer = sendBuffer_.readableBytes() + ext_->inflight->data.readableBytes();
+        if(dataInBuffer + len >= highWaterMark_ && callbacks_->highWaterMark) {
+            callbacks_->highWaterMark(*this, dataInBuffer);
+        }
+        sendBuffer_.link(data, len, std::move(owner));
+        startSend();
+        updateFootprint();
+        checkBackpressure();
+        return;
+    }
+
+    size_t wrote = 0;
+    bool error = false;
+    bool isFirstSend = sendBuffer_.readableBytes() == 0;
+
+    /* 满足零拷贝条件的数据整段挂入发送缓冲区，由 writeOnce 以 MSG_ZEROCOPY 发出 */
+    if(owner && ext_ && ext_->zeroCopyThreshold > 0 && len >= ext_->zeroCopyThreshold) {
+        if(sendBuffer_.readableBytes() + len >= highWaterMark_ && callbacks_->highWaterMark) {
+            callbacks_->highWaterMark(*this, sendBuffer_.readableBytes());
+        }
+        sendBuffer_.link(data, len, std::move(owner));
         if(isFirstSend) {
-            try {
-                wrote = socket_.write(data, len);
-                len -= wrote;
-                if(len == 0 && writeCompleteCb_) {
-                    writeCompleteCb_(*this);
-                }
-            } catch(exception::SocketException& e) {
-                if(errno != EWOULDBLOCK && (errno == EPIPE || errno == ECONNRESET)) {
-                    LOG_ERROR("{}", e.detail());
-                    error = true;
-                }
+            writeImmediately();
+        } else {
+            armWrite();
+        }
+        updateFootprint();
+        checkBackpressure();
+        return;
+    }
+
+    /* 发送缓冲区中没有待发送的数据时直接写入，合并写出时只追加，留待刷新阶段
+     * 限速时先追加到发送缓冲区，再按令牌数写出 */
+    if(isFirstSend && !options_->corked && !writeMeter()) {
+        try {
+            ssize_t bytes = socket_.write(data, len);
+            wrote = bytes > 0 ? bytes : 0;
+            len -= wrote;
+            if(wrote > 0) touchWrite();
+            if(len == 0 && callbacks_->writeComplete) {
+                callbacks_->writeComplete(*this);
+            }
+        } catch(exception::SocketException& e) {
+            if(errno != EWOULDBLOCK && (errno == EPIPE || errno == ECONNRESET)) {
+                LOG_ERROR("{}", e.detail());
+                error = true;
             }
         }
+    }
 
-        if(!error && len > 0) {
-            size_t dataInBuffer = sendBuffer_.readableBytes();
-            if(dataInBuffer + len >= highWaterMark_ && highWaterMarkCb_) {
-                highWaterMarkCb_(*this, sendBuffer_.readableBytes());
+    if(!error && len > 0) {
+        size_t dataInBuffer = sendBuffer_.readableBytes();
+        if(dataInBuffer + len >= highWaterMark_ && callbacks_->highWaterMark) {
+            callbacks_->highWaterMark(*this, sendBuffer_.readableBytes());
+        }
+        sendBuffer_.link(static_cast<const char*>(data) + wrote, len, std::move(owner));
+        if(options_->corked) {
+            event_.scheduleFlush();
+        } else if(isFirstSend && writeMeter()) {
+            writeImmediately();
+        } else {
+            armWrite();
+        }
+        updateFootprint();
+        checkBackpressure();
+    }
+}
+
+/* 文件分段只能整段挂入发送缓冲区，之前没有待发送的数据时立刻尝试发送一次 */
+void TcpConnection::sendFileInLoop(int fd, off_t offset, size_t len, std::shared_ptr<const void> owner) {
+    size_t dataInBuffer = sendBuffer_.readableBytes();
+    if(InflightSend* inflight = inflightSend()) dataInBuffer += inflight->data.readableBytes();
+    if(dataInBuffer + len >= highWaterMark_ && callbacks_->highWaterMark) {
+        callbacks_->highWaterMark(*this, dataInBuffer);
+    }
+    sendBuffer_.appendFile(fd, offset, len, std::move(owner));
+    if(ioMode_ == kCompletion) {
+        startSend();
+    } else if(dataInBuffer == 0) {
+        writeImmediately();
+    } else {
+        armWrite();
+    }
+    checkBackpressure();
+}
+void TcpConnection::writeImmediately() {
+    if(options_->corked) {
+        event_.scheduleFlush();
+        return;
+    }
+    try {
+        ssize_t bytes = writeOnce();
+        if(bytes > 0) touchWrite();
+    } catch(exception::SocketException& e) {
+        LOG_ERROR("{}", e.detail());
+        sendBuffer_.retrieveAll();
+        updateFootprint();
+        callbacks_->error(*this);
+        return;
+    }
+    if(sendBuffer_.empty()) {
+        if(callbacks_->writeComplete) callbacks_->writeComplete(*this);
+        return;
+    }
+    armWrite();
+}
+/* 限速时至多发送当前的令牌数，令牌耗尽时注销可写监听并返回 -1 */
+ssize_t TcpConnection::writeOnce() {
+    size_t allowance = SIZE_MAX;
+    int64_t now = 0;
+    if(writeThrottled()) return -1;
+    RateMeter* meter = writeMeter();
+    if(meter) {
+        now = utils::TokenBucket::now();
+        allowance = meter->available(now);
+        if(allowance == 0) {
+            throttleWrite();
+            return -1;
+        }
+    }
+    struct iovec iov;
+    std::shared_ptr<const void> owner;
+    ssize_t bytes = -1;
+    size_t threshold = ext_ ? ext_->zeroCopyThreshold : 0;
+    bool zeroCopy = threshold > 0 && sendBuffer_.peekLinked(threshold, iov, owner);
+    if(zeroCopy) {
+        iov.iov_len = std::min(iov.iov_len, allowance);
+        bytes = socket_.sendZeroCopy(&iov, 1);
+        if(bytes > 0) {
+            ext_->zeroCopyPending.push_back({ ext_->zeroCopySeq++, static_cast<size_t>(bytes), std::move(owner) });
+            ext_->zeroCopyBytes += bytes;
+            sendBuffer_.retrieve(bytes);
+        }
+        /* 无法锁定更多页面时本次改为拷贝发送 */
+        if(bytes < 0 && errno == ENOBUFS) zeroCopy = false;
+    }
+    if(!zeroCopy) {
+        bytes = sendBuffer_.writeSocket(socket_, allowance);
+    }
+    if(bytes > 0 && meter) {
+        meter->consume(bytes, now);
+        if(!sendBuffer_.empty() && meter->exhausted(now)) throttleWrite();
+    }
+    return bytes;
+}
+
+/* 暂停可以叠加（例如多个下游同时积压），每次 pause 对应一次 resume */
+void TcpConnection::pauseReading() {
+    looper_.run([self = shared_from_this()] {
+        if(self->readPauses_++ > 0 || self->state_ == kDisconnected) return;
+        LOG_DEBUG("Pause reading {}", self->name());
+        if(self->ioMode_ == kCompletion) {
+            if(self->ext_->recvArmed) {
+                self->looper_.ioUringPoller()->cancel(self->ext_->completionKey, kRecvTag);
             }
-            sendBuffer_.append(static_cast<const char*>(data) + wrote, len);
-            if(!event_.writable()) {
-                event_.enableWrite();
+        } else if(self->event_.isReading()) {
+            self->event_.disableRead();
+        }
+    });
+}
+void TcpConnection::resumeReading() {
+    looper_.run([self = shared_from_this()] {
+        if(self->readPauses_ == 0 || --self->readPauses_ > 0) return;
+        if(self->state_ != kConnected && self->state_ != kDisconnecting) return;
+        LOG_DEBUG("Resume reading {}", self->name());
+        if(self->ioMode_ == kCompletion) {
+            Extension& ext = *self->ext_;
+            if(!ext.recvArmed && ext.readThrottle < 0 && ext.completionKey != 0) self->submitRecv();
+            /* 暂停期间收下的数据在下一个任务阶段交给回调，resumeReading 可能在发送路径中被调用 */
+            if(self->readBuffer_.readableBytes() > 0) {
+                self->looper_.queue([self] {
+                    if(self->readPauses_ > 0 || self->state_ == kDisconnected) return;
+                    if(self->readBuffer_.readableBytes() == 0) return;
+                    self->callbacks_->message(*self, self->readBuffer_, utils::Timestamp::now());
+                    self->maybeShrink();
+                });
             }
+        } else if(!self->readThrottled() && !self->event_.isReading()) {
+            self->event_.enableRead();
+        }
+    });
+}
+auto TcpConnection::isReadingPaused() const -> bool {
+    return readPauses_ > 0;
+}
+auto TcpConnection::backpressureTarget() -> TcpConnectionPtr {
+    if(!ext_ || ext_->backpressureTarget.expired()) return shared_from_this();
+    return ext_->backpressureTarget.lock();
+}
+/* 待发送的数据超过高水位时暂停目标连接的读取，降到低水位以下时恢复；
+ * 持续超过高水位达到期限的连接视为慢速消费者，强制关闭 */
+void TcpConnection::checkBackpressure() {
+    if(options_->flowControl.highWaterMark == 0) return;
+    Extension& ext = this->ext();
+    size_t pending = sendBuffer_.readableBytes();
+    if(ext.inflight) pending += ext.inflight->data.readableBytes();
+    if(!ext.throttled && pending >= options_->flowControl.highWaterMark) {
+        ext.throttled = true;
+        LOG_DEBUG("{} has {} bytes pending, apply backpressure", name(), pending);
+        if(auto target = backpressureTarget()) target->pauseReading();
+        if(options_->flowControl.evictAfterMs > 0.0 && ext.evictTimer < 0) {
+            std::weak_ptr<TcpConnection> weak = weak_from_this();
+            ext.evictTimer = looper_.runAfter(options_->flowControl.evictAfterMs, [weak] {
+                if(auto conn = weak.lock()) {
+                    conn->evict();
+                }
+            });
+        }
+    } else if(ext.throttled && pending <= options_->flowControl.lowWaterMark) {
+        ext.throttled = false;
+        if(auto target = backpressureTarget()) target->resumeReading();
+        if(ext.evictTimer >= 0) {
+            looper_.cancelTimer(ext.evictTimer);
+            ext.evictTimer = -1;
         }
+    }
+}
+void TcpConnection::evict() {
+    ext_->evictTimer = -1;
+    if(!ext_->throttled || state_ == kDisconnected) return;
+    LOG_WARN("Evict slow consumer {} after {} ms above high water mark", name(), options_->flowControl.evictAfterMs);
+    forceClose();
+}
+
+auto TcpConnection::RateMeter::available(int64_t now) const -> size_t {
+    size_t tokens = SIZE_MAX;
+    if(own)    tokens = std::min(tokens, own->available(now));
+    if(shared) tokens = std::min(tokens, shared->available(now));
+    return tokens;
+}
+void TcpConnection::RateMeter::consume(size_t bytes, int64_t now) {
+    if(own)    own->consume(bytes, now);
+    if(shared) shared->consume(bytes, now);
+}
+auto TcpConnection::RateMeter::waitFor(size_t bytes, int64_t now) const -> int64_t {
+    int64_t wait = 0;
+    if(own)    wait = std::max(wait, own->waitFor(bytes, now));
+    if(shared) wait = std::max(wait, shared->waitFor(bytes, now));
+    return wait;
+}
+auto TcpConnection::RateMeter::exhausted(int64_t now) const -> bool {
+    return available(now) < kRateQuantum;
+}
+/* 等待到令牌足够 kRateQuantum（或令牌桶的容量）为止，至少等待 1 毫秒 */
+static double throttleDelayMs(int64_t waitNs) {
+    return std::max(static_cast<double>(waitNs) / 1e6, 1.0);
+}
+void TcpConnection::throttleRead() {
+    Extension& ext = this->ext();
+    if(ext.readThrottle >= 0 || state_ == kDisconnected) return;
+    if(ioMode_ == kCompletion) {
+        if(ext.recvArmed) looper_.ioUringPoller()->cancel(ext.completionKey, kRecvTag);
+    } else if(event_.isReading()) {
+        event_.disableRead();
+    }
+    std::weak_ptr<TcpConnection> weak = weak_from_this();
+    double delay = throttleDelayMs(ext.readMeter.waitFor(kRateQuantum, utils::TokenBucket::now()));
+    ext.readThrottle = looper_.runAfter(delay, [weak] {
+        if(auto conn = weak.lock()) conn->unthrottleRead();
+    });
+}
+void TcpConnection::unthrottleRead() {
+    Extension& ext = *ext_;
+    ext.readThrottle = -1;
+    if(readPauses_ > 0 || (state_ != kConnected && state_ != kDisconnecting)) return;
+    if(ioMode_ == kCompletion) {
+        if(!ext.recvArmed && ext.completionKey != 0) submitRecv();
+    } else if(!event_.isReading()) {
+        event_.enableRead();
+    }
+}
+/* 边沿触发时可写监听保持不变，令牌耗尽后不写即可，定时器到期时主动写出 */
+void TcpConnection::throttleWrite() {
+    Extension& ext = this->ext();
+    if(ext.writeThrottle >= 0 || state_ == kDisconnected) return;
+    if(ioMode_ == kReadiness && !event_.edgeTriggered() && event_.isWriting()) {
+        event_.disableWrite();
+    }
+    std::weak_ptr<TcpConnection> weak = weak_from_this();
+    double delay = throttleDelayMs(ext.writeMeter.waitFor(kRateQuantum, utils::TokenBucket::now()));
+    ext.writeThrottle = looper_.runAfter(delay, [weak] {
+        if(auto conn = weak.lock()) conn->unthrottleWrite();
     });
 }
+void TcpConnection::unthrottleWrite() {
+    ext_->writeThrottle = -1;
+    if(state_ == kDisconnected) return;
+    if(ioMode_ == kCompletion) {
+        startSend();
+        return;
+    }
+    writeBuffered();
+    if(sendBuffer_.readableBytes() > 0) armWrite();
+}
+void TcpConnection::armWrite() {
+    if(!writeThrottled() && !event_.isWriting()) {
+        event_.enableWrite();
+    }
+}
+
+auto TcpConnection::ext() -> Extension& {
+    if(!ext_) ext_ = std::make_unique<Extension>();
+    return *ext_;
+}
+auto TcpConnection::readMeter() -> RateMeter* {
+    return ext_ && ext_->readMeter ? &ext_->readMeter : nullptr;
+}
+auto TcpConnection::writeMeter() -> RateMeter* {
+    return ext_ && ext_->writeMeter ? &ext_->writeMeter : nullptr;
+}
+bool TcpConnection::readThrottled() const {
+    return ext_ && ext_->readThrottle >= 0;
+}
+bool TcpConnection::writeThrottled() const {
+    return ext_ && ext_->writeThrottle >= 0;
+}
+auto TcpConnection::inflightSend() const -> InflightSend* {
+    return ext_ ? ext_->inflight.get() : nullptr;
+}
 
 void TcpConnection::shutdown() {
     if (state_ != kConnected) return;
     state_ = kDisconnecting;
     looper_.run([this] {
-        if(event_.writable()) {
-            LOG_WARN("Try to shutdown while data has not been send");
-            return;
-        }
-        socket_.shutdownWrite();
+        shutdownInLoop();
     });
 }
+/* 还有待发送的数据时推迟到发送完成后再关闭写端 */
+void TcpConnection::shutdownInLoop() {
+    InflightSend* inflight = inflightSend();
+    if(sendBuffer_.readableBytes() > 0 || (inflight && (ext_->sending || !inflight->data.empty()))) {
+        LOG_DEBUG("Shutdown {} after pending data has been sent", name());
+        return;
+    }
+    socket_.shutdownWrite();
+}
 void TcpConnection::forceClose() {
     if (state_ == kConnecting || state_ == kDisconnected) return;
     state_ = kDisconnecting;
@@ -183,8 +818,8 @@ void TcpConnection::forceCloseWithoutCallback() {
     state_ = kDisconnecting;
     looper_.run([this] {
         state_ = kDisconnected;
-        event_.cancel();
-        socket_.close();
+        detachIo();
+        closeSocket();
     });
 }
 
@@ -192,8 +827,31 @@ void TcpConnection::connectComplete() {
     looper_.assert();
 
     state_ = kConnected;
-    event_.enableRead();
-    connectionCb_(*this);
+    const Options& options = *options_;
+    if(options.readRate > 0.0 || options.writeRate > 0.0) {
+        setRateLimit(options.readRate, options.writeRate, options.rateBurst);
+    }
+    if(options.sharedReadRate || options.sharedWriteRate) {
+        setSharedRateLimit(options.sharedReadRate, options.sharedWriteRate);
+    }
+    if(options.zeroCopyThreshold > 0) {
+        setZeroCopy(options.zeroCopyThreshold);
+    }
+    ioMode_ = options.ioMode;
+    if(ioMode_ == kCompletion) {
+        startCompletionIo();
+    }
+    if(ioMode_ == kReadiness) {
+        /* 边沿触发时一次性注册读写事件，之后不再需要修改监听事件 */
+        event_.setEdgeTriggered(options_->edgeTriggered);
+        if(options_->edgeTriggered) {
+            event_.enableWrite();
+        }
+        event_.enableRead();
+    }
+    startIdleTimer();
+    updateFootprint();
+    callbacks_->connection(*this);
 }
 void TcpConnection::disconnectComplete() {
     looper_.assert();
@@ -205,48 +863,504 @@ void TcpConnection::disconnectComplete() {
 void TcpConnection::handleRead() {
     looper_.assert();
 
+    /* 暂停或限速之前被推迟的读事件 */
+    if(readPauses_ > 0 || readThrottled()) return;
+    /* 限速时本轮至多读取当前的令牌数 */
+    size_t limit = options_->readBudget.bytes;
+    int64_t now = 0;
+    RateMeter* meter = readMeter();
+    if(meter) {
+        now = utils::TokenBucket::now();
+        limit = std::min(limit, meter->available(now));
+        if(limit == 0) {
+            throttleRead();
+            return;
+        }
+    }
     try {
-        ssize_t bytes = readBuffer_.readSocket(socket_);
-        if(bytes > 0) {
-            messageCb_(*this, readBuffer_, utils::Timestamp::now());
-        } else {
-            disconnectComplete();
+        /* 水平触发时每次就绪只读一次，边沿触发时读至 EAGAIN 或预算耗尽
+         * 预期的数据直接读入连接缓冲区，超出部分先落入 Looper 的共享暂存区再拷贝 */
+        size_t total = 0;
+        for(int round = 0;; ++round) {
+            size_t remaining = limit - total;
+            readBuffer_.ensureWritableBytes(nextReadSize(remaining));
+            ssize_t bytes = readBuffer_.readSocket(socket_, looper_.scratch(), Looper::kScratchSize, remaining);
+            if(bytes == 0) {
+                if(total > 0) {
+                    touchRead();
+                    callbacks_->message(*this, readBuffer_, utils::Timestamp::now());
+                }
+                if(state_ != kDisconnected) disconnectComplete();
+                return;
+            }
+            if(bytes < 0) break;
+            readEstimate_ = readEstimate_ - (readEstimate_ >> kReadEstimateShift) + (bytes >> kReadEstimateShift);
+            readEstimate_ = std::clamp(readEstimate_, kMinReadSize, std::max(options_->readBudget.bytes, kMinReadSize));
+            total += bytes;
+            if(!event_.edgeTriggered()) break;
+            if(total >= limit || round + 1 >= options_->readBudget.reads) {
+                /* 令牌耗尽时由下面注销读监听，否则推迟到下一轮 */
+                if(total < limit || limit == options_->readBudget.bytes) event_.defer(Event::kReadEvent);
+                break;
+            }
+        }
+        /* 剩余的数据由定时器在令牌足够时重新监听后继续读取 */
+        if(meter && total > 0) {
+            meter->consume(total, now);
+            if(meter->exhausted(now)) throttleRead();
+        }
+        if(total > 0) {
+            touchRead();
+            callbacks_->message(*this, readBuffer_, utils::Timestamp::now());
+            maybeShrink();
         }
     } catch(exception::SocketException& e) {
         LOG_ERROR("{}", e.detail());
-        errorCb_(*this);
+        callbacks_->error(*this);
     }
 }
+size_t TcpConnection::nextReadSize(size_t remaining) {
+    size_t expected = readEstimate_;
+    if(options_->queryReadable) {
+        int available = 0;
+        if(::ioctl(socket_.fd(), FIONREAD, &available) == 0 && available > 0) {
+            expected = static_cast<size_t>(available);
+        }
+    }
+    return std::min(expected, remaining);
+}
 // 当send函数一次发不完时，会注册监听可写事件，在可写时执行该函数继续发送
+// 边沿触发时可写事件始终处于监听状态，缓冲区为空时的可写通知直接忽略
 void TcpConnection::handleWrite() {
     looper_.assert();
 
-    if(event_.writable()) {
-        try {
-            ssize_t bytes = socket_.write(sendBuffer_.beginRead(), sendBuffer_.readableBytes());
-            sendBuffer_.retrieve(bytes);
-            if(sendBuffer_.readableBytes() == 0) {
-                event_.disableWrite();
-                if(writeCompleteCb_) {
-                    looper_.queue([this] {
-                        writeCompleteCb_(*this);
-                    });
-                }
-                if(state_ == kDisconnecting) {
-                    shutdown();
-                }
+    if(!event_.writable()) {
+        LOG_ERROR("TcpConnection::handleWrite() can't write");
+        return;
+    }
+    writeBuffered();
+}
+/* 合并写出时由 Looper 的刷新阶段调用，本轮积攒的数据以一次 writev 写出，未写完的部分等待可写事件 */
+void TcpConnection::flushOutput() {
+    if(state_ == kDisconnected) return;
+    writeBuffered();
+    if(sendBuffer_.readableBytes() > 0) armWrite();
+}
+void TcpConnection::writeBuffered() {
+    if(sendBuffer_.readableBytes() == 0) return;
+    try {
+        size_t total = 0;
+        for(int round = 0; sendBuffer_.readableBytes() > 0; ++round) {
+            /* 一次 writev 写出发送缓冲区中的多个分段 */
+            ssize_t bytes = writeOnce();
+            if(bytes < 0) break;
+            total += bytes;
+            touchWrite();
+            if(!event_.edgeTriggered()) break;
+            if(sendBuffer_.readableBytes() > 0 &&
+               (total >= kEdgeBytesBudget || round + 1 >= kEdgeRoundsBudget)) {
+                event_.defer(Event::kWriteEvent);
+                break;
             }
-        } catch(exception::SocketException& e) {
-            LOG_ERROR("{}", e.detail());
         }
-    } else {
-        LOG_ERROR("TcpConnection::handleWrite() can't write");
+        updateFootprint();
+        checkBackpressure();
+        if(sendBuffer_.readableBytes() == 0) {
+            if(!event_.edgeTriggered() && event_.isWriting()) event_.disableWrite();
+            if(callbacks_->writeComplete) {
+                looper_.queue([this] {
+                    callbacks_->writeComplete(*this);
+                });
+            }
+            if(state_ == kDisconnecting) {
+                shutdownInLoop();
+            }
+        }
+    } catch(exception::SocketException& e) {
+        /* 文件提前结束等错误无法靠重试恢复，丢弃待发送的数据，避免反复触发可写事件 */
+        LOG_ERROR("{}", e.detail());
+        sendBuffer_.retrieveAll();
+        if(!event_.edgeTriggered() && event_.isWriting()) event_.disableWrite();
+        updateFootprint();
+        callbacks_->error(*this);
+    }
+}
+/* 零拷贝的完成通知经错误队列送达，同样表现为错误事件；读到通知时不视为错误，
+ * 真正的错误在之后的读写中仍会出现 */
+void TcpConnection::handleError() {
+    looper_.assert();
+
+    if(handleZeroCopyCompletion()) return;
+    callbacks_->error(*this);
+}
+bool TcpConnection::handleZeroCopyCompletion() {
+    if(!ext_ || (ext_->zeroCopyThreshold == 0 && ext_->zeroCopyPending.empty())) return false;
+    Extension& ext = *ext_;
+    bool handled = false;
+    while(auto range = socket_.readZeroCopyCompletion()) {
+        handled = true;
+        uint32_t span = range->hi - range->lo;
+        std::erase_if(ext.zeroCopyPending, [&ext, &range, span](const ZeroCopyReaper::Send& send) {
+            if(send.seq - range->lo > span) return false;
+            ext.zeroCopyBytes -= send.bytes;
+            return true;
+        });
+        if(range->copied && ext.zeroCopyThreshold > 0) {
+            LOG_DEBUG("Zerocopy of {} falls back to copy, disable it", name());
+            ext.zeroCopyThreshold = 0;
+        }
     }
+    if(handled) updateFootprint();
+    return handled;
 }
 void TcpConnection::handleClose() {
     looper_.assert();
 
-    event_.cancel();
-    socket_.close();
-    closeCb_(*this);
+    detachIo();
+    closeSocket();
+    callbacks_->close(*this);
+}
+/* 注销读写监听与空闲检测，完成式 I/O 需要取消内核中尚未完成的请求 */
+void TcpConnection::detachIo() {
+    if(idleTimer_ >= 0) {
+        looper_.cancelTimer(idleTimer_);
+        idleTimer_ = -1;
+    }
+    if(shrinkTimer_ >= 0) {
+        looper_.cancelTimer(shrinkTimer_);
+        shrinkTimer_ = -1;
+    }
+    if(!ext_) {
+        event_.cancel();
+        return;
+    }
+    Extension& ext = *ext_;
+    /* 连接关闭后不再有待发送的数据，恢复被暂停的读取 */
+    if(ext.throttled) {
+        ext.throttled = false;
+        if(auto target = backpressureTarget()) target->resumeReading();
+    }
+    if(ext.evictTimer >= 0) {
+        looper_.cancelTimer(ext.evictTimer);
+        ext.evictTimer = -1;
+    }
+    if(ext.readThrottle >= 0) {
+        looper_.cancelTimer(ext.readThrottle);
+        ext.readThrottle = -1;
+    }
+    if(ext.writeThrottle >= 0) {
+        looper_.cancelTimer(ext.writeThrottle);
+        ext.writeThrottle = -1;
+    }
+    if(ioMode_ == kCompletion) {
+        if(ext.completionKey == 0) return;
+        IoUringPoller* uring = looper_.ioUringPoller();
+        uring->cancel(ext.completionKey, kRecvTag);
+        uring->cancel(ext.completionKey, kSendTag);
+        uring->removeCompletion(ext.completionKey, ext.inflight);
+        ext.completionKey = 0;
+    } else {
+        event_.cancel();
+    }
+}
+
+/* 内核可能仍在从未完成的零拷贝发送中读取数据，这些数据连同套接字交给 Looper 保管至完成通知到达 */
+void TcpConnection::closeSocket() {
+    handleZeroCopyCompletion();
+    if(!ext_ || ext_->zeroCopyPending.empty()) {
+        socket_.close();
+        return;
+    }
+    looper_.zeroCopyReaper().adopt(socket_.fd(), std::move(ext_->zeroCopyPending));
+    ext_->zeroCopyPending.clear();
+    ext_->zeroCopyBytes = 0;
+    updateFootprint();
+}
+
+/* 每个连接只有一个空闲检测定时器，读写路径上只更新时间戳，
+ * 定时器的添加与取消都在时间轮上完成，均为 O(1) */
+void TcpConnection::startIdleTimer() {
+    if(options_->readIdleMs == 0 && options_->writeIdleMs == 0 && options_->allIdleMs == 0) return;
+    lastReadMs_ = lastWriteMs_ = TimerQueue::now();
+    checkIdle();
+}
+void TcpConnection::checkIdle() {
+    idleTimer_ = -1;
+    if(state_ != kConnected && state_ != kDisconnecting) return;
+
+    uint64_t now = TimerQueue::now();
+    uint64_t next = UINT64_MAX;
+    bool expired = false;
+    auto check = [&](uint64_t timeout, uint64_t last) {
+        if(timeout == 0) return;
+        if(now >= last + timeout) {
+            expired = true;
+        } else {
+            next = std::min(next, last + timeout);
+        }
+    };
+    check(options_->readIdleMs, lastReadMs_);
+    check(options_->writeIdleMs, lastWriteMs_);
+    check(options_->allIdleMs, std::max(lastReadMs_, lastWriteMs_));
+    if(expired) {
+        LOG_INFO("Connection {} idle timeout", name());
+        forceClose();
+        return;
+    }
+    std::weak_ptr<TcpConnection> weak = weak_from_this();
+    idleTimer_ = looper_.runAfter(static_cast<double>(next - now), [weak] {
+        if(auto conn = weak.lock()) {
+            conn->checkIdle();
+        }
+    });
+}
+void TcpConnection::touchRead() {
+    if(idleTimer_ >= 0) lastReadMs_ = TimerQueue::now();
+}
+void TcpConnection::touchWrite() {
+    if(idleTimer_ >= 0) lastWriteMs_ = TimerQueue::now();
+}
+
+/* 读取量回落后连续多次处理完仍只用到一小部分容量时收缩，连接转为空闲时由定时器收缩；
+ * 收缩的目标容量不小于近期的读取量，避免稳定的大流量连接反复收缩与扩容 */
+void TcpConnection::maybeShrink() {
+    const utils::Buffer& buffer = readBuffer_;
+    if(buffer.capacity() <= options_->shrinkPolicy.capacity) {
+        lowUsageRounds_ = 0;
+        updateFootprint();
+        return;
+    }
+    if(buffer.readableBytes() < buffer.capacity() * options_->shrinkPolicy.lowRatio) {
+        ++lowUsageRounds_;
+    } else {
+        lowUsageRounds_ = 0;
+    }
+    if(lowUsageRounds_ >= options_->shrinkPolicy.rounds) {
+        shrinkReadBuffer(false);
+    } else if(options_->shrinkPolicy.idleMs > 0.0) {
+        readSinceCheck_ = true;
+        if(shrinkTimer_ < 0) {
+            std::weak_ptr<TcpConnection> weak = weak_from_this();
+            shrinkTimer_ = looper_.runAfter(options_->shrinkPolicy.idleMs, [weak] {
+                if(auto conn = weak.lock()) {
+                    conn->checkShrink();
+                }
+            });
+        }
+    }
+    updateFootprint();
+}
+/* 上一个周期内有过读取时顺延一个周期，否则视为空闲 */
+void TcpConnection::checkShrink() {
+    shrinkTimer_ = -1;
+    if(state_ != kConnected) return;
+    if(readSinceCheck_) {
+        readSinceCheck_ = false;
+        std::weak_ptr<TcpConnection> weak = weak_from_this();
+        shrinkTimer_ = looper_.runAfter(options_->shrinkPolicy.idleMs, [weak] {
+            if(auto conn = weak.lock()) {
+                conn->checkShrink();
+            }
+        });
+        return;
+    }
+    shrinkReadBuffer(true);
+    updateFootprint();
+}
+void TcpConnection::shrinkReadBuffer(bool idle) {
+    /* 空闲后不再参考之前的读取量 */
+    if(idle) {
+        readEstimate_ = std::min(readEstimate_, options_->shrinkPolicy.capacity);
+    }
+    size_t capacity = std::max(options_->shrinkPolicy.capacity, utils::Buffer::kCheapPrepend + readEstimate_);
+    size_t released = readBuffer_.shrink(capacity);
+    if(released > 0) {
+        LOG_DEBUG("Shrink read buffer of {} by {} bytes", name(), released);
+    }
+    lowUsageRounds_ = 0;
+}
+void TcpConnection::updateFootprint() {
+    size_t footprint = readBuffer_.capacity() + sendBuffer_.footprint();
+    if(ext_) {
+        footprint += ext_->zeroCopyBytes;
+        if(ext_->inflight) footprint += ext_->inflight->data.footprint();
+    }
+    size_t previous = footprint_.load(std::memory_order_relaxed);
+    if(footprint != previous) {
+        footprint_.store(footprint, std::memory_order_relaxed);
+        looper_.addBufferBytes(static_cast<int64_t>(footprint) - static_cast<int64_t>(previous));
+    }
+}
+
+void TcpConnection::startCompletionIo() {
+    IoUringPoller* uring = looper_.ioUringPoller();
+    if(!uring || !poller::IoUring::multishotRecvSupported()) {
+        LOG_WARN("Completion I/O is not available, fall back to readiness(fd: {})", socket_.fd());
+        ioMode_ = kReadiness;
+        return;
+    }
+    Extension& ext = this->ext();
+    ext.inflight = std::make_shared<InflightSend>();
+    ext.completionKey = uring->addCompletion([this](const poller::IoUring::Cqe& cqe) {
+        if(IoUringPoller::tagOf(cqe) == kRecvTag) {
+            handleRecvComplete(cqe.res, cqe.flags);
+        } else {
+            handleSendComplete(cqe.res);
+        }
+    });
+    submitRecv();
+}
+/* multishot 接收，由内核从缓冲区组中挑选缓冲区，一次提交持续产生完成事件 */
+void TcpConnection::submitRecv() {
+    IoUringPoller* uring = looper_.ioUringPoller();
+    /* 缓冲区组首次创建时的提交条目需要排在接收请求之前 */
+    uint16_t group = uring->bufferGroup().group();
+    poller::IoUring::Sqe* sqe = uring->prepareSqe(ext_->completionKey, kRecvTag);
+    if(!sqe) return;
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->fd        = socket_.fd();
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = group;
+    ext_->recvArmed = true;
+}
+/* 没有进行中的发送请求时提交，inflight 中尚未发出的数据（提交队列已满、发送被打断）先于发送缓冲区提交 */
+void TcpConnection::startSend() {
+    Extension& ext = *ext_;
+    if(ext.sending || ext.writeThrottle >= 0 || state_ == kDisconnected) return;
+    if(ext.inflight->data.empty()) ext.inflight->data.swap(sendBuffer_);
+    if(!ext.inflight->data.empty()) submitSend();
+}
+void TcpConnection::submitSend() {
+    Extension& ext = *ext_;
+    InflightSend& inflight = *ext.inflight;
+    /* 文件分段先读入内存再提交 */
+    if(inflight.data.loadFile(kFileChunkSize) < 0) {
+        LOG_ERROR("Read file for sending failed(fd: {})", socket_.fd());
+        inflight.data.retrieveAll();
+        sendBuffer_.retrieveAll();
+        updateFootprint();
+        callbacks_->error(*this);
+        return;
+    }
+    /* 限速时至多提交当前的令牌数，令牌耗尽时由定时器稍后提交 */
+    size_t allowance = SIZE_MAX;
+    if(ext.writeMeter) {
+        allowance = ext.writeMeter.available(utils::TokenBucket::now());
+        if(allowance == 0) {
+            throttleWrite();
+            return;
+        }
+    }
+    poller::IoUring::Sqe* sqe = looper_.ioUringPoller()->prepareSqe(ext.completionKey, kSendTag);
+    if(!sqe) {
+        /* 提交队列已满，数据留在 inflight 中，下一个任务阶段重试 */
+        std::weak_ptr<TcpConnection> weak = weak_from_this();
+        looper_.queue([weak] {
+            if(auto conn = weak.lock()) conn->startSend();
+        });
+        return;
+    }
+    /* 以 sendmsg 一次提交多个分段 */
+    inflight.iov.resize(std::min<size_t>(inflight.data.numOfSegments(), utils::ChainBuffer::kMaxIovecs));
+    int count = inflight.data.peek(inflight.iov.data(), static_cast<int>(inflight.iov.size()));
+    count = utils::ChainBuffer::clamp(inflight.iov.data(), count, allowance);
+    bzero(&inflight.msg, sizeof inflight.msg);
+    inflight.msg.msg_iov    = inflight.iov.data();
+    inflight.msg.msg_iovlen = count;
+    sqe->opcode    = IORING_OP_SENDMSG;
+    sqe->fd        = socket_.fd();
+    sqe->addr      = reinterpret_cast<uint64_t>(&inflight.msg);
+    sqe->len       = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    ext.sending = true;
+}
+void TcpConnection::handleRecvComplete(int res, uint32_t flags) {
+    looper_.assert();
+
+    Extension& ext = *ext_;
+    if(!(flags & IORING_CQE_F_MORE)) ext.recvArmed = false;
+    if(res > 0 && (flags & IORING_CQE_F_BUFFER)) {
+        poller::BufferGroup& group = looper_.ioUringPoller()->bufferGroup();
+        uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        readBuffer_.append(group.data(bid), res);
+        group.recycle(bid);
+        touchRead();
+        /* 已经收下的数据照常处理，令牌耗尽时取消接收请求 */
+        if(ext.readMeter) {
+            int64_t now = utils::TokenBucket::now();
+            ext.readMeter.consume(res, now);
+            if(ext.readMeter.exhausted(now)) throttleRead();
+        }
+        /* 取消生效之前仍可能收到数据，暂停期间只放入读缓冲区，恢复时再交给回调 */
+        if(readPauses_ == 0) {
+            callbacks_->message(*this, readBuffer_, utils::Timestamp::now());
+            maybeShrink();
+        }
+    } else if(res == 0) {
+        disconnectComplete();
+        return;
+    } else if(res == -ECANCELED) {
+        /* 暂停读取时取消的接收请求，恢复读取可能早于取消完成，由下面重新提交 */
+    } else if(res == -ENOBUFS) {
+        warnNoBuffer(socket_.fd());
+        /* 立刻重新提交只会再次失败，借用限速的定时器稍后重新提交，期间其他连接处理完数据会归还缓冲区 */
+        if(!ext.recvArmed && ext.readThrottle < 0) {
+            std::weak_ptr<TcpConnection> weak = weak_from_this();
+            ext.readThrottle = looper_.runAfter(kNoBufferRetryMs, [weak] {
+                if(auto conn = weak.lock()) conn->unthrottleRead();
+            });
+        }
+    } else if(res < 0) {
+        LOG_ERROR("Recv error(fd: {}, err: {})", socket_.fd(), errnoStr(-res));
+        callbacks_->error(*this);
+        return;
+    }
+    if(!ext.recvArmed && readPauses_ == 0 && ext.readThrottle < 0 && state_ != kDisconnected && ext.completionKey != 0) {
+        submitRecv();
+    }
+}
+void TcpConnection::handleSendComplete(int res) {
+    looper_.assert();
+
+    if(res == -ECANCELED) return;
+    Extension& ext = *ext_;
+    ext.sending = false;
+    if(res == -EINTR || res == -EAGAIN) {
+        startSend();
+        return;
+    }
+    /* 其余错误无法恢复，未发出的数据不再发送 */
+    if(res < 0) {
+        LOG_ERROR("Send error(fd: {}, err: {})", socket_.fd(), errnoStr(-res));
+        callbacks_->error(*this);
+        forceClose();
+        return;
+    }
+    utils::ChainBuffer& inflight = ext.inflight->data;
+    inflight.retrieve(res);
+    if(res > 0) touchWrite();
+    if(inflight.empty() && !sendBuffer_.empty()) {
+        inflight.swap(sendBuffer_);
+    }
+    if(res > 0 && ext.writeMeter) {
+        int64_t now = utils::TokenBucket::now();
+        ext.writeMeter.consume(res, now);
+        if(!inflight.empty() && ext.writeMeter.exhausted(now)) throttleWrite();
+    }
+    updateFootprint();
+    checkBackpressure();
+    if(!inflight.empty()) {
+        /* 限速时由定时器稍后提交 */
+        if(ext.writeThrottle < 0) submitSend();
+        return;
+    }
+    if(callbacks_->writeComplete) {
+        looper_.queue([this] {
+            callbacks_->writeComplete(*this);
+        });
+    }
+    if(state_ == kDisconnecting) {
+        socket_.shutdownWrite();
+    }
 }
\ No newline at end of file
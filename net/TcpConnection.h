@@ -2,34 +2,114 @@
 
 /* Standard headers */
 #include <any>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 /* Local headers */
 #include "net/base/Event.h"
 #include "net/base/Socket.h"
 #include "utils/Buffer.h"
+#include "utils/ChainBuffer.h"
+#include "utils/MpscQueue.h"
 #include "utils/NonCopyable.h"
+#include "utils/SharedPayload.h"
 #include "utils/StringPiece.h"
 #include "utils/Timestamp.h"
+#include "utils/TokenBucket.h"
 #include "net/base/NetAddress.h"
+#include "net/timer/Timer.h"
 
 namespace esynet {
 
 class Looper;
 
-class TcpConnection : utils::NonCopyable {
+class TcpConnection : utils::NonCopyable,
+                      public std::enable_shared_from_this<TcpConnection> {
 private:
     using TcpInfo = Socket::TcpInfo;
     enum State { kDisconnected, kConnecting, kConnected, kDisconnecting };
 
 public:
     using TcpConnectionPtr      = std::shared_ptr<TcpConnection>;
+    /* 连接的编号，由创建者分配，TcpServer 中为连接表的键与所属 Looper 的序号，见 TcpServer */
+    using ID                    = uint64_t;
+    /* 名字的前缀，同一服务器的连接共享一份 */
+    using NamePtr               = std::shared_ptr<const std::string>;
     using ConnectionCallback    = std::function<void(TcpConnection&)>;
     using MessageCallback       = std::function<void(TcpConnection&, utils::Buffer&, utils::Timestamp)>;
     using HighWaterMarkCallback = std::function<void(TcpConnection&, size_t)>;
     using CloseCallback         = ConnectionCallback;
     using WriteCompleteCallback = ConnectionCallback;
     using ErrorCallback         = ConnectionCallback;
+    using ReleaseCallback       = utils::ChainBuffer::ReleaseCallback;
+
+    /* 连接的回调表，服务器的所有连接共享同一张不可变的表，连接只持有一个指针
+     * 在连接上单独设置某个回调时先复制一份自己的表，再修改其中的回调 */
+    struct Callbacks {
+        ConnectionCallback    connection;
+        MessageCallback       message;
+        WriteCompleteCallback writeComplete;
+        HighWaterMarkCallback highWaterMark;
+        CloseCallback         close;
+        ErrorCallback         error;
+    };
+    using CallbacksPtr = std::shared_ptr<const Callbacks>;
+
+    /* I/O 模式: kReadiness 为基于就绪通知的读写
+     * kCompletion 为基于 io_uring 的完成式读写，接收使用内核挑选的缓冲区，
+     * 仅在 Looper 使用 kIoUring 后端时可用，否则回退为 kReadiness */
+    enum IoMode { kReadiness, kCompletion };
+
+    static const size_t kEdgeBytesBudget;
+    static const int    kEdgeRoundsBudget;
+    static const size_t kZeroCopyThreshold;
+    static const size_t kRateQuantum;       /* 令牌耗尽后至少积攒这么多令牌再恢复读写 */
+
+    /* 单个连接在一轮循环中的读取预算，避免大流量的连接饿死同一 Looper 上的其他连接
+     * 水平触发时剩余数据由下一轮的就绪通知继续读取，边沿触发时推迟到下一轮 */
+    struct ReadBudget {
+        size_t bytes {kEdgeBytesBudget};    /* 每轮至多读取的字节数 */
+        int    reads {kEdgeRoundsBudget};   /* 边沿触发时每轮至多的 read 次数 */
+    };
+    struct FlowControl {
+        size_t highWaterMark {0};
+        size_t lowWaterMark  {0};
+        double evictAfterMs  {0.0};
+    };
+    /* 读缓冲区的收缩策略，容量超过 capacity 后满足以下任一条件即收缩：
+     * 连续 rounds 次读取并处理完之后，剩余的数据都不足容量的 lowRatio；idleMs 内没有新的数据
+     * 解码器以 Buffer::reserve 为未收全的帧预留的空间在整帧取走之前不会被收缩
+     * 发送缓冲区的分段在发送完后立即归还块池，不需要额外的策略 */
+    struct ShrinkPolicy {
+        size_t capacity {16_KB};    /* 收缩后的容量，不小于近期的读取量 */
+        int    rounds   {8};
+        double lowRatio {0.25};
+        double idleMs   {1000.0};   /* 0 表示不按空闲时间收缩 */
+    };
+    /* 连接的配置，与回调表相同，服务器的所有连接共享同一份不可变的配置，连接只持有一个指针
+     * 在连接上单独调用某个 setter 时先复制一份自己的配置，再修改其中的配置项 */
+    struct Options {
+        IoMode       ioMode        {kReadiness};
+        bool         edgeTriggered {false};
+        bool         corked        {false};
+        bool         queryReadable {false};
+        ReadBudget   readBudget;
+        ShrinkPolicy shrinkPolicy;
+        FlowControl  flowControl;
+        /* 空闲检测的超时时间，单位：毫秒，0 表示不检测 */
+        uint64_t     readIdleMs    {0};
+        uint64_t     writeIdleMs   {0};
+        uint64_t     allIdleMs     {0};
+        /* 以下各项在 connectComplete 中生效，之后修改需要调用连接上对应的 setter */
+        double       readRate      {0.0};
+        double       writeRate     {0.0};
+        size_t       rateBurst     {0};
+        std::shared_ptr<utils::TokenBucket> sharedReadRate;
+        std::shared_ptr<utils::TokenBucket> sharedWriteRate;
+        size_t       zeroCopyThreshold {0};
+    };
+    using OptionsPtr = std::shared_ptr<const Options>;
 
 public:
     static void defaultConnectionCallback(TcpConnection&);
@@ -38,15 +118,22 @@ public:
     static void defaultWriteCompleteCallback(TcpConnection&);
     static void defaultMessageCallback(TcpConnection&, utils::Buffer&, utils::Timestamp);
     static void defaultHighWaterMarkCallback(TcpConnection&, size_t);
+    /* 由以上默认回调组成的表，新连接默认共享这张表 */
+    static auto defaultCallbacks() -> const CallbacksPtr&;
+    /* 默认配置，新连接默认共享这份配置 */
+    static auto defaultOptions() -> const OptionsPtr&;
 
 public:
     TcpConnection(Looper&,
-                  utils::StringPiece name, Socket,
+                  ID id, NamePtr prefix, Socket,
                   const NetAddress& local,
-                  const NetAddress& peer);
+                  const NetAddress& peer,
+                  OptionsPtr options = defaultOptions());
     ~TcpConnection();
 
-    auto name()         const -> const std::string&;
+    auto id()           const -> ID;
+    /* 可读的名字，形如 前缀-对端地址:端口-编号，每次调用时生成，不在建立连接时拼接 */
+    auto name()         const -> std::string;
     auto localAddress() const -> const NetAddress&;
     auto peerAddress()  const -> const NetAddress&;
     auto tcpInfo()      const -> std::optional<TcpInfo>;
@@ -55,16 +142,78 @@ public:
     bool connected()    const;
     bool disconnected() const;
 
+    /* 以下发送均线程安全，在所属 Looper 线程中调用时直接发送，
+     * 其他线程中调用时放入连接的无锁发送队列，由所属 Looper 在一次任务中取出全部数据依次发送，
+     * 同一线程的多次发送保持顺序，队列非空期间的发送不会再次唤醒 Looper */
+
+    /* 拷贝发送，在其他线程中调用时会先拷贝一份 */
     void send(const void* data, size_t len);
     void send(const utils::StringPiece data);
+    void send(const char* data);
+    /* 转移所有权，数据以分段的形式挂入发送缓冲区，不做拷贝（较短的数据仍会拷贝）
+     * 带 release 的版本在数据发送完成或连接关闭后调用 release，此前 data 需要保持有效 */
+    void send(std::string&& data);
+    void send(utils::Buffer&& data);
+    void send(std::shared_ptr<const utils::Buffer> data);
+    void send(const void* data, size_t len, ReleaseCallback release);
+    /* 共享数据只挂入一个引用，多个连接发送同一条消息时不做拷贝 */
+    void send(const utils::SharedPayload& payload);
+    /* 发送文件 fd 中 [offset, offset + length) 的数据，与其他发送按调用顺序排列，
+     * 由内核以 sendfile 直接从文件发出，不经过用户态；fd 在 release 被调用之前需要保持打开
+     * 按路径发送时由连接打开文件并在发送完成后关闭，length 为 npos 时发送到文件末尾，未连接、offset 为负或文件无法打开时返回 false */
+    void sendFile(int fd, off_t offset, size_t length, ReleaseCallback release = nullptr);
+    bool sendFile(const std::string& path, off_t offset = 0, size_t length = std::string::npos);
     void shutdown();
     void forceClose();
     void forceCloseWithoutCallback();
     void setTcpNoDelay(bool);
+    /* 需要在 connectComplete 之前设置 */
+    void setIoMode(IoMode);
+    auto ioMode() const -> IoMode;
+    /* 就绪式 I/O 使用边沿触发，需要在 connectComplete 之前设置 */
+    void setEdgeTriggered(bool);
+    /* 读空闲、写空闲、读写均空闲的超时时间，单位：毫秒，0 表示不检测
+     * 超时后强制关闭连接，需要在 connectComplete 之前设置 */
+    void setIdleTimeout(double readIdle, double writeIdle, double allIdle);
+    void setReadBudget(ReadBudget);
+    /* 每次读取前以 FIONREAD 查询可读字节数来确定读取大小，代替按历史读取量的估计，
+     * 多一次系统调用，适合读取量波动很大的连接 */
+    void setQueryReadable(bool);
+    void setShrinkPolicy(ShrinkPolicy);
+    /* 流量控制：待发送的数据达到 highWaterMark 后暂停读取（或暂停 setBackpressureTarget 指定的连接），
+     * 降到 lowWaterMark 以下时恢复，持续超过高水位 evictAfterMs 毫秒后强制关闭连接
+     * highWaterMark 为 0 表示关闭，evictAfterMs 为 0 表示不关闭 */
+    void setFlowControl(FlowControl);
+    /* 代理等场景中暂停的是数据来源一侧的连接，目标连接可以属于其他 Looper */
+    void setBackpressureTarget(const TcpConnectionPtr&);
+    /* 线程安全，暂停与恢复读取，可以叠加，每次 pauseReading 对应一次 resumeReading */
+    void pauseReading();
+    void resumeReading();
+    auto isReadingPaused() const -> bool;
+    /* 合并写出：send 只追加到发送缓冲区，由 Looper 在每轮循环的刷新阶段以一次 writev 写出，
+     * 一轮中的多次发送只产生一次系统调用，代价是数据推迟到本轮的事件与任务处理完之后才发出
+     * 仅对就绪式 I/O 生效 */
+    void setCorked(bool);
+    /* 不短于 threshold 且转移了所有权的数据以 MSG_ZEROCOPY 发送，0 表示关闭，仅对就绪式 I/O 生效
+     * 数据在内核的完成通知到达之后才释放（release 回调此时才被调用），通知由错误队列送达；
+     * 内核回退为拷贝（如回环连接）后不再使用零拷贝 */
+    void setZeroCopy(size_t threshold = kZeroCopyThreshold);
+    /* 读写带宽限制，单位：字节/秒，0 表示不限制；burst 为令牌桶的容量，0 表示取 1 秒的量
+     * 令牌耗尽时注销对应方向的读写监听（完成式 I/O 取消接收请求、暂停提交发送），
+     * 由 Looper 的定时器在令牌足够时重新监听，不会空转 */
+    void setRateLimit(double readBytesPerSec, double writeBytesPerSec, size_t burst = 0);
+    /* 与其他连接共享的令牌桶，与自身的限制同时生效，用于服务器级的总带宽限制，为空表示不限制 */
+    void setSharedRateLimit(std::shared_ptr<utils::TokenBucket> read, std::shared_ptr<utils::TokenBucket> write);
+    /* 线程安全，读写缓冲区当前占用的内存，各连接的总和计入所属 Looper 的 metrics().bufferBytes */
+    auto bufferFootprint() const -> size_t;
 
     void setContext(const std::any&);
     auto getContext() const -> const std::any&;
 
+    /* 改为共享 options，之前在连接上单独修改的配置随之失效，需要在 connectComplete 之前设置 */
+    void setOptions(OptionsPtr options);
+    /* 改为共享 callbacks，之前在连接上单独设置的回调随之失效，需要在 connectComplete 之前设置 */
+    void setCallbacks(CallbacksPtr callbacks);
     void setConnectionCallback(const ConnectionCallback&);
     void setMessageCallback(const MessageCallback&);
     void setWriteCompleteCallback(const WriteCompleteCallback&);
@@ -78,14 +227,104 @@ public:
     void disconnectComplete();
 
 private:
+    /* 跨线程发送队列的节点，fd 不小于 0 时为文件分段 */
+    struct OutboxNode {
+        OutboxNode* next;
+        const char* data;
+        size_t len;
+        std::shared_ptr<const void> owner;
+        int fd {-1};
+        off_t offset {0};
+    };
+    /* 带宽限制：一个方向上连接自身与服务器共享的令牌桶，取两者中较紧的一个 */
+    struct RateMeter {
+        std::shared_ptr<utils::TokenBucket> own;
+        std::shared_ptr<utils::TokenBucket> shared;
+
+        explicit operator bool() const { return own || shared; }
+        auto available(int64_t now) const -> size_t;
+        void consume(size_t bytes, int64_t now);
+        auto waitFor(size_t bytes, int64_t now) const -> int64_t;
+        /* 剩余令牌不足 kRateQuantum，继续读写只会得到零碎的小块 */
+        auto exhausted(int64_t now) const -> bool;
+    };
+    /* 正在由内核发送的数据，连接关闭后仍需保持到请求结束 */
+    struct InflightSend;
+    /* 带宽限制、零拷贝、流量控制与完成式 I/O 的状态，多数连接用不到，第一次用到时才分配，
+     * 未分配时这些功能都处于关闭状态，空闲连接只多占一个指针 */
+    struct Extension;
+
+    /* 所有权已转移的数据，在所属 Looper 线程中直接发送，否则放入发送队列 */
+    void post(const char* data, size_t len, std::shared_ptr<const void> owner);
+    void post(OutboxNode*);
+    void drainOutbox();
+    void sendInLoop(const void* data, size_t len, std::shared_ptr<const void> owner);
+    void sendFileInLoop(int fd, off_t offset, size_t len, std::shared_ptr<const void> owner);
+    void shutdownInLoop();
     void handleRead();
+    /* 本次读取预期的字节数，连接缓冲区会预先留出这么多空间 */
+    auto nextReadSize(size_t remaining) -> size_t;
+    /* 每次处理完读取的数据后检查是否需要收缩读缓冲区 */
+    void maybeShrink();
+    void checkShrink();
+    void shrinkReadBuffer(bool idle);
+    void updateFootprint();
     void handleWrite();
+    void checkBackpressure();
+    void evict();
+    auto backpressureTarget() -> TcpConnectionPtr;
+    void flushOutput();
+    void writeBuffered();
+    /* 以 writev、sendfile 或零拷贝发送一次发送缓冲区头部的数据 */
+    auto writeOnce() -> ssize_t;
+    /* 发送缓冲区原本为空、新数据整段挂入缓冲区（文件分段、零拷贝）后立刻尝试发送一次 */
+    void writeImmediately();
+    void handleError();
+    /* 令牌耗尽时注销监听，定时器到期后恢复 */
+    void throttleRead();
+    void unthrottleRead();
+    void throttleWrite();
+    void unthrottleWrite();
+    /* 没有被限速时监听可写事件 */
+    void armWrite();
+    /* 扩展状态，第一次调用时分配 */
+    auto ext() -> Extension&;
+    /* 没有分配扩展状态或没有限速时为空 */
+    auto readMeter()  -> RateMeter*;
+    auto writeMeter() -> RateMeter*;
+    bool readThrottled()  const;
+    bool writeThrottled() const;
+    /* 完成式 I/O 中正在由内核发送的数据，就绪式 I/O 时为空 */
+    auto inflightSend() const -> InflightSend*;
+    /* 读取错误队列中的零拷贝完成通知并释放对应的数据，返回是否读到了通知 */
+    bool handleZeroCopyCompletion();
     void handleClose();
+    void detachIo();
+    void closeSocket();
+    /* 连接自己的回调表，第一次调用时从共享的表复制 */
+    auto ownCallbacks() -> Callbacks&;
+    /* 连接自己的配置，第一次调用时从共享的配置复制 */
+    auto ownOptions() -> Options&;
     std::string stateToString() const;
 
+    /* 空闲检测：读写时只记录时间，由定时器到期时检查，未超时则按剩余时间重新注册 */
+    void startIdleTimer();
+    void checkIdle();
+    void touchRead();
+    void touchWrite();
+
+    /* 完成式 I/O */
+    void startCompletionIo();
+    void submitRecv();
+    void startSend();
+    void submitSend();
+    void handleRecvComplete(int res, uint32_t flags);
+    void handleSendComplete(int res);
+
 private:
     Looper& looper_;
-    const std::string name_;
+    const ID id_;
+    const NamePtr prefix_;
 
     Event event_;
     Socket socket_;
@@ -93,18 +332,43 @@ private:
     const NetAddress localAddr_;
     std::atomic<State> state_{kConnecting};
 
-    CloseCallback closeCb_;
-    ErrorCallback errorCb_;
-    MessageCallback messageCb_;
-    ConnectionCallback connectionCb_;
-    WriteCompleteCallback writeCompleteCb_;
-    HighWaterMarkCallback highWaterMarkCb_;
+    /* 共享的回调表；ownCallbacks_ 指向连接自己复制的表，未复制时为空 */
+    CallbacksPtr callbacks_;
+    Callbacks* ownCallbacks_ {nullptr};
+    /* 共享的配置；ownOptions_ 指向连接自己复制的配置，未复制时为空 */
+    OptionsPtr options_;
+    Options* ownOptions_ {nullptr};
 
     size_t highWaterMark_{64_MB};
 
     std::any context_;
+    /* 连接可能在其他线程中创建，读缓冲区在所属 Looper 上第一次读取时才分配内存块 */
     utils::Buffer readBuffer_;
-    utils::Buffer sendBuffer_;
+    utils::ChainBuffer sendBuffer_;
+    utils::MpscQueue<OutboxNode> outbox_;
+
+    /* 实际使用的 I/O 模式，完成式 I/O 不可用时回退为 kReadiness */
+    IoMode ioMode_ {kReadiness};
+
+    /* 读取大小：最近读取量的指数加权移动平均 */
+    size_t readEstimate_ {utils::Buffer::kInitialSize};
+
+    /* 缓冲区收缩与内存统计 */
+    int lowUsageRounds_ {0};
+    bool readSinceCheck_ {false};
+    timer::Timer::ID shrinkTimer_ {-1};
+    std::atomic<size_t> footprint_ {0};
+
+    /* pauseReading 的次数，流量控制与内存预算都会暂停读取 */
+    std::atomic<int> readPauses_ {0};
+
+    /* 带宽限制、零拷贝、流量控制与完成式 I/O 的状态，见 Extension */
+    std::unique_ptr<Extension> ext_;
+
+    /* 空闲检测，时间为单调时钟刻度，单位：毫秒 */
+    uint64_t lastReadMs_  {0};
+    uint64_t lastWriteMs_ {0};
+    timer::Timer::ID idleTimer_ {-1};
 };
 
 } /* namespace esynet */
\ No newline at end of file
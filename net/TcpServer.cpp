@@ -4,24 +4,27 @@
 #include "net/base/Looper.h"
 
 /* Standard headers */
+#include <cmath>
+#include <vector>
+#include <algorithm>
 #include <functional>
 
 using esynet::Looper;
 using esynet::TcpServer;
 using esynet::ReactorThreadPoll;
 
-TcpServer::TcpServer(NetAddress addr, utils::StringPiece name, bool useEpoll):
-        looper_(useEpoll),
+TcpServer::TcpServer(NetAddress addr, utils::StringPiece name, Looper::Backend backend):
+        looper_(backend),
         port_(addr.port()),
         ip_(addr.ip()),
         name_(name.asString()),
+        namePrefix_(std::make_shared<const std::string>(name_)),
         acceptor_(looper_, addr),
+        governor_(acceptor_),
         threadPoll_(looper_) {
-    connectionCb_    = TcpConnection::defaultConnectionCallback;
-    writeCompleteCb_ = TcpConnection::defaultWriteCompleteCallback;
-    messageCb_       = TcpConnection::defaultMessageCallback;
-    closeCb_         = TcpConnection::defaultCloseCallback;
-    errorCb_         = TcpConnection::defaultErrorCallback;
+    callbacks_       = *TcpConnection::defaultCallbacks();
+    closeCb_         = callbacks_.close;
+    callbacks_.close = std::bind(&TcpServer::removeConnection, this, std::placeholders::_1);
     acceptor_.setAcceptCallback(std::bind(&TcpServer::onConnection, this,
                                 std::placeholders::_1, std::placeholders::_2));
 }
@@ -33,6 +36,11 @@ void TcpServer::start() {
 
     threadPoll_.start();
     acceptor_.listen();
+    if(governor_.budget().limit > 0) {
+        looper_.runEvery(governor_.budget().intervalMs, [this] {
+            reconcileMemory();
+        });
+    }
     started_ = true;
     looper_.start();
 }
@@ -40,9 +48,10 @@ void TcpServer::shutdown() {
     looper_.assert();
 
     acceptor_.shutdown();
-    for(auto& iter : connections_) {
-        iter.second->looper().run([&iter] {
-            iter.second->forceCloseWithoutCallback();
+    /* 连接由任务持有，在其 Looper 线程中关闭并析构 */
+    for(const TcpConnectionPtr& conn : connections_) {
+        conn->looper().run([conn] {
+            conn->forceCloseWithoutCallback();
         });
     }
     connections_.clear();
@@ -55,19 +64,27 @@ const int           TcpServer::port() const { return port_; }
 Looper& TcpServer::looper() { return looper_; }
 
 void TcpServer::setConnectionCallback(const ConnectionCallback& cb) {
-    connectionCb_ = std::move(cb);
+    callbacks_.connection = cb;
+    table_.reset();
 }
 void TcpServer::setMessageCallback(const MessageCallback& cb) {
-    messageCb_ = std::move(cb);
+    callbacks_.message = cb;
+    table_.reset();
 }
 void TcpServer::setWriteCompleteCallback(const WriteCompleteCallback& cb) {
-    writeCompleteCb_ = std::move(cb);
+    callbacks_.writeComplete = cb;
+    table_.reset();
 }
 void TcpServer::setCloseCallback(const CloseCallback& cb) {
-    closeCb_ = std::move(cb);
+    closeCb_ = cb;
 }
 void TcpServer::setErrorCallback(const ErrorCallback& cb) {
-    errorCb_ = std::move(cb);
+    callbacks_.error = cb;
+    table_.reset();
+}
+auto TcpServer::callbackTable() -> const CallbacksPtr& {
+    if(!table_) table_ = std::make_shared<const Callbacks>(callbacks_);
+    return table_;
 }
 
 void TcpServer::setThreadInitCallback(const ThreadInitCallback& cb) {
@@ -77,6 +94,80 @@ void TcpServer::setThreadNumInPool(size_t numThreads) {
     threadPoll_.setThreadNum(numThreads);
 }
 
+void TcpServer::setIoMode(IoMode mode) {
+    options_.ioMode = mode;
+    sharedOptions_.reset();
+}
+void TcpServer::setEdgeTriggered(bool on) {
+    options_.edgeTriggered = on;
+    sharedOptions_.reset();
+    acceptor_.setEdgeTriggered(on);
+}
+void TcpServer::setIdleTimeout(double readIdle, double writeIdle, double allIdle) {
+    auto toMs = [](double ms) { return ms > 0.0 ? static_cast<uint64_t>(std::ceil(ms)) : 0; };
+    options_.readIdleMs  = toMs(readIdle);
+    options_.writeIdleMs = toMs(writeIdle);
+    options_.allIdleMs   = toMs(allIdle);
+    sharedOptions_.reset();
+}
+void TcpServer::setReadBudget(ReadBudget budget) {
+    budget.bytes = std::max<size_t>(budget.bytes, 1);
+    budget.reads = std::max(budget.reads, 1);
+    options_.readBudget = budget;
+    sharedOptions_.reset();
+}
+void TcpServer::setQueryReadable(bool on) {
+    options_.queryReadable = on;
+    sharedOptions_.reset();
+}
+void TcpServer::setShrinkPolicy(ShrinkPolicy policy) {
+    policy.rounds = std::max(policy.rounds, 1);
+    options_.shrinkPolicy = policy;
+    sharedOptions_.reset();
+}
+void TcpServer::setCorked(bool on) {
+    options_.corked = on;
+    sharedOptions_.reset();
+}
+void TcpServer::setFlowControl(FlowControl control) {
+    control.lowWaterMark = std::min(control.lowWaterMark, control.highWaterMark);
+    options_.flowControl = control;
+    sharedOptions_.reset();
+}
+void TcpServer::setRateLimit(double readBytesPerSec, double writeBytesPerSec, size_t burst) {
+    options_.readRate  = readBytesPerSec;
+    options_.writeRate = writeBytesPerSec;
+    options_.rateBurst = burst;
+    sharedOptions_.reset();
+}
+void TcpServer::setAggregateRateLimit(double readBytesPerSec, double writeBytesPerSec, size_t burst) {
+    auto bucket = [burst](double rate) -> std::shared_ptr<utils::TokenBucket> {
+        if(rate <= 0.0) return nullptr;
+        return std::make_shared<utils::TokenBucket>(rate, burst > 0 ? burst : static_cast<size_t>(rate));
+    };
+    options_.sharedReadRate  = bucket(readBytesPerSec);
+    options_.sharedWriteRate = bucket(writeBytesPerSec);
+    sharedOptions_.reset();
+}
+void TcpServer::setMemoryBudget(MemoryBudget budget) {
+    governor_.setBudget(budget);
+}
+auto TcpServer::memoryStats() const -> MemoryGovernor::Stats {
+    return governor_.stats();
+}
+void TcpServer::setZeroCopy(size_t threshold) {
+    options_.zeroCopyThreshold = threshold;
+    sharedOptions_.reset();
+}
+auto TcpServer::sharedOptions() -> const OptionsPtr& {
+    if(!sharedOptions_) sharedOptions_ = std::make_shared<const Options>(options_);
+    return sharedOptions_;
+}
+
+size_t TcpServer::reactorOf(ConnectionID id) {
+    return static_cast<size_t>(id >> kReactorShift);
+}
+
 ReactorThreadPoll& TcpServer::threadPoll() {
     return threadPoll_;
 }
@@ -84,6 +175,27 @@ void TcpServer::setThreadPollStrategy(Strategy strategy) {
     strategy_ = strategy;
 }
 
+/* 连接表只在主 Looper 线程中访问，先在主 Looper 中按编号中的 Looper 序号分组，
+ * 再向每个 Looper 投递一个任务，由它依次写入各连接 */
+void TcpServer::broadcast(const utils::SharedPayload& payload, BroadcastFilter filter) {
+    if(payload.empty()) return;
+    looper_.run([this, payload, filter = std::move(filter)] {
+        std::vector<std::vector<TcpConnectionPtr>> groups(threadPoll_.getAllReactors().size());
+        for(const TcpConnectionPtr& conn : connections_) {
+            groups[reactorOf(conn->id())].push_back(conn);
+        }
+        for(auto& conns : groups) {
+            if(conns.empty()) continue;
+            conns.front()->looper().run([payload, filter, conns = std::move(conns)] {
+                for(const TcpConnectionPtr& conn : conns) {
+                    if(filter && !filter(*conn)) continue;
+                    conn->send(payload);
+                }
+            });
+        }
+    });
+}
+
 void TcpServer::onConnection(Socket socket, const NetAddress& peerAddr) {
     looper_.assert();
 
@@ -93,9 +205,9 @@ void TcpServer::onConnection(Socket socket, const NetAddress& peerAddr) {
     } else {
         looper = threadPoll_.getNext();
     }
-    std::string connName = name_ + "-" + peerAddr.ip() + ":"
-                         + std::to_string(peerAddr.port())
-                         + "-" + std::to_string(connectionCount_++);
+    /* 编号在插入连接表之前确定，名字在需要时才由编号生成 */
+    ConnectionID id = connections_.nextKey()
+                    | static_cast<ConnectionID>(threadPoll_.indexOf(*looper)) << kReactorShift;
 
     std::optional<NetAddress> local = NetAddress::getLocalAddr(socket);
     NetAddress localAddr;
@@ -104,23 +216,44 @@ void TcpServer::onConnection(Socket socket, const NetAddress& peerAddr) {
     } else {
         LOG_ERROR("Failed getLocalAddr(fd: )", socket.fd());
     }
-    TcpConnectionPtr conn = std::make_shared<TcpConnection>(
-                                *looper, connName, socket, localAddr, peerAddr);
-    connections_[conn->name()] = conn;
-    conn->setConnectionCallback(connectionCb_);
-    conn->setMessageCallback(messageCb_);
-    conn->setWriteCompleteCallback(writeCompleteCb_);
-    conn->setErrorCallback(errorCb_);
-    conn->setCloseCallback(std::bind(&TcpServer::removeConnection, this, std::placeholders::_1));
-    looper->run([conn] {
+    /* 连接与 shared_ptr 的控制块一起分配在主 Looper 的 Slab 中，所有 reactor 共用这一个 Slab：
+     * 只有主 Looper 分配，空闲链表不加锁；连接在所属 reactor 中析构时压入 Slab 的远程链表，
+     * 主 Looper 的空闲链表用尽时一次取回 */
+    TcpConnectionPtr conn = std::allocate_shared<TcpConnection>(
+                                utils::SlabAllocator<TcpConnection>(looper_.slab()),
+                                *looper, id, namePrefix_, socket, localAddr, peerAddr, sharedOptions());
+    connections_.insert(conn);
+    /* 回调表与配置都是共享的，交给所属 Looper 的只有这一个任务 */
+    looper->run([conn, callbacks = callbackTable()] {
+        conn->setCallbacks(callbacks);
         conn->connectComplete();
     });
 }
 
-void TcpServer::removeConnection(TcpConnection& conn) {
+/* 各 Looper 无锁地累计本线程连接的缓冲区占用，在主 Looper 中汇总后交给 MemoryGovernor */
+void TcpServer::reconcileMemory() {
     looper_.assert();
 
-    connections_.erase(conn.name());
-    Looper& ioReactor = conn.looper();
+    size_t usage = 0;
+    for(const LooperMetrics::Snapshot& metrics : threadPoll_.getAllMetrics()) {
+        usage += metrics.bufferBytes;
+    }
+    governor_.reconcile(usage, connections_);
+}
+
+/* 在连接所属的 Looper 线程中调用，连接表只在主 Looper 线程中修改 */
+void TcpServer::removeConnection(TcpConnection& conn) {
+    conn.looper().assert();
+
     closeCb_(conn);
+    looper_.run([this, id = conn.id()] {
+        TcpConnectionPtr* found = connections_.find(id);
+        if(!found) return;
+        TcpConnectionPtr guard = std::move(*found);
+        connections_.erase(id);
+        /* 此时该连接可能仍处于事件回调中，延迟到其 Looper 的任务阶段再析构；
+         * 最后一个引用随任务转移过去，缓冲区的内存块由所属 Looper 的块池回收 */
+        Looper& owner = guard->looper();
+        owner.queue([guard = std::move(guard)] {});
+    });
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #pragma once
 
+/* Standard headers */
+#include <string>
+
 /* Local headers */
 #include "net/Acceptor.h"
+#include "net/MemoryGovernor.h"
 #include "net/thread/ReactorThreadPoll.h"
 #include "utils/NonCopyable.h"
+#include "utils/SlotMap.h"
 #include "utils/StringPiece.h"
 #include "net/TcpConnection.h"
 #include "net/base/Socket.h"
@@ -13,26 +18,41 @@ namespace esynet {
 
 class Looper;
 
-/* 非线程安全 */
+/* 非线程安全
+ * 连接的编号低 48 位为连接表的键（槽位与代数），高 16 位为所属 Looper 在线程池中的序号 */
 class TcpServer : public utils::NonCopyable {
 private:
     using TcpConnectionPtr      = TcpConnection::TcpConnectionPtr;
-    using ConnectionMap         = std::map<std::string, TcpConnectionPtr>;
+    using ConnectionID          = TcpConnection::ID;
+    using ConnectionMap         = MemoryGovernor::ConnectionMap;
 
     using ConnectionCallback    = TcpConnection::ConnectionCallback;
     using WriteCompleteCallback = TcpConnection::WriteCompleteCallback;
     using MessageCallback       = TcpConnection::MessageCallback;
     using CloseCallback         = TcpConnection::CloseCallback;
     using ErrorCallback         = TcpConnection::ErrorCallback;
+    using Callbacks             = TcpConnection::Callbacks;
+    using CallbacksPtr          = TcpConnection::CallbacksPtr;
+    using IoMode                = TcpConnection::IoMode;
+    using ReadBudget            = TcpConnection::ReadBudget;
+    using ShrinkPolicy          = TcpConnection::ShrinkPolicy;
+    using FlowControl           = TcpConnection::FlowControl;
+    using Options               = TcpConnection::Options;
+    using OptionsPtr            = TcpConnection::OptionsPtr;
+    using MemoryBudget          = MemoryGovernor::Budget;
     using ThreadInitCallback    = std::function<void(Looper&)>;
+    using BroadcastFilter       = std::function<bool(const TcpConnection&)>;
 
 public:
     enum Strategy { kRoundRobin, kLightest };
 
+    static const int kReactorShift = utils::SlotMap<TcpConnectionPtr>::kIndexBits
+                                   + utils::SlotMap<TcpConnectionPtr>::kGenerationBits;
+
 public:
     TcpServer(NetAddress         addr = 8080,
               utils::StringPiece name = "Server",
-              bool               useEpoll = true);
+              Looper::Backend    backend = Looper::kEpoll);
     ~TcpServer() = default;
 
     /* 线程安全 */
@@ -48,6 +68,36 @@ public:
     void setErrorCallback(const ErrorCallback&);
     void setThreadInitCallback(const ThreadInitCallback&);
     void setThreadNumInPool(size_t numThreads = 0);
+    /* 新连接的 I/O 模式，kCompletion 需要 Looper::kIoUring 后端 */
+    void setIoMode(IoMode);
+    /* 监听套接字与新连接使用边沿触发，仅对 Looper::kEpoll 后端生效 */
+    void setEdgeTriggered(bool);
+    /* 新连接的读空闲、写空闲、读写均空闲超时，单位：毫秒，0 表示不检测
+     * 由连接所属 Looper 的时间轮跟踪，超时的连接经 removeConnection 关闭 */
+    void setIdleTimeout(double readIdle, double writeIdle, double allIdle);
+    /* 新连接每轮循环的读取预算，以及是否以 FIONREAD 确定读取大小 */
+    void setReadBudget(ReadBudget);
+    void setQueryReadable(bool);
+    /* 新连接读缓冲区的收缩策略，各 Looper 上连接缓冲区的总占用见 LooperMetrics::Snapshot::bufferBytes */
+    void setShrinkPolicy(ShrinkPolicy);
+    /* 新连接合并每轮循环中的发送，见 TcpConnection::setCorked */
+    void setCorked(bool);
+    /* 新连接的流量控制，见 TcpConnection::setFlowControl */
+    void setFlowControl(FlowControl);
+    /* 新连接各自的读写带宽限制，见 TcpConnection::setRateLimit */
+    void setRateLimit(double readBytesPerSec, double writeBytesPerSec, size_t burst = 0);
+    /* 所有连接合计的读写带宽限制，由各 Looper 上的连接共享一对令牌桶，需要在 start 之前设置 */
+    void setAggregateRateLimit(double readBytesPerSec, double writeBytesPerSec, size_t burst = 0);
+    /* 所有连接读写缓冲区的总内存预算，超出时逐级暂停接受、暂停读取、关闭占用最大的连接，
+     * 见 MemoryGovernor；需要在 start 之前设置 */
+    void setMemoryBudget(MemoryBudget);
+    /* 线程安全，最近一次汇总的占用与各级响应的次数 */
+    auto memoryStats() const -> MemoryGovernor::Stats;
+    /* 新连接以 MSG_ZEROCOPY 发送不短于 threshold 的数据，0 表示关闭 */
+    void setZeroCopy(size_t threshold = TcpConnection::kZeroCopyThreshold);
+
+    /* 编号中所属 Looper 的序号，与 threadPoll().getAllReactors() 的下标一致 */
+    static auto reactorOf(ConnectionID) -> size_t;
 
     auto threadPoll() -> ReactorThreadPoll&;
     void setThreadPollStrategy(Strategy strategy);
@@ -55,27 +105,40 @@ public:
     void start();
     void shutdown();
 
+    /* 线程安全，把同一份数据发送给所有（filter 返回 true 的）连接，数据不做拷贝
+     * 按连接所属的 Looper 分批，每个 Looper 只唤醒一次，filter 在连接所属的 Looper 线程中调用 */
+    void broadcast(const utils::SharedPayload& payload, BroadcastFilter filter = nullptr);
+
 private:
     void onConnection(Socket, const NetAddress&);
     void removeConnection(TcpConnection&);
+    void reconcileMemory();
+    auto callbackTable() -> const CallbacksPtr&;
+    auto sharedOptions() -> const OptionsPtr&;
 
     Looper looper_;
     const int port_;
     const std::string ip_;
     const std::string name_;
+    const TcpConnection::NamePtr namePrefix_;
     std::atomic<bool> started_{false};
 
     Acceptor acceptor_;
+    MemoryGovernor governor_;
     ReactorThreadPoll threadPoll_;
     Strategy strategy_{kRoundRobin};
 
+    /* 所有连接共享同一份配置 sharedOptions_，与回调表相同，修改配置后在下一个连接建立时重新生成，
+     * 新连接在构造时直接取用，不再逐项投递设置任务 */
+    Options options_;
+    OptionsPtr sharedOptions_;
+
+    /* 所有连接共享同一张回调表 table_，设置回调后在下一个连接建立时重新生成，已有的连接仍使用旧表
+     * 表中的关闭回调为 removeConnection，用户的关闭回调由它调用 */
     CloseCallback closeCb_;
-    ErrorCallback errorCb_;
-    MessageCallback messageCb_;
-    ConnectionCallback connectionCb_;
-    WriteCompleteCallback writeCompleteCb_;
+    Callbacks callbacks_;
+    CallbacksPtr table_;
 
-    int connectionCount_{1};
     ConnectionMap connections_;
 };
 
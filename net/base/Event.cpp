@@ -11,7 +11,8 @@ using esynet::Looper;
 Event::Event(Looper& looper, int fd): looper_(looper), fd_(fd) {}
 
 void Event::handle() {
-    if(happenedEvents_ & kCloseEvent) {
+    /* 对端关闭但仍有数据可读时交由读回调处理，读到 EOF 后再关闭 */
+    if((happenedEvents_ & kCloseEvent) && !(happenedEvents_ & POLLIN)) {
         LOG_DEBUG("handle close event(fd: {})", fd_);
         if(closeCallback_) closeCallback_();
     }
@@ -33,11 +34,16 @@ void Event::setCloseCallback(Callback callback) { closeCallback_ = std::move(cal
 void Event::setReadCallback(Callback callback)  { readCallback_  = std::move(callback); }
 void Event::setWriteCallback(Callback callback) { writeCallback_ = std::move(callback); }
 void Event::setErrorCallback(Callback callback) { errorCallback_ = std::move(callback); }
+void Event::setFlushCallback(Callback callback) { flushCallback_ = std::move(callback); }
 
 int      Event::fd()            const { return fd_; }
 short    Event::listenedEvent() const { return listenedEvents_; }
+short    Event::happenedEvent() const { return happenedEvents_; }
 bool     Event::writable()      const { return happenedEvents_ & kWriteEvent; }
 bool     Event::readable()      const { return happenedEvents_ & kReadEvent; }
+bool     Event::isWriting()     const { return listenedEvents_ > 0 && (listenedEvents_ & kWriteEvent); }
+bool     Event::isReading()     const { return listenedEvents_ > 0 && (listenedEvents_ & kReadEvent); }
+bool     Event::edgeTriggered() const { return edgeTriggered_; }
 Looper*  Event::looper()        const { return &looper_; }
 int      Event::index()         const { return indexInPoll_; }
 void Event::setHappenedEvent(int event) { happenedEvents_ = event; }
@@ -65,8 +71,33 @@ void Event::disableRead() {
 }
 void Event::cancel() {
     listenedEvents_ = kNoneEvent;
+    deferredEvents_ = 0;
+    flushPending_ = false;
     looper_.removeEvent(*this);
 }
+void Event::setEdgeTriggered(bool on) {
+    if(edgeTriggered_ == on) return;
+    edgeTriggered_ = on;
+    if(listenedEvents_ > 0) update();
+}
+void Event::defer(short events) {
+    if(deferredEvents_ == 0) looper_.deferEvent(*this);
+    deferredEvents_ |= events;
+}
+short Event::takeDeferred() {
+    short events = deferredEvents_;
+    deferredEvents_ = 0;
+    return events;
+}
+void Event::scheduleFlush() {
+    if(flushPending_) return;
+    flushPending_ = true;
+    looper_.flushLater(*this);
+}
+void Event::flush() {
+    flushPending_ = false;
+    if(flushCallback_) flushCallback_();
+}
 void Event::update() {
     looper_.updateEvent(*this);
 }
\ No newline at end of file
@@ -25,11 +25,16 @@ public:
     void setReadCallback(Callback);
     void setWriteCallback(Callback);
     void setErrorCallback(Callback);
+    void setFlushCallback(Callback);
 
     int   fd()            const;
     short listenedEvent() const;
+    short happenedEvent() const;
     bool  writable()      const;
     bool  readable()      const;
+    bool  isWriting()     const;      /* 是否在监听可写事件 */
+    bool  isReading()     const;
+    bool  edgeTriggered() const;
     void  setHappenedEvent(int event);
 
     /* 设置监听事件 */
@@ -38,6 +43,16 @@ public:
     void disableWrite();
     void disableRead();
     void cancel();
+    /* 边沿触发，仅 EpollPoller 支持，其余 Poller 下仍为水平触发。使用者需要
+     * 在回调中读写直至 EAGAIN，因预算耗尽而未读写完时调用 defer */
+    void setEdgeTriggered(bool);
+    /* 在下一轮循环中直接以 events 再次处理该事件，不必等待新的就绪通知 */
+    void defer(short events);
+    auto takeDeferred() -> short;
+    /* 有待写出的数据，在本轮循环的刷新阶段调用 flush 回调，一轮中多次调用只刷新一次 */
+    void scheduleFlush();
+    /* 由 Looper 在刷新阶段调用 */
+    void flush();
 
     /* Poller */
     int index() const;
@@ -45,7 +60,7 @@ public:
 
     Looper* looper() const;
 
-private:
+public:
     /* EPOLLIN 等宏定义应该与 POLLIN 等宏定义一致 */
     enum {
         kNoneEvent = -1,
@@ -63,11 +78,15 @@ private:
     int   indexInPoll_    {-1};
     short listenedEvents_ {-1};
     short happenedEvents_ {0};
+    short deferredEvents_ {0};
+    bool  edgeTriggered_  {false};
+    bool  flushPending_   {false};
 
     Callback readCallback_;
     Callback writeCallback_;
     Callback errorCallback_;
     Callback closeCallback_;
+    Callback flushCallback_;
 };
 
 } /* namespace esynet */
\ No newline at end of file
@@ -1,20 +1,29 @@
 #include "net/base/Looper.h"
 
+/* Standard headers */
+#include <algorithm>
+
 /* Local headers */
 #include "net/base/Event.h"
+#include "net/base/ZeroCopyReaper.h"
 #include "logger/Logger.h"
 #include "net/poller/PollPoller.h"
 #include "net/poller/EpollPoller.h"
+#include "net/poller/IoUringPoller.h"
 #include "net/timer/TimerQueue.h"
 #include "utils/Timestamp.h"
 #include "utils/ErrorInfo.h"
+#include "utils/Buffer.h"
 
 /* Linux headers */
+#include <csignal>
 #include <sys/eventfd.h>
 
 using esynet::Looper;
 using esynet::poller::EpollPoller;
 using esynet::poller::PollPoller;
+using esynet::poller::IoUringPoller;
+using esynet::poller::IoUring;
 using esynet::utils::Timestamp;
 using esynet::timer::Timer;
 using esynet::Logger;
@@ -23,6 +32,8 @@ using esynet::Logger;
 thread_local Looper* t_reactorInCurThread = nullptr;
 /* 超时时间 */
 const int Looper::kPollTimeMs = 3000;
+/* 接收暂存区大小 */
+const size_t Looper::kScratchSize = 64_KB;
 
 std::string tidToStr(std::thread::id tid) {
     std::stringstream ss;
@@ -31,6 +42,18 @@ std::string tidToStr(std::thread::id tid) {
     tidStr = tidStr.substr(tidStr.length() - 4, 4);
     return tidStr;
 }
+/* sendfile 等调用没有 MSG_NOSIGNAL，对端关闭时的 SIGPIPE 默认会终止进程；
+ * 第一个 Looper 创建时忽略该信号，应用自行设置的处理函数保持不变 */
+void ignoreSigPipe() {
+    static bool ignored = [] {
+        struct sigaction action {};
+        if(::sigaction(SIGPIPE, nullptr, &action) == 0 && action.sa_handler == SIG_DFL) {
+            ::signal(SIGPIPE, SIG_IGN);
+        }
+        return true;
+    }();
+    (void)ignored;
+}
 int createEventFd() {
     int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
     if(fd == -1) {
@@ -39,10 +62,15 @@ int createEventFd() {
     return fd;
 }
 
-Looper::Looper(bool useEpoll):
+Looper::Looper(Backend backend):
+            backend_(backend),
             tid_(std::this_thread::get_id()),
+            scratch_(new char[kScratchSize]),
+            blockPool_(utils::BlockPool::local()),
+            slab_(std::make_shared<utils::Slab>()),
             wakeupFd_(createEventFd()),
             wakeupEvent_(*this, wakeupFd_) {
+    ignoreSigPipe();
     if(t_reactorInCurThread) {
         LOG_FATAL("Another Looper({:p}) exists in this thread({})",
                     static_cast<void*>(t_reactorInCurThread), tidToStr(tid_));
@@ -51,10 +79,24 @@ Looper::Looper(bool useEpoll):
         LOG_DEBUG("Looper({:p}) created in thread {}",
                     static_cast<void*>(this), tidToStr(tid_));
     }
-    if(useEpoll) {
-        poller_ = std::make_unique<EpollPoller>(*this);
-    } else {
-        poller_ = std::make_unique<PollPoller>(*this);
+    if(backend_ == kIoUring && !IoUring::supported()) {
+        LOG_WARN("io_uring is not supported by the kernel, fall back to epoll");
+        backend_ = kEpoll;
+    }
+    switch(backend_) {
+        case kPoll:
+            poller_ = std::make_unique<PollPoller>(*this);
+            break;
+        case kIoUring: {
+            auto poller = std::make_unique<IoUringPoller>(*this);
+            ioUringPoller_ = poller.get();
+            poller_ = std::move(poller);
+            break;
+        }
+        case kEpoll:
+        default:
+            poller_ = std::make_unique<EpollPoller>(*this);
+            break;
     }
     timerQueue_ = std::make_unique<timer::TimerQueue>(*this);
 
@@ -76,6 +118,11 @@ Looper::~Looper() {
     }
     t_reactorInCurThread = nullptr;
     removeEvent(wakeupEvent_);
+    for(Task* task = tasks_.popAll(); task;) {
+        Task* next = task->next;
+        delete task;
+        task = next;
+    }
 }
 
 void Looper::start() {
@@ -84,29 +131,50 @@ void Looper::start() {
     stop_ = false;
     isLooping_ = true;
     LOG_DEBUG("Looper({:p}) start looping", static_cast<void*>(this));
+    metrics_.start();
+    Event* timerEvent = &timerQueue_->event();
     while(!stop_) {
         activeEvents_.clear();
-        /* 获取活动事件 */
-        auto temp = poller_->poll(activeEvents_, kPollTimeMs);
+        runHooks(prePollHooks_);
+        /* 获取活动事件，存在被推迟的事件或刷新阶段之后新入队的任务时不阻塞 */
+        for(Event* event : deferredEvents_) {
+            event->setHappenedEvent(0);
+        }
+        uint64_t pollStart = LooperMetrics::now();
+        bool busy = !deferredEvents_.empty() || !tasks_.empty();
+        auto temp = poller_->poll(activeEvents_, busy ? 0 : kPollTimeMs);
+        uint64_t dispatchStart = LooperMetrics::now();
+        metrics_.recordPoll(dispatchStart - pollStart);
+        runHooks(postPollHooks_);
         {
             std::unique_lock<std::mutex> lock(mutex_);
             lastPollTime_ = temp;
         }
-        /* 执行活动事件对应的回调函数 */
+        mergeDeferredEvents();
+        numOfEvents_.store(activeEvents_.size(), std::memory_order_relaxed);
+        /* 执行活动事件对应的回调函数，定时器单独计时 */
+        uint64_t timerTime = 0;
         for(auto& event : activeEvents_) {
-            event->handle();
+            if(event == timerEvent) {
+                uint64_t timerStart = LooperMetrics::now();
+                event->handle();
+                timerTime = LooperMetrics::now() - timerStart;
+                metrics_.recordTimers(timerTime);
+            } else {
+                event->handle();
+            }
         }
 
         /* 执行任务队列 */
-        std::vector<Function> tasks;
-        {
-            std::unique_lock<std::mutex> lock(mutex_);
-            tasks.swap(tasks_);
-        }
-        for(auto& task : tasks) {
-            task();
-        }
+        uint64_t tasksStart = LooperMetrics::now();
+        metrics_.recordDispatch(tasksStart - dispatchStart - timerTime, activeEvents_.size());
+        size_t numOfTasks = doTasks();
+        /* 本轮事件与任务中积攒的输出，每个 Event 只刷新一次 */
+        doFlush();
+        metrics_.recordTasks(LooperMetrics::now() - tasksStart, numOfTasks);
+        metrics_.recordIteration();
     }
+    metrics_.stop();
     LOG_DEBUG("Looper({:p}) stop looping", static_cast<void*>(this));
     isLooping_ = false;
 }
@@ -134,19 +202,79 @@ void Looper::run(Function func) {
     if(isInLoopThread()) {
         func();
     } else {
-        queue(func);
-        wakeup();
+        queue(std::move(func));
     }
 }
+/* 只有使任务队列由空变为非空的那一次入队需要唤醒，其余生产者的任务会
+ * 在同一次唤醒中被一并执行；Looper 线程自身入队时本轮循环末尾就会执行，
+ * 除非此时正处于任务执行阶段 */
 void Looper::queue(Function func) {
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        tasks_.push_back(func);
+    bool wasEmpty = tasks_.push(new Task{std::move(func)});
+    if(wasEmpty && (!isInLoopThread() || callingTasks_)) {
+        wakeup();
+    }
+}
+/* 一次性取走当前所有任务，执行期间新入队的任务留待下一轮 */
+size_t Looper::doTasks() {
+    callingTasks_ = true;
+    size_t count = 0;
+    Task* task = tasks_.popAll();
+    while(task) {
+        Task* next = task->next;
+        task->func();
+        delete task;
+        task = next;
+        ++count;
+    }
+    callingTasks_ = false;
+    return count;
+}
+
+/* 刷新过程中可能有新的 Event 加入，按下标遍历 */
+void Looper::doFlush() {
+    for(size_t i = 0; i < flushEvents_.size(); ++i) {
+        if(Event* event = flushEvents_[i]) {
+            event->flush();
+        }
+    }
+    flushEvents_.clear();
+}
+void Looper::flushLater(Event& event) {
+    assert();
+    flushEvents_.push_back(&event);
+}
+
+/* 钩子的添加与移除总是放入任务队列，在任务阶段生效，此时没有钩子正在执行 */
+Looper::HookID Looper::addPrePollHook(Function func) {
+    HookID id = nextHookId_++;
+    queue([this, id, func = std::move(func)] {
+        prePollHooks_.push_back({ id, func });
+    });
+    return id;
+}
+Looper::HookID Looper::addPostPollHook(Function func) {
+    HookID id = nextHookId_++;
+    queue([this, id, func = std::move(func)] {
+        postPollHooks_.push_back({ id, func });
+    });
+    return id;
+}
+void Looper::removeHook(HookID id) {
+    queue([this, id] {
+        auto match = [id](const Hook& hook) { return hook.id == id; };
+        std::erase_if(prePollHooks_, match);
+        std::erase_if(postPollHooks_, match);
+    });
+}
+void Looper::runHooks(HookList& hooks) {
+    for(Hook& hook : hooks) {
+        hook.func();
     }
 }
 
 /* 通过eventfd来唤醒poll */
 void Looper::wakeup() {
+    ++numOfWakeups_;
     if(eventfd_write(wakeupFd_, 1) == -1) {
         LOG_ERROR("Failed to write eventfd({})", errnoStr(errno));
     }
@@ -167,8 +295,29 @@ void Looper::removeEvent(Event& event) {
             event.fd(), static_cast<void*>(this));
     }
     LOG_DEBUG("Remove event (fd: {})", event.fd());
+    auto iter = std::find(deferredEvents_.begin(), deferredEvents_.end(), &event);
+    if(iter != deferredEvents_.end()) {
+        deferredEvents_.erase(iter);
+    }
+    std::replace(flushEvents_.begin(), flushEvents_.end(), &event, static_cast<Event*>(nullptr));
     poller_->removeEvent(event);
 }
+void Looper::deferEvent(Event& event) {
+    assert();
+    deferredEvents_.push_back(&event);
+}
+/* Poller 只会设置本轮就绪的 Event 的 happened 事件，poll 之前将被推迟的 Event
+ * 清零，之后仍为 0 的说明不在本轮的活动列表中 */
+void Looper::mergeDeferredEvents() {
+    for(Event* event : deferredEvents_) {
+        short happened = event->happenedEvent();
+        if(happened == 0) {
+            activeEvents_.push_back(event);
+        }
+        event->setHappenedEvent(happened | event->takeDeferred());
+    }
+    deferredEvents_.clear();
+}
 
 bool Looper::isInLoopThread() const {
     return tid_ == std::this_thread::get_id();
@@ -179,4 +328,18 @@ void Looper::assert() const {
     }
 }
 bool Looper::isLooping() const { return isLooping_; }
-int Looper::numOfEvents() { numOfEvents_ = activeEvents_.size(); return numOfEvents_; }
\ No newline at end of file
+Looper::Backend Looper::backend() const { return backend_; }
+IoUringPoller* Looper::ioUringPoller() const { return ioUringPoller_; }
+const esynet::poller::Poller& Looper::poller() const { return *poller_; }
+int Looper::numOfEvents() { return numOfEvents_.load(std::memory_order_relaxed); }
+esynet::LooperMetrics::Snapshot Looper::metrics() const { return metrics_.snapshot(); }
+uint64_t Looper::numOfWakeups() const { return numOfWakeups_; }
+char* Looper::scratch() { return scratch_.get(); }
+void Looper::addBufferBytes(int64_t delta) { metrics_.recordBufferBytes(delta); }
+const esynet::utils::BlockPool& Looper::blockPool() const { return *blockPool_; }
+const std::shared_ptr<esynet::utils::Slab>& Looper::slab() const { return slab_; }
+esynet::ZeroCopyReaper& Looper::zeroCopyReaper() {
+    assert();
+    if(!zeroCopyReaper_) zeroCopyReaper_ = std::make_unique<ZeroCopyReaper>(*this);
+    return *zeroCopyReaper_;
+}
\ No newline at end of file
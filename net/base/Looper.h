@@ -10,18 +10,33 @@
 /* Local headers */
 #include "net/timer/TimerQueue.h"
 #include "utils/NonCopyable.h"
+#include "utils/MpscQueue.h"
+#include "utils/BlockPool.h"
+#include "utils/Slab.h"
 #include "utils/Timestamp.h"
 #include "net/poller/Poller.h"
 #include "net/timer/Timer.h"
+#include "net/base/LooperMetrics.h"
+
+namespace esynet::poller {
+
+class IoUringPoller;
+
+}
 
 namespace esynet {
 
 class Event;
+class ZeroCopyReaper;
 
 /* 警告： 不要设为全局变量 */
 class Looper : public utils::NonCopyable {
 public:
     static const int kPollTimeMs;
+    static const size_t kScratchSize;
+
+    /* Poller 后端，内核不支持 io_uring 时 kIoUring 会回退为 kEpoll */
+    enum Backend { kPoll, kEpoll, kIoUring };
 
 private:
     using EventList  = std::vector<Event*>;
@@ -31,11 +46,30 @@ private:
     using Timestamp  = utils::Timestamp;
     using Function   = std::function<void()>;
 
-    bool isInLoopThread() const;
+    /* 轮询前后的钩子 */
+    struct Hook {
+        uint64_t id;
+        Function func;
+    };
+    using HookList = std::vector<Hook>;
+
+    /* 任务队列节点 */
+    struct Task {
+        Function func;
+        Task* next {nullptr};
+    };
+    using TaskQueue  = utils::MpscQueue<Task>;
+
     void wakeup();
+    auto doTasks() -> size_t;   /* 返回执行的任务数 */
+    void doFlush();
+    void runHooks(HookList&);
+
+public:
+    using HookID = uint64_t;
 
 public:
-    Looper(bool useEpoll = true);
+    Looper(Backend backend = kEpoll);
     ~Looper();
 
     void start();
@@ -44,6 +78,10 @@ public:
     auto lastPollTime() -> Timestamp;
     void updateEvent(Event&);
     void removeEvent(Event&);
+    /* 由 Event::defer 调用，该事件会在下一轮循环中被再次处理 */
+    void deferEvent(Event&);
+    /* 由 Event::scheduleFlush 调用，该事件的 flush 回调会在本轮的刷新阶段被调用 */
+    void flushLater(Event&);
 
     auto runAt(Timestamp timePoint, Timer::Callback) -> Timer::ID;
     auto runAfter(double delay, Timer::Callback) -> Timer::ID;
@@ -54,15 +92,52 @@ public:
     void run(Function);       /* 立刻唤醒执行 */
     void queue(Function);     /* 等待唤醒，稍后执行 */
 
+    /* 每轮循环的顺序：轮询前钩子、poll、轮询后钩子、处理活动事件、执行任务、刷新阶段
+     * 轮询前钩子适合批量提交在本轮中积攒下来的工作，轮询后钩子适合在处理事件之前做准备
+     * 线程安全，钩子总是在 Looper 线程中执行；添加与移除在下一个任务阶段生效，可以在钩子中移除自身 */
+    auto addPrePollHook(Function) -> HookID;
+    auto addPostPollHook(Function) -> HookID;
+    void removeHook(HookID);
+
     void assert() const;
+    bool isInLoopThread() const;
     bool isLooping() const;
-    int numOfEvents();
+    auto backend() const -> Backend;
+    /* 使用 kIoUring 后端时返回对应的 Poller，用于完成式 I/O，否则返回 nullptr */
+    auto ioUringPoller() const -> poller::IoUringPoller*;
+    auto poller() const -> const Poller&;
+    int numOfEvents();                        /* 最近一轮的活动事件数 */
+    /* 线程安全，各阶段耗时、任务队列深度、CPU 时间等统计的快照 */
+    auto metrics() const -> LooperMetrics::Snapshot;
+    /* 由连接在缓冲区占用变化时调用，计入 metrics().bufferBytes */
+    void addBufferBytes(int64_t delta);
+    /* 由该线程上的所有连接共享的接收暂存区，大小为 kScratchSize，仅限 Looper 线程使用，
+     * 读取的数据超出连接缓冲区的可写空间时暂存于此，随后立即拷贝走 */
+    auto scratch() -> char*;
+    /* 该线程的 Buffer 内存块池，统计信息可由任意线程读取 */
+    auto blockPool() const -> const utils::BlockPool&;
+    /* 在该线程中创建的连接对象（连同 shared_ptr 的控制块）所在的定长内存池，
+     * 只能在 Looper 线程中分配，对象可以在任意线程中析构；TcpServer 的连接都分配在主 Looper 的 Slab 中 */
+    auto slab() const -> const std::shared_ptr<utils::Slab>&;
+    /* 接管关闭时仍有零拷贝发送未完成的套接字，首次使用时创建，仅限 Looper 线程使用 */
+    auto zeroCopyReaper() -> ZeroCopyReaper&;
+    auto numOfWakeups() const -> uint64_t;    /* eventfd 写入次数 */
 
 private:
+    void mergeDeferredEvents();
+
     EventList activeEvents_;
-    std::vector<Function> tasks_;
+    EventList deferredEvents_;
+    EventList flushEvents_;     /* 有待写出数据的 Event，已移除的置为 nullptr */
+    HookList prePollHooks_;
+    HookList postPollHooks_;
+    std::atomic<HookID> nextHookId_ {1};
+    TaskQueue tasks_;
+    Backend backend_;
     std::unique_ptr<Poller> poller_;
+    poller::IoUringPoller* ioUringPoller_ {nullptr};
     std::unique_ptr<TimerQueue> timerQueue_;
+    std::unique_ptr<ZeroCopyReaper> zeroCopyReaper_;   /* 先于定时器队列析构 */
 
     /* 状态 */
     Timestamp lastPollTime_;
@@ -70,9 +145,15 @@ private:
     std::atomic<int>  numOfEvents_ {0};
     std::atomic<bool> stop_        {false};
     std::atomic<bool> isLooping_   {false};
+    bool callingTasks_             {false};
+    LooperMetrics metrics_;
+    std::unique_ptr<char[]> scratch_;
+    utils::BlockPool* blockPool_;
+    std::shared_ptr<utils::Slab> slab_;
 
     /* 多线程 */
     int wakeupFd_;
+    std::atomic<uint64_t> numOfWakeups_ {0};
     std::mutex mutex_;
     Event wakeupEvent_;
 };
@@ -0,0 +1,86 @@
+#include "net/base/LooperMetrics.h"
+
+/* Standard headers */
+#include <chrono>
+#include <algorithm>
+
+/* Linux headers */
+#include <pthread.h>
+
+using esynet::LooperMetrics;
+
+static uint64_t toNs(const struct timespec& ts) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+uint64_t LooperMetrics::now() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void LooperMetrics::start() {
+    if(pthread_getcpuclockid(pthread_self(), &cpuClock_) != 0) {
+        cpuClock_ = CLOCK_THREAD_CPUTIME_ID;
+    }
+    if(startTime_ == 0) startTime_ = now();
+    running_ = true;
+}
+void LooperMetrics::stop() {
+    struct timespec ts;
+    if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        stoppedCpuNs_ = toNs(ts);
+    }
+    stopTime_ = now();
+    running_ = false;
+}
+
+/* 其他线程通过 pthread_getcpuclockid 获得的时钟读取该线程的 CPU 时间 */
+double LooperMetrics::cpuTime() const {
+    struct timespec ts;
+    if(running_ && clock_gettime(cpuClock_, &ts) == 0) {
+        return toNs(ts) / 1e9;
+    }
+    return stoppedCpuNs_ / 1e9;
+}
+
+LooperMetrics::Snapshot LooperMetrics::snapshot() const {
+    Snapshot snapshot;
+    snapshot.iterations = iterations_.load(std::memory_order_relaxed);
+    snapshot.events     = events_.load(std::memory_order_relaxed);
+    snapshot.tasks      = tasks_.load(std::memory_order_relaxed);
+    snapshot.timers     = timers_.load(std::memory_order_relaxed);
+    snapshot.bufferBytes = static_cast<uint64_t>(std::max<int64_t>(bufferBytes_.load(std::memory_order_relaxed), 0));
+    snapshot.pollWait   = pollWait_.snapshot();
+    snapshot.dispatch   = dispatch_.snapshot();
+    snapshot.timerRun   = timerRun_.snapshot();
+    snapshot.taskDrain  = taskDrain_.snapshot();
+    snapshot.queueDepth = queueDepth_.snapshot();
+    snapshot.cpuTime    = cpuTime();
+    if(startTime_ != 0) {
+        uint64_t end = running_ ? now() : stopTime_.load();
+        snapshot.uptime = (end - startTime_) / 1e9;
+    }
+    return snapshot;
+}
+
+double LooperMetrics::Snapshot::iterationsPerSecond() const {
+    return uptime > 0 ? iterations / uptime : 0.0;
+}
+double LooperMetrics::Snapshot::cpuUsage() const {
+    return uptime > 0 ? cpuTime / uptime : 0.0;
+}
+LooperMetrics::Snapshot& LooperMetrics::Snapshot::merge(const Snapshot& other) {
+    iterations += other.iterations;
+    events     += other.events;
+    tasks      += other.tasks;
+    timers     += other.timers;
+    bufferBytes += other.bufferBytes;
+    uptime     += other.uptime;
+    cpuTime    += other.cpuTime;
+    pollWait.merge(other.pollWait);
+    dispatch.merge(other.dispatch);
+    timerRun.merge(other.timerRun);
+    taskDrain.merge(other.taskDrain);
+    queueDepth.merge(other.queueDepth);
+    return *this;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+/* Standard headers */
+#include <atomic>
+#include <cstdint>
+
+/* Linux headers */
+#include <time.h>
+
+/* Local headers */
+#include "utils/Histogram.h"
+#include "utils/NonCopyable.h"
+
+namespace esynet {
+
+/* Looper 各阶段的常驻统计，由 Looper 所属线程记录，任意线程可以获取快照
+ * 耗时单位均为纳秒，事件分发的耗时不包含定时器回调 */
+class LooperMetrics : public utils::NonCopyable {
+public:
+    using Histogram = utils::Histogram;
+
+    struct Snapshot {
+        uint64_t iterations {0};    /* 循环次数 */
+        uint64_t events     {0};    /* 分发的事件数 */
+        uint64_t tasks      {0};    /* 执行的任务数 */
+        uint64_t timers     {0};    /* 定时器事件的处理次数 */
+        uint64_t bufferBytes {0};   /* 该 Looper 上的连接缓冲区当前占用的字节数 */
+        double   uptime     {0.0};  /* 运行时长（秒） */
+        double   cpuTime    {0.0};  /* 线程占用的 CPU 时间（秒） */
+
+        Histogram::Snapshot pollWait;   /* 阻塞在 poll 中的时间 */
+        Histogram::Snapshot dispatch;   /* 执行事件回调的时间 */
+        Histogram::Snapshot timerRun;   /* 执行定时器回调的时间 */
+        Histogram::Snapshot taskDrain;  /* 执行任务队列的时间 */
+        Histogram::Snapshot queueDepth; /* 每轮执行的任务数 */
+
+        double iterationsPerSecond() const;
+        /* CPU 占用率，接近 1 说明该 Looper 已经饱和 */
+        double cpuUsage() const;
+        /* 合并多个 Looper 的快照，运行时长与 CPU 时间累加 */
+        Snapshot& merge(const Snapshot&);
+    };
+
+    static uint64_t now();
+
+public:
+    /* 由 Looper 所属线程在循环开始与结束时调用 */
+    void start();
+    void stop();
+
+    void recordPoll(uint64_t ns)                   { pollWait_.record(ns); }
+    void recordDispatch(uint64_t ns, size_t count) { dispatch_.record(ns); increase(events_, count); }
+    void recordTimers(uint64_t ns)                 { timerRun_.record(ns); increase(timers_, 1); }
+    void recordTasks(uint64_t ns, size_t count)    { taskDrain_.record(ns); queueDepth_.record(count); increase(tasks_, count); }
+    void recordIteration()                         { increase(iterations_, 1); }
+    /* 连接缓冲区占用的变化量，连接可能在其他线程析构，因此使用原子加 */
+    void recordBufferBytes(int64_t delta)          { bufferBytes_.fetch_add(delta, std::memory_order_relaxed); }
+
+    /* 线程安全 */
+    auto snapshot() const -> Snapshot;
+
+private:
+    static void increase(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+    double cpuTime() const;
+
+    std::atomic<uint64_t> iterations_ {0};
+    std::atomic<uint64_t> events_     {0};
+    std::atomic<uint64_t> tasks_      {0};
+    std::atomic<uint64_t> timers_     {0};
+    std::atomic<int64_t>  bufferBytes_ {0};
+
+    Histogram pollWait_;
+    Histogram dispatch_;
+    Histogram timerRun_;
+    Histogram taskDrain_;
+    Histogram queueDepth_;
+
+    /* 运行期间通过线程的 CPU 时钟读取，停止后使用停止时的值 */
+    std::atomic<bool>     running_      {false};
+    std::atomic<uint64_t> startTime_    {0};
+    std::atomic<uint64_t> stopTime_     {0};
+    std::atomic<uint64_t> stoppedCpuNs_ {0};
+    clockid_t cpuClock_ {CLOCK_THREAD_CPUTIME_ID};
+};
+
+} /* namespace esynet */
@@ -14,6 +14,9 @@
 /* Linux headers */
 #include <sys/socket.h>
 #include <sys/uio.h>
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
 
 using esynet::Socket;
 
@@ -77,7 +80,7 @@ Socket Socket::accept() {
 }
 Socket Socket::accept(NetAddress& peerAddr) {
     NetAddress::SockAddr addr;
-    socklen_t len;
+    socklen_t len = sizeof addr;
     int connFd = ::accept4(fd_, &addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
     if(connFd == -1) {
         throw exception::NetworkException("Accept failed(fd: " + std::to_string(fd_) + ")", errno);
@@ -89,7 +92,7 @@ std::vector<Socket> Socket::accept(std::vector<NetAddress>& peerAddrs) {
     std::vector<Socket> fds;
     while(true) {
         NetAddress::SockAddr addr;
-        socklen_t len;
+        socklen_t len = sizeof addr;
         int connFd = ::accept4(fd_, &addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
         if(connFd == -1) {
             if(!(errno == EINTR || errno == EMFILE || errno == ECONNABORTED)
@@ -158,40 +161,106 @@ void Socket::setTcpNoDelay(bool on) {
 }
 void Socket::setReuseAddr(bool on) {
     int optval = on ? 1 : 0;
-    if(setsockopt(fd_, IPPROTO_TCP, SO_REUSEADDR, &optval, sizeof optval) == -1) {
+    if(setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof optval) == -1) {
         LOG_ERROR("setReuseAddr failed(fd: {}, errno: )", fd_, errnoStr(errno));
     }
 }
 void Socket::setReusePort(bool on) {
     int optval = on ? 1 : 0;
-    if(setsockopt(fd_, IPPROTO_TCP, SO_REUSEPORT, &optval, sizeof optval) == -1) {
+    if(setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof optval) == -1) {
         LOG_ERROR("setReusePort failed(fd: {}, errno: )", fd_, errnoStr(errno));
     }
 }
 void Socket::setKeepAlive(bool on) {
     int optval = on ? 1 : 0;
-    if(setsockopt(fd_, IPPROTO_TCP, SO_KEEPALIVE, &optval, sizeof optval) == -1) {
+    if(setsockopt(fd_, SOL_SOCKET, SO_KEEPALIVE, &optval, sizeof optval) == -1) {
         LOG_ERROR("setKeepAlive failed(fd: {}, errno: )", fd_, errnoStr(errno));
     }
 }
+bool Socket::setZeroCopy(bool on) {
+    int optval = on ? 1 : 0;
+    if(setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &optval, sizeof optval) == -1) {
+        LOG_WARN("setZeroCopy failed(fd: {}, errno: {})", fd_, errnoStr(errno));
+        return false;
+    }
+    return true;
+}
+
+static bool isTemporaryError(int err) {
+    return err == EAGAIN || err == EWOULDBLOCK || err == EINTR;
+}
 
-size_t Socket::write(const void* data, size_t len) {
-    size_t bytes = ::write(fd_, data, len);
-    if(bytes < 0) {
+ssize_t Socket::write(const void* data, size_t len) {
+    ssize_t bytes = ::write(fd_, data, len);
+    if(bytes < 0 && !isTemporaryError(errno)) {
         throw exception::SocketException("Write error(fd: " + std::to_string(fd_) + ")", errno);
     }
     return bytes;
 }
-size_t Socket::read(void* buf, size_t len) {
-    size_t bytes = ::read(fd_, buf, len);
-    if(bytes < 0) {
+ssize_t Socket::read(void* buf, size_t len) {
+    ssize_t bytes = ::read(fd_, buf, len);
+    if(bytes < 0 && !isTemporaryError(errno)) {
         throw exception::SocketException("Read error(fd: " + std::to_string(fd_) + ")", errno);
     }
     return bytes;
 }
-size_t Socket::readv(const struct iovec* iov, int iovCount) {
-    size_t bytes = ::readv(fd_, iov, iovCount);
-    if(bytes < 0) {
+/* 以 sendmsg 实现，对端关闭时返回 EPIPE 而不是触发 SIGPIPE */
+ssize_t Socket::writev(const struct iovec* iov, int iovCount) {
+    struct msghdr msg;
+    bzero(&msg, sizeof msg);
+    msg.msg_iov = const_cast<struct iovec*>(iov);
+    msg.msg_iovlen = iovCount;
+    ssize_t bytes = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+    if(bytes < 0 && !isTemporaryError(errno)) {
+        throw exception::SocketException("Writev error(fd: " + std::to_string(fd_) + ")", errno);
+    }
+    return bytes;
+}
+ssize_t Socket::sendZeroCopy(const struct iovec* iov, int iovCount) {
+    struct msghdr msg;
+    bzero(&msg, sizeof msg);
+    msg.msg_iov = const_cast<struct iovec*>(iov);
+    msg.msg_iovlen = iovCount;
+    ssize_t bytes = ::sendmsg(fd_, &msg, MSG_ZEROCOPY | MSG_NOSIGNAL);
+    if(bytes < 0 && !isTemporaryError(errno) && errno != ENOBUFS) {
+        throw exception::SocketException("Zerocopy send error(fd: " + std::to_string(fd_) + ")", errno);
+    }
+    return bytes;
+}
+std::optional<Socket::ZeroCopyRange> Socket::readZeroCopyCompletion() {
+    char control[128];
+    struct msghdr msg;
+    bzero(&msg, sizeof msg);
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof control;
+    while(::recvmsg(fd_, &msg, MSG_ERRQUEUE) >= 0) {
+        for(struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if(!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+               !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) continue;
+            auto* err = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+            if(err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+            return ZeroCopyRange { err->ee_info, err->ee_data,
+                                   (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0 };
+        }
+        /* 不是零拷贝通知，继续读取下一条 */
+        msg.msg_controllen = sizeof control;
+    }
+    return std::nullopt;
+}
+/* sendfile 没有 MSG_NOSIGNAL，Looper 创建时已在进程内忽略 SIGPIPE，对端关闭时返回 EPIPE */
+ssize_t Socket::sendFile(int fileFd, off_t offset, size_t len) {
+    ssize_t bytes = ::sendfile(fd_, fileFd, &offset, len);
+    if(bytes < 0 && !isTemporaryError(errno)) {
+        throw exception::SocketException("Sendfile error(fd: " + std::to_string(fd_) + ")", errno);
+    }
+    if(bytes == 0 && len > 0) {
+        throw exception::SocketException("Sendfile reaches end of file(fd: " + std::to_string(fileFd) + ")", ENODATA);
+    }
+    return bytes;
+}
+ssize_t Socket::readv(const struct iovec* iov, int iovCount) {
+    ssize_t bytes = ::readv(fd_, iov, iovCount);
+    if(bytes < 0 && !isTemporaryError(errno)) {
         throw exception::SocketException("Readv error(fd: " + std::to_string(fd_) + ")", errno);
     }
     return bytes;
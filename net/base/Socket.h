@@ -7,6 +7,7 @@
 #include <optional>
 
 /* Linux headers */
+#include <sys/types.h>
 #include <netinet/tcp.h>
 
 namespace esynet {
@@ -17,6 +18,12 @@ class NetAddress;
 class Socket {
 public:
     using TcpInfo = struct tcp_info;
+    /* 零拷贝发送的完成通知，覆盖序号 [lo, hi] 的发送，copied 表示内核实际做了拷贝 */
+    struct ZeroCopyRange {
+        uint32_t lo;
+        uint32_t hi;
+        bool copied;
+    };
 
     static auto getSocketError(Socket) -> std::optional<int>;
     static bool isSelfConnect(Socket);
@@ -51,11 +58,22 @@ public:
     void setReuseAddr(bool);
     void setReusePort(bool);
     void setKeepAlive(bool);
+    /* 开启 SO_ZEROCOPY，内核不支持时返回 false */
+    bool setZeroCopy(bool);
 
     // 不建议直接使用以下接口
-    size_t write(const void*, size_t);
-    size_t read(void*, size_t);
-    size_t readv(const struct iovec*, int);
+    // 暂时无法读写（EAGAIN）时返回 -1，其余错误抛出异常
+    ssize_t write(const void*, size_t);
+    ssize_t read(void*, size_t);
+    ssize_t readv(const struct iovec*, int);
+    ssize_t writev(const struct iovec*, int);
+    /* 以 sendfile 发送文件 fd 中 [offset, offset + len) 的数据，文件提前结束时抛出异常 */
+    ssize_t sendFile(int fileFd, off_t offset, size_t len);
+    /* 以 MSG_ZEROCOPY 发送，数据在收到完成通知之前不能修改或释放
+     * 内核暂时无法锁定更多页面（ENOBUFS）时同样返回 -1，调用者可以改为拷贝发送 */
+    ssize_t sendZeroCopy(const struct iovec*, int);
+    /* 从错误队列读取一条零拷贝完成通知，队列为空时返回 std::nullopt */
+    auto readZeroCopyCompletion() -> std::optional<ZeroCopyRange>;
 
 private:
     const int fd_;
@@ -0,0 +1,122 @@
+#include "net/base/ZeroCopyReaper.h"
+
+/* Standard headers */
+#include <algorithm>
+
+/* Local headers */
+#include "logger/Logger.h"
+#include "net/base/Looper.h"
+#include "net/base/Socket.h"
+#include "net/timer/TimerQueue.h"
+#include "utils/ErrorInfo.h"
+
+/* Linux headers */
+#include <unistd.h>
+#include <sys/socket.h>
+
+using esynet::ZeroCopyReaper;
+using esynet::timer::TimerQueue;
+
+const double ZeroCopyReaper::kPollIntervalMs = 10.0;
+const double ZeroCopyReaper::kDrainTimeoutMs = 30000.0;
+const double ZeroCopyReaper::kAbortTimeoutMs = 1000.0;
+
+ZeroCopyReaper::ZeroCopyReaper(Looper& looper): looper_(looper) {}
+
+/* Looper 退出时不再轮询，断开所有连接后最后读取一次错误队列 */
+ZeroCopyReaper::~ZeroCopyReaper() {
+    if(timer_ >= 0) looper_.cancelTimer(timer_);
+    for(Entry& entry : entries_) {
+        if(!entry.aborted) abort(entry);
+        finish(entry, !drain(entry));
+    }
+}
+
+void ZeroCopyReaper::adopt(int fd, std::vector<Send> sends) {
+    looper_.assert();
+
+    size_t bytes = 0;
+    for(const Send& send : sends) bytes += send.bytes;
+    looper_.addBufferBytes(static_cast<int64_t>(bytes));
+    /* 与 close 相同，发送队列中的数据发送完毕后对端会收到 FIN */
+    if(::shutdown(fd, SHUT_RDWR) < 0) {
+        LOG_DEBUG("shutdown error(fd: {}, err: {})", fd, errnoStr(errno));
+    }
+    Entry entry { fd, std::move(sends), TimerQueue::now() + static_cast<uint64_t>(kDrainTimeoutMs) };
+    if(drain(entry)) {
+        finish(entry, false);
+        return;
+    }
+    LOG_DEBUG("Reap {} zerocopy sends of fd {}", entry.sends.size(), fd);
+    entries_.push_back(std::move(entry));
+    if(timer_ < 0) {
+        timer_ = looper_.runAfter(kPollIntervalMs, [this] { poll(); });
+    }
+}
+
+size_t ZeroCopyReaper::pending() const {
+    size_t count = 0;
+    for(const Entry& entry : entries_) count += entry.sends.size();
+    return count;
+}
+
+void ZeroCopyReaper::poll() {
+    timer_ = -1;
+    uint64_t now = TimerQueue::now();
+    std::erase_if(entries_, [this, now](Entry& entry) {
+        if(drain(entry)) {
+            finish(entry, false);
+            return true;
+        }
+        if(now < entry.deadline) return false;
+        if(entry.aborted) {
+            finish(entry, true);
+            return true;
+        }
+        abort(entry);
+        return false;
+    });
+    if(!entries_.empty()) {
+        timer_ = looper_.runAfter(kPollIntervalMs, [this] { poll(); });
+    }
+}
+
+bool ZeroCopyReaper::drain(Entry& entry) {
+    size_t released = 0;
+    while(auto range = Socket(entry.fd).readZeroCopyCompletion()) {
+        uint32_t span = range->hi - range->lo;
+        std::erase_if(entry.sends, [&range, span, &released](const Send& send) {
+            if(send.seq - range->lo > span) return false;
+            released += send.bytes;
+            return true;
+        });
+    }
+    if(released > 0) looper_.addBufferBytes(-static_cast<int64_t>(released));
+    return entry.sends.empty();
+}
+
+/* 对 TCP 套接字 connect AF_UNSPEC 会断开连接并清空发送队列，
+ * 队列中的数据随之释放，完成通知仍然送达错误队列 */
+void ZeroCopyReaper::abort(Entry& entry) {
+    LOG_WARN("Zerocopy sends of fd {} are not acknowledged in time, abort the connection", entry.fd);
+    struct sockaddr addr {};
+    addr.sa_family = AF_UNSPEC;
+    if(::connect(entry.fd, &addr, sizeof addr) < 0) {
+        LOG_DEBUG("disconnect error(fd: {}, err: {})", entry.fd, errnoStr(errno));
+    }
+    entry.aborted  = true;
+    entry.deadline = TimerQueue::now() + static_cast<uint64_t>(kAbortTimeoutMs);
+}
+
+/* 仍未完成的数据可能被网卡引用，宁可泄漏也不能交还给分配器复用 */
+void ZeroCopyReaper::finish(Entry& entry, bool leak) {
+    if(leak && !entry.sends.empty()) {
+        size_t bytes = 0;
+        for(const Send& send : entry.sends) bytes += send.bytes;
+        LOG_ERROR("Leak {} bytes of zerocopy sends of fd {}", bytes, entry.fd);
+        looper_.addBufferBytes(-static_cast<int64_t>(bytes));
+        new std::vector<Send>(std::move(entry.sends));
+    }
+    entry.sends.clear();
+    Socket(entry.fd).close();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+/* Standard headers */
+#include <memory>
+#include <vector>
+
+/* Local headers */
+#include "utils/NonCopyable.h"
+#include "net/timer/Timer.h"
+
+namespace esynet {
+
+class Looper;
+
+/* 连接关闭时仍有零拷贝发送没有收到完成通知，内核随时可能继续从这些内存中发送或重传数据，
+ * 此时由 Looper 接管套接字与数据的所有者：定期读取错误队列，收到通知后才释放对应的数据，
+ * 全部释放后关闭套接字；对端迟迟不确认时断开连接清空发送队列，仍无法完成的数据不再释放 */
+class ZeroCopyReaper : public utils::NonCopyable {
+public:
+    static const double kPollIntervalMs;
+    static const double kDrainTimeoutMs;    /* 超时后断开连接 */
+    static const double kAbortTimeoutMs;    /* 断开后仍未完成时放弃等待 */
+
+    /* 每次成功的 MSG_ZEROCOPY 发送占用一个序号，数据保持到对应的完成通知到达 */
+    struct Send {
+        uint32_t seq;
+        size_t bytes;
+        std::shared_ptr<const void> owner;
+    };
+
+    explicit ZeroCopyReaper(Looper&);
+    ~ZeroCopyReaper();
+
+    /* 接管 fd 并关闭其读写，发送队列中的数据仍会发往对端，仅限 Looper 线程调用 */
+    void adopt(int fd, std::vector<Send> sends);
+    auto pending() const -> size_t;     /* 尚未释放的发送数 */
+
+private:
+    struct Entry {
+        int fd;
+        std::vector<Send> sends;
+        uint64_t deadline;
+        bool aborted {false};
+    };
+
+    void poll();
+    auto drain(Entry&) -> bool;         /* 释放已完成的发送，全部完成时返回 true */
+    void abort(Entry&);
+    void finish(Entry&, bool leak);
+
+    Looper& looper_;
+    std::vector<Entry> entries_;
+    timer::Timer::ID timer_ {-1};
+};
+
+} /* namespace esynet */
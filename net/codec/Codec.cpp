@@ -0,0 +1,54 @@
+#include "net/codec/Codec.h"
+
+/* Local headers */
+#include "logger/Logger.h"
+
+using esynet::codec::Codec;
+using esynet::TcpConnection;
+using esynet::utils::Buffer;
+using esynet::utils::StringPiece;
+using esynet::utils::Timestamp;
+
+void Codec::defaultErrorCallback(TcpConnection& conn) {
+    LOG_ERROR("Invalid frame from {}, close connection {}", conn.peerAddress().ip(), conn.name());
+    conn.forceClose();
+}
+
+void Codec::setFrameCallback(FrameCallback cb) {
+    frameCb_ = std::move(cb);
+}
+void Codec::setErrorCallback(ErrorCallback cb) {
+    errorCb_ = std::move(cb);
+}
+
+/* 帧回调期间帧视图指向读缓冲区，回调返回后才取走整帧
+ * shutdown 之后连接仍在读取，已收到的帧照常解码；在 Looper 线程中 forceClose 会立刻断开连接，随即停止 */
+void Codec::onMessage(TcpConnection& conn, Buffer& buffer, Timestamp time) {
+    Frame frame;
+    while(!conn.disconnected()) {
+        Result result = decode(buffer, frame);
+        if(result == kIncomplete) break;
+        if(result == kError) {
+            errorCb_(conn);
+            break;
+        }
+        if(frameCb_) frameCb_(conn, frame.payload, time);
+        buffer.retrieve(frame.length);
+    }
+}
+TcpConnection::MessageCallback Codec::messageCallback() {
+    return [this](TcpConnection& conn, Buffer& buffer, Timestamp time) {
+        onMessage(conn, buffer, time);
+    };
+}
+
+bool Codec::send(TcpConnection& conn, std::shared_ptr<Buffer> payload) const {
+    if(!encode(*payload)) return false;
+    conn.send(std::shared_ptr<const Buffer>(std::move(payload)));
+    return true;
+}
+bool Codec::send(TcpConnection& conn, StringPiece payload) const {
+    auto buffer = std::make_shared<Buffer>(payload.size());
+    buffer->append(payload);
+    return send(conn, std::move(buffer));
+}
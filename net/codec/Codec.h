@@ -0,0 +1,63 @@
+#pragma once
+
+/* Standard headers */
+#include <functional>
+#include <memory>
+
+/* Local headers */
+#include "net/TcpConnection.h"
+#include "utils/Buffer.h"
+#include "utils/NonCopyable.h"
+#include "utils/StringPiece.h"
+#include "utils/Timestamp.h"
+
+namespace esynet::codec {
+
+/* 帧编解码器，位于 TcpConnection 与用户回调之间，把字节流切分为消息
+ *
+ * 解码得到的帧是指向连接读缓冲区的视图，不做拷贝，只在帧回调期间有效，
+ * 回调返回后整帧才从缓冲区中取走；编码时帧头写入 Buffer 的 prepend 区，载荷不移动
+ * 编解码器不保存连接相关的状态，同一个实例可以由多个连接、多个 Looper 线程共享
+ *
+ * 派生类实现 decode 与 encode 即可接入新的协议 */
+class Codec : public utils::NonCopyable {
+public:
+    using FrameCallback = std::function<void(TcpConnection&, utils::StringPiece frame, utils::Timestamp)>;
+    using ErrorCallback = std::function<void(TcpConnection&)>;
+
+    enum Result { kFrame, kIncomplete, kError };
+
+    /* 一帧在缓冲区中的位置：payload 为有效载荷，length 为包括帧头、分隔符在内的整帧长度 */
+    struct Frame {
+        utils::StringPiece payload;
+        size_t length {0};
+    };
+
+    static void defaultErrorCallback(TcpConnection&);
+
+public:
+    virtual ~Codec() = default;
+
+    /* 从 buffer 的可读数据头部解析一帧，不移动读指针
+     * 数据不足时返回 kIncomplete，已知帧长时可以顺便预留缓冲区空间；帧非法时返回 kError */
+    virtual auto decode(utils::Buffer&, Frame&) const -> Result = 0;
+    /* 把 buffer 中的全部可读数据编码为一帧，载荷无法编码时记录日志并返回 false，buffer 保持不变 */
+    virtual bool encode(utils::Buffer&) const = 0;
+
+    void setFrameCallback(FrameCallback);
+    /* 帧非法时调用，默认记录日志并关闭连接 */
+    void setErrorCallback(ErrorCallback);
+    /* 作为 TcpConnection 的 MessageCallback，依次解码并回调缓冲区中的全部完整帧 */
+    void onMessage(TcpConnection&, utils::Buffer&, utils::Timestamp);
+    auto messageCallback() -> TcpConnection::MessageCallback;
+
+    /* 载荷已经在 Buffer 中时原地编码，转交所有权发送，不拷贝载荷；载荷无法编码时不发送，返回 false */
+    bool send(TcpConnection&, std::shared_ptr<utils::Buffer> payload) const;
+    bool send(TcpConnection&, utils::StringPiece payload) const;
+
+private:
+    FrameCallback frameCb_;
+    ErrorCallback errorCb_ {defaultErrorCallback};
+};
+
+} /* namespace esynet::codec */
@@ -0,0 +1,112 @@
+#include "net/codec/LengthFieldCodec.h"
+
+/* Standard headers */
+#include <cstring>
+#include <algorithm>
+
+/* Linux headers */
+#include <endian.h>
+
+/* Local headers */
+#include "logger/Logger.h"
+
+using esynet::codec::LengthFieldCodec;
+using esynet::utils::Buffer;
+
+const size_t LengthFieldCodec::kDefaultMaxFrameSize = 4_MB;
+const size_t LengthFieldCodec::kDefaultMaxReserve   = 64_KB;
+
+static uint64_t readLength(const char* data, int size) {
+    switch(size) {
+        case 1:
+            return static_cast<uint8_t>(data[0]);
+        case 2: {
+            uint16_t be16;
+            memcpy(&be16, data, sizeof be16);
+            return be16toh(be16);
+        }
+        case 4: {
+            uint32_t be32;
+            memcpy(&be32, data, sizeof be32);
+            return be32toh(be32);
+        }
+        default: {
+            uint64_t be64;
+            memcpy(&be64, data, sizeof be64);
+            return be64toh(be64);
+        }
+    }
+}
+
+LengthFieldCodec::LengthFieldCodec(int lengthFieldSize, size_t maxFrameSize, size_t maxReserve):
+            lengthFieldSize_(lengthFieldSize),
+            maxFrameSize_(maxFrameSize),
+            maxReserve_(maxReserve) {
+    if(lengthFieldSize != 1 && lengthFieldSize != 2 &&
+       lengthFieldSize != 4 && lengthFieldSize != 8) {
+        LOG_FATAL("Invalid length field size({})", lengthFieldSize);
+    }
+    if(lengthFieldSize < 8 && maxFrameSize_ >= (1ULL << (lengthFieldSize * 8))) {
+        LOG_WARN("Max frame size({}) exceeds the range of {}-byte length field", maxFrameSize_, lengthFieldSize);
+    }
+}
+
+LengthFieldCodec::Result LengthFieldCodec::decode(Buffer& buffer, Frame& frame) const {
+    size_t readable = buffer.readableBytes();
+    if(readable < static_cast<size_t>(lengthFieldSize_)) return kIncomplete;
+
+    uint64_t length = readLength(buffer.beginRead(), lengthFieldSize_);
+    if(length > maxFrameSize_) {
+        LOG_ERROR("Frame length({}) exceeds max frame size({})", length, maxFrameSize_);
+        return kError;
+    }
+    size_t total = lengthFieldSize_ + length;
+    if(readable < total) {
+        /* 为接下来的数据预留至多 maxReserve 字节，每次解码随已到达的数据向前推进；
+         * 整帧取走之前连接收缩读缓冲区时保留这部分空间 */
+        buffer.reserve(std::min(total - readable, maxReserve_));
+        return kIncomplete;
+    }
+    frame.payload = utils::StringPiece(buffer.beginRead() + lengthFieldSize_, static_cast<int>(length));
+    frame.length = total;
+    return kFrame;
+}
+
+bool LengthFieldCodec::encode(Buffer& buffer) const {
+    uint64_t length = buffer.readableBytes();
+    if(length > maxFrameSize_) {
+        LOG_ERROR("Payload length({}) exceeds max frame size({})", length, maxFrameSize_);
+        return false;
+    }
+    if(lengthFieldSize_ < 8 && length >= (1ULL << (lengthFieldSize_ * 8))) {
+        LOG_ERROR("Payload length({}) exceeds the range of {}-byte length field", length, lengthFieldSize_);
+        return false;
+    }
+    switch(lengthFieldSize_) {
+        case 1: {
+            uint8_t field = static_cast<uint8_t>(length);
+            buffer.prepend(&field, sizeof field);
+            break;
+        }
+        case 2: {
+            uint16_t field = htobe16(static_cast<uint16_t>(length));
+            buffer.prepend(&field, sizeof field);
+            break;
+        }
+        case 4: {
+            uint32_t field = htobe32(static_cast<uint32_t>(length));
+            buffer.prepend(&field, sizeof field);
+            break;
+        }
+        default: {
+            uint64_t field = htobe64(length);
+            buffer.prepend(&field, sizeof field);
+            break;
+        }
+    }
+    return true;
+}
+
+int LengthFieldCodec::lengthFieldSize() const { return lengthFieldSize_; }
+size_t LengthFieldCodec::maxFrameSize() const { return maxFrameSize_; }
+size_t LengthFieldCodec::maxReserve() const { return maxReserve_; }
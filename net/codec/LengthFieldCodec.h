@@ -0,0 +1,41 @@
+#pragma once
+
+/* Local headers */
+#include "net/codec/Codec.h"
+
+namespace esynet::codec {
+
+/* 长度前缀编解码器：帧头为 1/2/4/8 字节的网络字节序无符号整数，表示其后载荷的长度
+ *
+ * +----------------+---------------------+
+ * |  length field  |       payload       |
+ * +----------------+---------------------+
+ *
+ * 帧头揭示的帧较大时在读缓冲区中预留空间，后续数据直接读入而不必反复扩容；帧头来自对端，
+ * 一次至多预留 maxReserve 字节，随数据到达逐步扩大，避免一个帧头就占用整帧的内存；
+ * 载荷超过 maxFrameSize 的帧视为非法 */
+class LengthFieldCodec : public Codec {
+public:
+    static const size_t kDefaultMaxFrameSize;
+    static const size_t kDefaultMaxReserve;
+
+public:
+    explicit LengthFieldCodec(int lengthFieldSize = 4,
+                              size_t maxFrameSize = kDefaultMaxFrameSize,
+                              size_t maxReserve = kDefaultMaxReserve);
+
+    auto decode(utils::Buffer&, Frame&) const -> Result override;
+    /* 帧头写入 prepend 区，载荷不移动；载荷超过 maxFrameSize 或帧头的表示范围时不编码 */
+    bool encode(utils::Buffer&) const override;
+
+    auto lengthFieldSize() const -> int;
+    auto maxFrameSize() const -> size_t;
+    auto maxReserve() const -> size_t;
+
+private:
+    const int lengthFieldSize_;
+    const size_t maxFrameSize_;
+    const size_t maxReserve_;
+};
+
+} /* namespace esynet::codec */
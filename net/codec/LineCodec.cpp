@@ -0,0 +1,39 @@
+#include "net/codec/LineCodec.h"
+
+/* Local headers */
+#include "logger/Logger.h"
+
+using esynet::codec::LineCodec;
+using esynet::utils::Buffer;
+
+const size_t LineCodec::kDefaultMaxLineLength = 64_KB;
+
+LineCodec::LineCodec(Delimiter delimiter, size_t maxLineLength):
+            delimiter_(delimiter),
+            maxLineLength_(maxLineLength) {}
+
+LineCodec::Result LineCodec::decode(Buffer& buffer, Frame& frame) const {
+    if(buffer.readableBytes() == 0) return kIncomplete;
+
+    const char* begin = buffer.beginRead();
+    const char* end = delimiter_ == kCRLF ? buffer.findCRLF() : buffer.findEOL();
+    if(!end) {
+        if(buffer.readableBytes() > maxLineLength_) {
+            LOG_ERROR("Line length exceeds max line length({})", maxLineLength_);
+            return kError;
+        }
+        return kIncomplete;
+    }
+    size_t delimiterLength = delimiter_ == kCRLF ? 2 : 1;
+    frame.length = end - begin + delimiterLength;
+    if(delimiter_ == kLF && end > begin && end[-1] == '\r') --end;
+    frame.payload = utils::StringPiece(begin, static_cast<int>(end - begin));
+    return kFrame;
+}
+
+bool LineCodec::encode(Buffer& buffer) const {
+    buffer.append(delimiter_ == kCRLF ? "\r\n" : "\n");
+    return true;
+}
+
+LineCodec::Delimiter LineCodec::delimiter() const { return delimiter_; }
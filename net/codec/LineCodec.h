@@ -0,0 +1,31 @@
+#pragma once
+
+/* Local headers */
+#include "net/codec/Codec.h"
+
+namespace esynet::codec {
+
+/* 按行分帧的编解码器，帧为不含分隔符的一行
+ * kCRLF 以 "\r\n" 分隔；kLF 以 "\n" 分隔，行尾的 '\r' 一并去掉
+ * 等待分隔符的数据超过 maxLineLength 时视为非法 */
+class LineCodec : public Codec {
+public:
+    enum Delimiter { kCRLF, kLF };
+
+    static const size_t kDefaultMaxLineLength;
+
+public:
+    explicit LineCodec(Delimiter = kCRLF, size_t maxLineLength = kDefaultMaxLineLength);
+
+    auto decode(utils::Buffer&, Frame&) const -> Result override;
+    /* 在载荷之后追加分隔符 */
+    bool encode(utils::Buffer&) const override;
+
+    auto delimiter() const -> Delimiter;
+
+private:
+    const Delimiter delimiter_;
+    const size_t maxLineLength_;
+};
+
+} /* namespace esynet::codec */
@@ -37,11 +37,27 @@ EpollPoller::EpollPoller(Looper& looper):
 EpollPoller::~EpollPoller() { close(epollFd_); }
 
 Timestamp EpollPoller::poll(EventList& activeEvents, int timeoutMs) {
+    flushChanges();
+    /* 无效的 fd 无法注册到 epoll，与 poll 一致地以 POLLNVAL 报告 */
+    for(int fd : invalidFds_) {
+        Event* event = events_.find(fd);
+        if(!event) continue;
+        event->setHappenedEvent(POLLNVAL);
+        activeEvents.push_back(event);
+    }
+    if(!invalidFds_.empty()) {
+        invalidFds_.clear();
+        timeoutMs = 0;
+    }
     int numEvents = epoll_wait(epollFd_, &*epollEvents_.begin(), epollEvents_.size(), timeoutMs);
     Timestamp pollTime(Timestamp::now());
     if(numEvents > 0) {
         LOG_DEBUG("{} events happened", numEvents);
         fillActiveEvents(numEvents, activeEvents);
+        /* 返回的事件填满了列表，说明可能还有更多就绪事件，扩容以便下次一并取出 */
+        if(static_cast<size_t>(numEvents) == epollEvents_.size()) {
+            epollEvents_.resize(epollEvents_.size() * 2);
+        }
     } else if(numEvents == 0) {
         LOG_DEBUG("Nothing happened");
     } else {
@@ -50,68 +66,112 @@ Timestamp EpollPoller::poll(EventList& activeEvents, int timeoutMs) {
     return pollTime;
 }
 
+/* index 仅用于标记 Event 是否已注册：非负为已注册，负数为未注册
+ * 注册与修改只记录在变化列表中，在下一次 epoll_wait 之前统一提交 */
 void EpollPoller::updateEvent(Event& event) {
     if(event.index() < 0) {
         if(event.listenedEvent() < 0) return;
         /* 添加至列表 */
-        if(events_.find(event.fd()) != events_.end()) {
+        if(events_.find(event.fd())) {
             LOG_ERROR("Event(fd: {}) already exists", event.fd());
         }
-        if(event.listenedEvent() < 0) return;
-        epollUpdate(EPOLL_CTL_ADD, event);
+        events_.insert(event.fd(), &event);
+        event.setIndex(event.fd());
+        countChange();
+        markDirty(event.fd());
     } else {
         /* 更新列表 */
-        if(events_.find(event.fd()) == events_.end()) {
+        Event* registered = events_.find(event.fd());
+        if(!registered) {
             LOG_ERROR("Event(fd: {}) not exists", event.fd());
-        } else if(events_[event.fd()] != &event) {
+        } else if(registered != &event) {
             LOG_ERROR("Event(fd: {}) not the same", event.fd());
         }
         if(event.listenedEvent() < 0) {
             removeEvent(event);
         } else {
-            epollUpdate(EPOLL_CTL_MOD, event);
+            countChange();
+            markDirty(event.fd());
         }
     }
 }
 
+/* 移除立刻生效：fd 随后可能被关闭并复用，延迟的 DEL 会作用在错误的文件上 */
 void EpollPoller::removeEvent(Event& event) {
-    epollUpdate(EPOLL_CTL_DEL, event);
-
-    events_.erase(event.fd());
-    int index = event.index();
-    if(index >= epollEvents_.size() || index < 0) {
-        LOG_ERROR("Event(fd: {}) index out of range", event.fd());
-    } else if(index == epollEvents_.size() - 1) {
-        epollEvents_.pop_back();
-    } else {
-        int lastFd = epollEvents_.back().data.fd;
-        std::iter_swap(epollEvents_.begin() + index, epollEvents_.end() - 1);
-        epollEvents_.pop_back();
-        events_[lastFd]->setIndex(index);
+    if(event.index() < 0) return;
+    countChange();
+    Registration& registration = registrationOf(event.fd());
+    if(registration.events != 0) {
+        epollCtl(EPOLL_CTL_DEL, event.fd(), 0);
+        registration.events = 0;
     }
+    events_.erase(event.fd());
     event.setIndex(-event.fd() - 1);
 }
 
-void EpollPoller::epollUpdate(int operation, Event& event) {
+EpollPoller::Registration& EpollPoller::registrationOf(int fd) {
+    if(static_cast<size_t>(fd) >= registrations_.size()) {
+        registrations_.resize(std::max(static_cast<size_t>(fd) + 1, registrations_.size() * 2));
+    }
+    return registrations_[fd];
+}
+
+void EpollPoller::markDirty(int fd) {
+    Registration& registration = registrationOf(fd);
+    if(!registration.dirty) {
+        registration.dirty = true;
+        changes_.push_back(fd);
+    }
+}
+
+/* 同一轮内对同一 fd 的多次修改合并为一次 epoll_ctl，最终与内核中一致时不提交 */
+void EpollPoller::flushChanges() {
+    for(int fd : changes_) {
+        Registration& registration = registrations_[fd];
+        registration.dirty = false;
+        Event* event = events_.find(fd);
+        if(!event) continue;
+
+        uint32_t wanted = static_cast<uint16_t>(event->listenedEvent());
+        if(event->edgeTriggered()) wanted |= EPOLLET;
+        if(wanted == registration.events) continue;
+        int operation = registration.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        if(epollCtl(operation, fd, wanted)) {
+            registration.events = wanted;
+        }
+    }
+    changes_.clear();
+}
+
+/* 内核中的注册可能已因 fd 被关闭而消失，或 fd 被复用时仍残留，分别改用 ADD/MOD 重试 */
+bool EpollPoller::epollCtl(int operation, int fd, uint32_t events) {
     EpollEvent epollEvent;
-    epollEvent.events = event.listenedEvent();
-    epollEvent.data.fd = event.fd();
-    LOG_DEBUG("epoll_ctl(op: {}, fd: {})", optStr(operation), event.fd());
-    if(epoll_ctl(epollFd_, operation, event.fd(), &epollEvent) < 0) {
-        LOG_ERROR("epoll_ctl(op: {}, fd: {}, errno: {}) error",
-                    optStr(operation), event.fd(), errnoStr(errno));
+    epollEvent.events = events;
+    epollEvent.data.fd = fd;
+    LOG_DEBUG("epoll_ctl(op: {}, fd: {})", optStr(operation), fd);
+    countCommit();
+    if(epoll_ctl(epollFd_, operation, fd, &epollEvent) == 0) return true;
+
+    if(operation == EPOLL_CTL_MOD && errno == ENOENT) {
+        return epollCtl(EPOLL_CTL_ADD, fd, events);
+    } else if(operation == EPOLL_CTL_ADD && errno == EEXIST) {
+        return epollCtl(EPOLL_CTL_MOD, fd, events);
+    } else if(operation == EPOLL_CTL_DEL && (errno == ENOENT || errno == EBADF)) {
+        return true;
     }
-    if(operation == EPOLL_CTL_ADD) {
-        epollEvents_.push_back(epollEvent);
-        event.setIndex(epollEvents_.size() - 1);
-        events_[event.fd()] = &event;
+    LOG_ERROR("epoll_ctl(op: {}, fd: {}, errno: {}) error",
+                optStr(operation), fd, errnoStr(errno));
+    if(operation == EPOLL_CTL_ADD && errno == EBADF) {
+        invalidFds_.push_back(fd);
     }
+    return false;
 }
 
 void EpollPoller::fillActiveEvents(int numEvents, EventList& activeEvents) const {
     for(int i = 0; i < numEvents; ++i) {
-        Event* event = events_.at(epollEvents_[i].data.fd);
+        Event* event = events_.find(epollEvents_[i].data.fd);
+        if(!event) continue;
         event->setHappenedEvent(epollEvents_[i].events);
         activeEvents.push_back(event);
     }
-}
\ No newline at end of file
+}
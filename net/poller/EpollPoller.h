@@ -8,6 +8,8 @@
 
 namespace esynet::poller {
 
+/* updateEvent 只记录兴趣集的变化，在下一次 epoll_wait 之前统一提交，
+ * 同一轮内对同一 fd 的多次修改（如发送时开启又关闭 EPOLLOUT）至多产生一次 epoll_ctl */
 class EpollPoller : public Poller {
 public:
     static const int kInitEventListSize;
@@ -20,14 +22,26 @@ public:
     void removeEvent(Event&) override;
 
 private:
-    void epollUpdate(int operation, Event&);
+    /* 每个 fd 在内核中的注册状态 */
+    struct Registration {
+        uint32_t events {0};        /* 已提交给内核的监听事件，0 表示未注册 */
+        bool     dirty  {false};
+    };
+
+    auto registrationOf(int fd) -> Registration&;
+    void markDirty(int fd);
+    void flushChanges();
+    bool epollCtl(int operation, int fd, uint32_t events);
     void fillActiveEvents(int eventsNum, EventList&) const;
 
 private:
     using EpollEvent = struct epoll_event;
 
     int epollFd_;
-    std::vector<EpollEvent> epollEvents_;
+    std::vector<EpollEvent> epollEvents_;   /* epoll_wait 的输出列表 */
+    std::vector<int> invalidFds_;           /* 注册失败的无效 fd，下一次 poll 时报告 */
+    std::vector<Registration> registrations_;   /* 以 fd 为下标 */
+    std::vector<int> changes_;              /* 本轮兴趣集发生变化的 fd */
 };
 
 } /* namespace esynet::poller */
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include "net/poller/IoUring.h"
+
+/* Standard headers */
+#include <algorithm>
+#include <cstring>
+#include <csignal>
+
+/* Linux headers */
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Local headers */
+#include "logger/Logger.h"
+#include "utils/ErrorInfo.h"
+
+using esynet::poller::IoUring;
+using esynet::poller::BufferGroup;
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+static int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete,
+                        unsigned flags, const void* arg, size_t argSize) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize));
+}
+
+/* multishot poll 自 5.13 起可用，IORING_FEAT_RSRC_TAGS 同样在 5.13 引入，
+ * 以此作为判断依据；带超时的等待需要 IORING_FEAT_EXT_ARG */
+bool IoUring::supported() {
+    static const bool support = [] {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof params);
+        int fd = ioUringSetup(2, &params);
+        if(fd < 0) return false;
+        close(fd);
+        return (params.features & IORING_FEAT_EXT_ARG)
+            && (params.features & IORING_FEAT_RSRC_TAGS)
+            && (params.features & IORING_FEAT_NODROP);
+    }();
+    return support;
+}
+
+/* 以一次真实的接收来探测：先向 socketpair 写入一个字节，支持时完成事件带有数据与 IORING_CQE_F_MORE，
+ * 不支持时内核在提交时即以 -EINVAL 完成；发行版可能向旧内核移植特性，因此不按内核版本判断 */
+bool IoUring::multishotRecvSupported() {
+    static const bool support = [] {
+        if(!supported()) return false;
+        int fds[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) < 0) return false;
+        bool result = false;
+        {
+            const uint64_t kRecvData = 1;
+            IoUring ring(4);
+            BufferGroup group(ring, 0, 1, 64, 0);
+            char byte = 0;
+            if(write(fds[1], &byte, 1) == 1) {
+                Sqe* sqe = ring.getSqe();
+                sqe->opcode    = IORING_OP_RECV;
+                sqe->fd        = fds[0];
+                sqe->ioprio    = IORING_RECV_MULTISHOT;
+                sqe->flags     = IOSQE_BUFFER_SELECT;
+                sqe->buf_group = group.group();
+                sqe->user_data = kRecvData;
+                ring.submitAndWait(100);
+                ring.forEachCqe([&result, kRecvData](const Cqe& cqe) {
+                    if(cqe.user_data == kRecvData) result = cqe.res > 0 && (cqe.flags & IORING_CQE_F_MORE);
+                });
+            }
+        }
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }();
+    return support;
+}
+
+IoUring::IoUring(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof params);
+    /* 完成队列开大一些，multishot 请求一次提交会产生多个完成事件 */
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 4;
+    ringFd_ = ioUringSetup(entries, &params);
+    if(ringFd_ < 0) {
+        LOG_FATAL("io_uring_setup error(err: {})", errnoStr(errno));
+    }
+
+    size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(Cqe);
+    ringSize_ = std::max(sqSize, cqSize);
+    ringPtr_ = mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    sqesSize_ = params.sq_entries * sizeof(Sqe);
+    void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+    if(ringPtr_ == MAP_FAILED || sqes == MAP_FAILED) {
+        LOG_FATAL("io_uring mmap error(err: {})", errnoStr(errno));
+    }
+    sqes_ = static_cast<Sqe*>(sqes);
+
+    char* ring = static_cast<char*>(ringPtr_);
+    sqHead_    = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+    sqTail_    = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+    sqMask_    = reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+    sqArray_   = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+    sqEntries_ = params.sq_entries;
+    cqHead_    = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+    cqTail_    = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+    cqMask_    = reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+    cqes_      = reinterpret_cast<Cqe*>(ring + params.cq_off.cqes);
+    sqeTail_   = *sqTail_;
+    submitted_ = *sqHead_;
+}
+
+IoUring::~IoUring() {
+    munmap(sqes_, sqesSize_);
+    munmap(ringPtr_, ringSize_);
+    close(ringFd_);
+}
+
+int IoUring::fd() const { return ringFd_; }
+unsigned IoUring::pending() const { return sqeTail_ - submitted_; }
+
+IoUring::Sqe* IoUring::getSqe() {
+    unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if(sqeTail_ - head >= sqEntries_) {
+        submit();
+        head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        if(sqeTail_ - head >= sqEntries_) {
+            LOG_ERROR("io_uring submission queue is full");
+            return nullptr;
+        }
+    }
+    unsigned index = sqeTail_ & *sqMask_;
+    Sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(Sqe));
+    sqArray_[index] = index;
+    ++sqeTail_;
+    return sqe;
+}
+
+int IoUring::submit() {
+    unsigned toSubmit = pending();
+    if(toSubmit == 0) return 0;
+    __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+    int ret = ioUringEnter(ringFd_, toSubmit, 0, 0, nullptr, 0);
+    if(ret < 0) {
+        LOG_ERROR("io_uring_enter error(err: {})", errnoStr(errno));
+    }
+    /* 非 SQPOLL 模式下内核在系统调用内同步消费提交队列 */
+    submitted_ = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    return ret;
+}
+
+int IoUring::submitAndWait(int timeoutMs) {
+    unsigned toSubmit = pending();
+    __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+
+    struct __kernel_timespec ts;
+    ts.tv_sec  = timeoutMs / 1000;
+    ts.tv_nsec = (timeoutMs % 1000) * 1000 * 1000;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof arg);
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = timeoutMs < 0 ? 0 : reinterpret_cast<uint64_t>(&ts);
+
+    int ret = ioUringEnter(ringFd_, toSubmit, 1,
+                           IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof arg);
+    if(ret < 0) {
+        if(errno == ETIME || errno == EINTR) {
+            ret = 0;
+        } else {
+            LOG_ERROR("io_uring_enter error(err: {})", errnoStr(errno));
+        }
+    }
+    /* 超时或被信号打断时条目仍然已被提交 */
+    submitted_ = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    return ret;
+}
+
+BufferGroup::BufferGroup(IoUring& ring, uint16_t group, unsigned count, unsigned size, uint64_t userData):
+                ring_(ring), group_(group), size_(size), userData_(userData),
+                buffers_(static_cast<size_t>(count) * size) {
+    if(!provide(0, count)) {
+        for(unsigned bid = 0; bid < count; ++bid) pending_.push_back(static_cast<uint16_t>(bid));
+    }
+}
+
+uint16_t    BufferGroup::group()      const { return group_; }
+unsigned    BufferGroup::bufferSize() const { return size_; }
+const char* BufferGroup::data(uint16_t bid) const {
+    return buffers_.data() + static_cast<size_t>(bid) * size_;
+}
+
+void BufferGroup::recycle(uint16_t bid) {
+    if(!provide(bid, 1)) pending_.push_back(bid);
+}
+void BufferGroup::retryRecycle() {
+    while(!pending_.empty()) {
+        if(!provide(pending_.back(), 1)) return;
+        pending_.pop_back();
+    }
+}
+size_t BufferGroup::pendingRecycles() const { return pending_.size(); }
+
+/* 将从 bid 开始的连续 count 个缓冲区交给内核 */
+bool BufferGroup::provide(uint16_t bid, unsigned count) {
+    IoUring::Sqe* sqe = ring_.getSqe();
+    if(!sqe) return false;
+    sqe->opcode    = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd        = static_cast<int>(count);
+    sqe->addr      = reinterpret_cast<uint64_t>(data(bid));
+    sqe->len       = size_;
+    sqe->off       = bid;
+    sqe->buf_group = group_;
+    sqe->user_data = userData_;
+    return true;
+}
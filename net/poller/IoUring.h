@@ -0,0 +1,107 @@
+#pragma once
+
+/* Standard headers */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Linux headers */
+#include <linux/io_uring.h>
+
+/* Local headers */
+#include "utils/NonCopyable.h"
+
+namespace esynet::poller {
+
+/* io_uring 的最小封装，直接使用系统调用而不依赖 liburing，非线程安全 */
+class IoUring : public utils::NonCopyable {
+public:
+    using Sqe = struct io_uring_sqe;
+    using Cqe = struct io_uring_cqe;
+
+    /* 内核是否支持本库所需的 io_uring 特性（multishot poll、带超时的等待） */
+    static bool supported();
+    /* 内核是否支持 multishot 接收（IORING_RECV_MULTISHOT，6.0 起），完成式 I/O 依赖该特性 */
+    static bool multishotRecvSupported();
+
+public:
+    IoUring(unsigned entries);
+    ~IoUring();
+
+    int fd() const;
+
+    /* 获取一个空闲的提交条目，提交队列已满时会先将已有条目提交给内核 */
+    auto getSqe() -> Sqe*;
+    /* 尚未提交给内核的条目数 */
+    unsigned pending() const;
+    int  submit();
+    /* 提交所有条目，并至多等待 timeoutMs 毫秒直到至少有一个完成事件 */
+    int  submitAndWait(int timeoutMs);
+
+    /* 依次处理并消费所有已完成的事件，返回处理的数量 */
+    template<typename Function>
+    unsigned forEachCqe(Function func) {
+        unsigned head = *cqHead_;
+        unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        for(; head != tail; ++head, ++count) {
+            func(cqes_[head & *cqMask_]);
+        }
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+private:
+    int ringFd_;
+    unsigned sqeTail_ {0};      /* 本地维护的提交队列尾，submit 时发布给内核 */
+    unsigned submitted_ {0};
+
+    void*    ringPtr_;
+    size_t   ringSize_;
+    Sqe*     sqes_;
+    size_t   sqesSize_;
+
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned* sqMask_;
+    unsigned* sqArray_;
+    unsigned  sqEntries_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned* cqMask_;
+    Cqe*      cqes_;
+};
+
+/* 提供给内核的接收缓冲区组（IORING_OP_PROVIDE_BUFFERS），接收请求携带
+ * IOSQE_BUFFER_SELECT 时由内核自行从组中挑选缓冲区，完成事件中给出缓冲区编号，
+ * 使用者处理完数据后需要调用 recycle 将缓冲区归还
+ *
+ * 归还操作只是准备一个提交条目，随下一次 io_uring_enter 一并提交；提交队列已满时
+ * 缓冲区编号先记下，由 retryRecycle 在下一次提交前重新归还，否则缓冲区组会越用越少 */
+class BufferGroup : public utils::NonCopyable {
+public:
+    /* userData 为缓冲区提交请求使用的 user_data，其完成事件应被使用者忽略 */
+    BufferGroup(IoUring&, uint16_t group, unsigned count, unsigned size, uint64_t userData);
+
+    uint16_t group() const;
+    unsigned bufferSize() const;
+    auto data(uint16_t bid) const -> const char*;
+    void recycle(uint16_t bid);
+    /* 重新归还之前因提交队列已满而未能归还的缓冲区，由 Poller 在每次提交前调用 */
+    void retryRecycle();
+    /* 尚未归还给内核的缓冲区数 */
+    auto pendingRecycles() const -> size_t;
+
+private:
+    /* 没有空闲的提交条目时返回 false */
+    bool provide(uint16_t bid, unsigned count);
+
+    IoUring& ring_;
+    const uint16_t group_;
+    const unsigned size_;
+    const uint64_t userData_;
+    std::vector<char> buffers_;
+    std::vector<uint16_t> pending_;
+};
+
+} /* namespace esynet::poller */
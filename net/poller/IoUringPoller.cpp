@@ -0,0 +1,319 @@
+#include "net/poller/IoUringPoller.h"
+
+/* Linux headers */
+#include <sys/poll.h>
+
+/* Local headers */
+#include "logger/Logger.h"
+#include "net/base/Event.h"
+#include "utils/ErrorInfo.h"
+#include "utils/Buffer.h"
+
+using esynet::poller::IoUringPoller;
+using esynet::utils::Timestamp;
+
+const unsigned IoUringPoller::kRingEntries     = 1024;
+const unsigned IoUringPoller::kRecvBufferCount = 256;
+const unsigned IoUringPoller::kRecvBufferSize  = 16_KB;
+
+/* user_data 布局:
+ * poll 请求:  | recheck(1) | 0(1) | generation(30) | fd(32) |
+ * 完成式请求: | 0(1)       | 1(1) | slot(54)             | tag(8) | */
+static const uint64_t kRecheckBit    = 1ULL << 63;
+static const uint64_t kCompletionBit = 1ULL << 62;
+static const uint32_t kGenerationMask = 0x3fffffff;
+static const uint64_t kIgnoreData    = ~0ULL;   /* 取消请求自身的完成事件 */
+
+static uint64_t encodeData(int fd, uint32_t generation, bool recheck) {
+    uint64_t data = (static_cast<uint64_t>(generation & kGenerationMask) << 32)
+                  | static_cast<uint32_t>(fd);
+    return recheck ? data | kRecheckBit : data;
+}
+
+IoUringPoller::IoUringPoller(Looper& looper): Poller(looper), ring_(kRingEntries) {}
+
+Timestamp IoUringPoller::poll(EventList& activeEvents, int timeoutMs) {
+    if(bufferGroup_) bufferGroup_->retryRecycle();
+    submitRechecks();
+    flushChanges();
+    LOG_DEBUG("io_uring submit {} entries", ring_.pending());
+    ring_.submitAndWait(timeoutMs);
+    Timestamp pollTime(Timestamp::now());
+    fillActiveEvents(activeEvents);
+    dispatchCompletions();
+    if(activeEvents.empty()) {
+        LOG_DEBUG("Nothing happened");
+    } else {
+        LOG_DEBUG("{} events happened", activeEvents.size());
+    }
+    return pollTime;
+}
+
+void IoUringPoller::updateEvent(Event& event) {
+    if(event.index() < 0) {
+        if(event.listenedEvent() < 0) return;
+        /* 添加至列表 */
+        if(events_.find(event.fd())) {
+            LOG_ERROR("Event(fd: {}) already exists", event.fd());
+        }
+        events_.insert(event.fd(), &event);
+        event.setIndex(event.fd());
+        Interest& interest = interestOf(event.fd());
+        interest.event = &event;
+        countChange();
+        markDirty(event.fd(), interest);
+    } else {
+        /* 更新列表 */
+        Interest* interest = findInterest(event.fd());
+        if(!interest || interest->event != &event) {
+            LOG_ERROR("Event(fd: {}) not exists", event.fd());
+            return;
+        }
+        if(event.listenedEvent() < 0) {
+            removeEvent(event);
+        } else {
+            countChange();
+            markDirty(event.fd(), *interest);
+        }
+    }
+}
+
+/* Event 在移除后随时可能被析构，因此立刻解除关联，内核中的注册稍后统一撤销。
+ * fd 可能在同一轮内被关闭并复用，旧的注册仍指向已关闭的文件，因此标记为必须撤销 */
+void IoUringPoller::removeEvent(Event& event) {
+    if(event.index() < 0) return;
+    Interest* interest = findInterest(event.fd());
+    if(!interest || interest->event != &event) {
+        LOG_ERROR("Event(fd: {}) not exists", event.fd());
+    } else {
+        interest->event   = nullptr;
+        interest->removed = true;
+        countChange();
+        markDirty(event.fd(), *interest);
+    }
+    events_.erase(event.fd());
+    event.setIndex(-event.fd() - 1);
+}
+
+/* 兴趣表同样以 fd 为下标 */
+IoUringPoller::Interest& IoUringPoller::interestOf(int fd) {
+    if(static_cast<size_t>(fd) >= interests_.size()) {
+        interests_.resize(std::max(static_cast<size_t>(fd) + 1, interests_.size() * 2));
+    }
+    return interests_[fd];
+}
+IoUringPoller::Interest* IoUringPoller::findInterest(int fd) {
+    return fd >= 0 && static_cast<size_t>(fd) < interests_.size() ? &interests_[fd] : nullptr;
+}
+
+void IoUringPoller::markDirty(int fd, Interest& interest) {
+    if(!interest.dirty) {
+        interest.dirty = true;
+        changes_.push_back(fd);
+    }
+}
+
+void IoUringPoller::prepPollAdd(int fd, Interest& interest, bool oneshot) {
+    IoUring::Sqe* sqe = ring_.getSqe();
+    if(!sqe) return;
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = fd;
+    sqe->poll32_events = interest.armed;
+    sqe->len           = oneshot ? 0 : IORING_POLL_ADD_MULTI;
+    sqe->user_data     = encodeData(fd, interest.generation, oneshot);
+}
+
+void IoUringPoller::prepPollRemove(int fd, const Interest& interest, bool recheck) {
+    IoUring::Sqe* sqe = ring_.getSqe();
+    if(!sqe) return;
+    sqe->opcode    = IORING_OP_POLL_REMOVE;
+    sqe->fd        = -1;
+    sqe->addr      = encodeData(fd, interest.generation, recheck);
+    sqe->user_data = kIgnoreData;
+}
+
+/* 将本轮累积的兴趣集变化转换为提交条目 */
+void IoUringPoller::flushChanges() {
+    for(int fd : changes_) {
+        Interest* found = findInterest(fd);
+        if(!found) continue;
+        Interest& interest = *found;
+        interest.dirty = false;
+
+        uint32_t wanted = 0;
+        if(interest.event && interest.event->listenedEvent() > 0) {
+            wanted = static_cast<uint16_t>(interest.event->listenedEvent());
+        }
+        if(wanted != 0 && wanted == interest.armed && !interest.removed) continue;
+        interest.removed = false;
+
+        if(interest.armed) {
+            countCommit();
+            prepPollRemove(fd, interest, false);
+            if(interest.recheck) prepPollRemove(fd, interest, true);
+            interest.armed   = 0;
+            interest.recheck = false;
+        }
+        if(!interest.event) {
+            interest = Interest();
+            continue;
+        }
+        interest.generation = nextGeneration_++;
+        if(wanted) {
+            countCommit();
+            interest.armed = wanted;
+            prepPollAdd(fd, interest, false);
+        }
+    }
+    changes_.clear();
+}
+
+/* 对上一轮就绪的 fd 发起一次 oneshot poll，仍然就绪时会立刻完成 */
+void IoUringPoller::submitRechecks() {
+    for(int fd : fired_) {
+        Interest* found = findInterest(fd);
+        if(!found) continue;
+        Interest& interest = *found;
+        if(!interest.event || !interest.armed || interest.recheck || interest.dirty) continue;
+        interest.recheck = true;
+        prepPollAdd(fd, interest, true);
+    }
+    fired_.clear();
+}
+
+void IoUringPoller::fillActiveEvents(EventList& activeEvents) {
+    ++round_;
+    ring_.forEachCqe([this, &activeEvents](const IoUring::Cqe& cqe) {
+        if(cqe.user_data == kIgnoreData) return;
+        if(cqe.user_data & kCompletionBit) {
+            completions_.push_back(cqe);
+            return;
+        }
+        int fd = static_cast<int>(cqe.user_data & 0xffffffff);
+        uint32_t generation = static_cast<uint32_t>(cqe.user_data >> 32) & kGenerationMask;
+        bool recheck = cqe.user_data & kRecheckBit;
+
+        Interest* found = findInterest(fd);
+        if(!found) return;
+        Interest& interest = *found;
+        if(generation != (interest.generation & kGenerationMask)) return;
+
+        if(recheck) {
+            interest.recheck = false;
+        } else if(!(cqe.flags & IORING_CQE_F_MORE)) {
+            /* multishot 请求已被内核终止，除被取消与 fd 失效外都重新注册，
+             * 出错终止时用户的错误回调可能保留该 fd，不重新注册就再也收不到事件 */
+            interest.armed = 0;
+            if(cqe.res != -ECANCELED && cqe.res != -EBADF && interest.event) {
+                markDirty(fd, interest);
+            } else if(cqe.res == -EBADF && interest.event) {
+                LOG_WARN("io_uring poll of fd {} ends with EBADF, it will not be rearmed", fd);
+            }
+        }
+
+        uint32_t revents;
+        if(cqe.res == -ECANCELED) {
+            return;
+        } else if(cqe.res == -EBADF) {
+            revents = POLLNVAL;
+        } else if(cqe.res < 0) {
+            LOG_ERROR("io_uring poll error(fd: {}, err: {})", fd, errnoStr(-cqe.res));
+            revents = POLLERR;
+        } else {
+            revents = static_cast<uint32_t>(cqe.res);
+        }
+        if(!interest.event || revents == 0) return;
+
+        if(interest.round == round_) {
+            interest.happened |= revents;
+        } else {
+            interest.round    = round_;
+            interest.happened = revents;
+            activeEvents.push_back(interest.event);
+            fired_.push_back(fd);
+        }
+    });
+    for(Event* event : activeEvents) {
+        event->setHappenedEvent(interests_[event->fd()].happened);
+    }
+}
+
+/* 完成回调在所有完成事件收集完毕后统一执行，回调中可以自由地提交新请求 */
+void IoUringPoller::dispatchCompletions() {
+    for(size_t i = 0; i < completions_.size(); ++i) {
+        const IoUring::Cqe& cqe = completions_[i];
+        uint64_t index = (cqe.user_data & ~kCompletionBit) >> 8;
+        if(index >= slots_.size()) continue;
+        CompletionSlot& slot = slots_[index];
+        if(slot.active) {
+            slot.callback(cqe);
+        }
+        if(!(cqe.flags & IORING_CQE_F_MORE) && slot.inflight > 0 && --slot.inflight == 0 && !slot.active) {
+            slot.callback  = nullptr;
+            slot.keepAlive = nullptr;
+            freeSlots_.push_back(static_cast<uint32_t>(index));
+        }
+    }
+    completions_.clear();
+}
+
+uint64_t IoUringPoller::addCompletion(Completion callback) {
+    uint64_t index;
+    if(freeSlots_.empty()) {
+        index = slots_.size();
+        slots_.emplace_back();
+    } else {
+        index = freeSlots_.back();
+        freeSlots_.pop_back();
+    }
+    CompletionSlot& slot = slots_[index];
+    slot.callback = std::move(callback);
+    slot.active   = true;
+    return kCompletionBit | (index << 8);
+}
+
+void IoUringPoller::removeCompletion(uint64_t key, std::shared_ptr<void> keepAlive) {
+    uint64_t index = (key & ~kCompletionBit) >> 8;
+    if(index >= slots_.size() || !slots_[index].active) {
+        LOG_ERROR("Completion(key: {}) not exists", key);
+        return;
+    }
+    CompletionSlot& slot = slots_[index];
+    slot.active = false;
+    if(slot.inflight == 0) {
+        /* 没有未完成的请求时不会处于自身回调中，可以立刻释放 */
+        slot.callback = nullptr;
+        freeSlots_.push_back(static_cast<uint32_t>(index));
+    } else {
+        slot.keepAlive = std::move(keepAlive);
+    }
+}
+
+esynet::poller::IoUring::Sqe* IoUringPoller::prepareSqe(uint64_t key, uint8_t tag) {
+    IoUring::Sqe* sqe = ring_.getSqe();
+    if(!sqe) return nullptr;
+    sqe->user_data = key | tag;
+    ++slots_[(key & ~kCompletionBit) >> 8].inflight;
+    return sqe;
+}
+
+void IoUringPoller::cancel(uint64_t key, uint8_t tag) {
+    IoUring::Sqe* sqe = ring_.getSqe();
+    if(!sqe) return;
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->fd           = -1;
+    sqe->addr         = key | tag;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data    = kIgnoreData;
+}
+
+esynet::poller::BufferGroup& IoUringPoller::bufferGroup() {
+    if(!bufferGroup_) {
+        bufferGroup_ = std::make_unique<BufferGroup>(ring_, 0, kRecvBufferCount, kRecvBufferSize, kIgnoreData);
+    }
+    return *bufferGroup_;
+}
+
+uint8_t IoUringPoller::tagOf(const IoUring::Cqe& cqe) {
+    return static_cast<uint8_t>(cqe.user_data & 0xff);
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+/* Standard headers */
+#include <deque>
+#include <memory>
+#include <vector>
+#include <functional>
+
+/* Local headers */
+#include "net/poller/Poller.h"
+#include "net/poller/IoUring.h"
+
+namespace esynet::poller {
+
+/* 基于 io_uring 的 Poller，使用 multishot IORING_OP_POLL_ADD 注册监听，
+ * 就绪事件以完成事件的形式返回
+ *
+ * updateEvent/removeEvent 只记录兴趣集的变化，在下一次 poll 时统一生成
+ * 提交条目，并与等待操作合并为一次 io_uring_enter。同一轮内对同一 fd 的
+ * 多次修改只会产生一次提交。
+ * multishot poll 是边沿触发的，为保持与 EpollPoller 一致的水平触发语义，
+ * 上一轮就绪的 fd 会附带一次 oneshot poll 检查其是否仍然就绪
+ *
+ * 此外提供完成式 I/O 的接口：使用者注册一个完成回调，之后通过 prepareSqe
+ * 提交的请求在完成时会在 poll 返回前回调 */
+class IoUringPoller : public Poller {
+public:
+    static const unsigned kRingEntries;
+    static const unsigned kRecvBufferCount;
+    static const unsigned kRecvBufferSize;
+
+    using Completion = std::function<void(const IoUring::Cqe&)>;
+
+public:
+    IoUringPoller(Looper&);
+    ~IoUringPoller() override = default;
+
+    auto poll(EventList&, int timeoutMs) -> utils::Timestamp override;
+    void updateEvent(Event&) override;
+    void removeEvent(Event&) override;
+
+    /* 完成式 I/O，返回的 key 用于之后的提交与注销 */
+    auto addCompletion(Completion) -> uint64_t;
+    /* 注销后残留的完成事件会被丢弃，keepAlive 会保持到该 key 的所有请求结束，
+     * 用于延长内核仍在访问的内存的生命周期 */
+    void removeCompletion(uint64_t key, std::shared_ptr<void> keepAlive = nullptr);
+    /* 获取一个提交条目并填好 user_data，tag 由使用者区分不同的请求 */
+    auto prepareSqe(uint64_t key, uint8_t tag) -> IoUring::Sqe*;
+    /* 取消该 key 下所有带 tag 的请求 */
+    void cancel(uint64_t key, uint8_t tag);
+    /* 接收缓冲区组，首次调用时创建 */
+    auto bufferGroup() -> BufferGroup&;
+    static uint8_t tagOf(const IoUring::Cqe&);
+
+private:
+    /* 每个 fd 在内核中的注册状态 */
+    struct Interest {
+        Event*   event      {nullptr};
+        uint32_t generation {0};        /* 每次重新注册都会改变，用于过滤过期的完成事件 */
+        uint32_t armed      {0};        /* 已在内核中注册的监听事件，0 表示未注册 */
+        uint32_t happened   {0};
+        uint32_t round      {0};        /* 最近一次就绪时的轮次，用于合并同一轮的完成事件 */
+        bool     dirty      {false};
+        bool     recheck    {false};    /* 是否存在尚未完成的电平检查 */
+        bool     removed    {false};    /* 本轮被移除过，fd 可能已关闭并被复用，必须重新注册 */
+    };
+
+    struct CompletionSlot {
+        Completion callback;
+        std::shared_ptr<void> keepAlive;
+        unsigned inflight {0};
+        bool active       {false};
+    };
+
+    auto interestOf(int fd) -> Interest&;
+    auto findInterest(int fd) -> Interest*;
+    void markDirty(int fd, Interest&);
+    void dispatchCompletions();
+    void flushChanges();
+    void submitRechecks();
+    void fillActiveEvents(EventList&);
+    void prepPollAdd(int fd, Interest&, bool oneshot);
+    void prepPollRemove(int fd, const Interest&, bool recheck);
+
+    IoUring ring_;
+    std::vector<Interest> interests_;   /* 以 fd 为下标 */
+    std::vector<int> changes_;          /* 本轮兴趣集发生变化的 fd */
+    std::vector<int> fired_;            /* 上一轮就绪的 fd */
+    uint32_t nextGeneration_ {0};
+    uint32_t round_          {0};
+
+    std::deque<CompletionSlot> slots_;  /* deque 保证回调执行期间新增 slot 不会使其失效 */
+    std::vector<uint32_t> freeSlots_;
+    std::vector<IoUring::Cqe> completions_;
+    std::unique_ptr<BufferGroup> bufferGroup_;
+};
+
+} /* namespace esynet::poller */
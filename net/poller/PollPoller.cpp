@@ -29,7 +29,7 @@ void PollPoller::updateEvent(Event& event) {
     if(event.index() < 0) {
         if(event.listenedEvent() < 0) return;
         /* 添加至列表 */
-        if(events_.find(event.fd()) != events_.end()) {
+        if(events_.find(event.fd())) {
             LOG_ERROR("Event(fd: {}) already exists", event.fd());
         }
         PollFd pfd;
@@ -38,12 +38,13 @@ void PollPoller::updateEvent(Event& event) {
         pfd.revents = 0;
         pollFds_.push_back(pfd);
         event.setIndex(pollFds_.size() - 1);
-        events_[pfd.fd] = &event;
+        events_.insert(pfd.fd, &event);
     } else {
         /* 更新列表 */
-        if(events_.find(event.fd()) == events_.end()) {
+        Event* registered = events_.find(event.fd());
+        if(!registered) {
             LOG_ERROR("Event(fd: {}) not exists", event.fd());
-        } else if(events_[event.fd()] != &event) {
+        } else if(registered != &event) {
             LOG_ERROR("Event(fd: {}) not the same", event.fd());
         }
         if(event.listenedEvent() < 0) {
@@ -57,6 +58,7 @@ void PollPoller::updateEvent(Event& event) {
 }
 
 void PollPoller::removeEvent(Event& event) {
+    if(event.index() < 0) return;
     events_.erase(event.fd());
     int index = event.index();
     if(index >= pollFds_.size() || index < 0) {
@@ -67,7 +69,7 @@ void PollPoller::removeEvent(Event& event) {
         int lastFd = pollFds_.back().fd;
         std::iter_swap(pollFds_.begin() + index, pollFds_.end() - 1);
         pollFds_.pop_back();
-        events_[lastFd]->setIndex(index);
+        events_.find(lastFd)->setIndex(index);
     }
     event.setIndex(-event.fd() - 1);
 }
@@ -75,10 +77,7 @@ void PollPoller::removeEvent(Event& event) {
 void PollPoller::fillActiveEvents(int numEvents, EventList& activeEvents) const {
     for(auto& pfd : pollFds_) {
         if(pfd.revents > 0) {
-            Event* event = events_.at(pfd.fd);
-            if(event->fd() != pfd.fd) {
-                LOG_ERROR("Event fd {} not equal to fd {}", event->fd(), pfd.fd);
-            }
+            Event* event = events_.find(pfd.fd);
             event->setHappenedEvent(pfd.revents);
             activeEvents.push_back(event);
             --numEvents;
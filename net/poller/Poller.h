@@ -1,8 +1,10 @@
 #pragma once
 
 /* Standard headers */
+#include <atomic>
 #include <vector>
-#include <map>
+#include <cstdint>
+#include <algorithm>
 
 /* Local headers */
 #include "utils/NonCopyable.h"
@@ -17,6 +19,33 @@ class Event;
 
 namespace esynet::poller {
 
+/* 以 fd 为下标的 Event 表，fd 由内核从小到大分配，因此表是稠密的，
+ * 查找只需一次数组访问 */
+class EventTable {
+public:
+    auto find(int fd) const -> Event* {
+        return fd >= 0 && static_cast<size_t>(fd) < events_.size() ? events_[fd] : nullptr;
+    }
+    void insert(int fd, Event* event) {
+        if(static_cast<size_t>(fd) >= events_.size()) {
+            events_.resize(std::max(static_cast<size_t>(fd) + 1, events_.size() * 2), nullptr);
+        }
+        if(!events_[fd]) ++size_;
+        events_[fd] = event;
+    }
+    void erase(int fd) {
+        if(find(fd)) {
+            events_[fd] = nullptr;
+            --size_;
+        }
+    }
+    auto size() const -> size_t { return size_; }
+
+private:
+    std::vector<Event*> events_;
+    size_t size_ {0};
+};
+
 class Poller : public utils::NonCopyable {
 public:
     using EventList = std::vector<Event*>;
@@ -29,11 +58,22 @@ public:
     virtual void updateEvent(Event&) = 0;
     virtual void removeEvent(Event&) = 0;
 
+    /* 线程安全，兴趣集变化的请求次数，以及实际提交给内核的次数（epoll_ctl 调用
+     * 或 io_uring 提交条目），两者之差为合并变化所节省的系统调用 */
+    auto numOfChanges() const -> uint64_t { return numOfChanges_.load(std::memory_order_relaxed); }
+    auto numOfCommits() const -> uint64_t { return numOfCommits_.load(std::memory_order_relaxed); }
+
 protected:
-    using EventMap = std::map<int, Event*>;
+    /* 仅由 Looper 所属线程写入 */
+    void countChange() { numOfChanges_.store(numOfChanges_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    void countCommit() { numOfCommits_.store(numOfCommits_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
 
     Looper& looper_;
-    EventMap events_;
+    EventTable events_;
+
+private:
+    std::atomic<uint64_t> numOfChanges_ {0};
+    std::atomic<uint64_t> numOfCommits_ {0};
 };
 
 } /* namespace esynet::poller */
\ No newline at end of file
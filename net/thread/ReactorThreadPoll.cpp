@@ -16,7 +16,7 @@ void ReactorThreadPoll::start() {
             /* 线程任务 */
             {
                 std::unique_lock<std::mutex> lock(mutex_);
-                reactors_.emplace_back(std::make_unique<Looper>());
+                reactors_.emplace_back(std::make_unique<Looper>(mainReactor_.backend()));
             }
             if(initCb_) {
                 initCb_(*reactors_.back());
@@ -65,6 +65,20 @@ std::vector<Looper*> ReactorThreadPoll::getAllReactors() {
     }
     return reactors;
 }
+size_t ReactorThreadPoll::indexOf(const Looper& looper) {
+    for(size_t i = 0; i < reactors_.size(); i++) {
+        if(reactors_[i].get() == &looper) return i;
+    }
+    return 0;
+}
+
+std::vector<esynet::LooperMetrics::Snapshot> ReactorThreadPoll::getAllMetrics() {
+    std::vector<LooperMetrics::Snapshot> metrics;
+    for(Looper* reactor : getAllReactors()) {
+        metrics.push_back(reactor->metrics());
+    }
+    return metrics;
+}
 
 void ReactorThreadPoll::setInitCallback(InitCallback cb) {
     initCb_ = std::move(cb);
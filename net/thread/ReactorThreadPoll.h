@@ -25,6 +25,10 @@ public:
     auto getNext()     -> Looper*;   /* 按顺序获取下一个 */
     auto getLightest() -> Looper*;   /* 获取负载最轻的一个 */
     auto getAllReactors() -> std::vector<Looper*>;
+    /* Looper 在 getAllReactors 中的下标，不属于线程池时返回 0 */
+    auto indexOf(const Looper&) -> size_t;
+    /* 所有 Looper 的统计快照，下标与 getAllReactors 一致 */
+    auto getAllMetrics() -> std::vector<LooperMetrics::Snapshot>;
 
     void setInitCallback(InitCallback);
     void setThreadNum(size_t);
@@ -8,8 +8,8 @@ std::atomic<Timer::ID> Timer::idCounter_(0);
 Timer::ID Timer::nextId() { return idCounter_++; }
 
 Timer::Timer(Callback callback, Timestamp expiration, double interval):
-        id_(nextId()), repeat_(interval > 0.0), callback_(callback),
-        interval_(interval), expiration_(expiration) {}
+        id_(nextId()), repeat_(interval > 0.0), expiration_(expiration),
+        interval_(interval), callback_(std::move(callback)) {}
 
 void Timer::run() {
     callback_();
@@ -23,5 +23,6 @@ void Timer::restart() {
 }
 
 Timestamp Timer::expiration() const { return expiration_; }
+double Timer::interval() const { return interval_; }
 bool Timer::repeat() const { return repeat_; }
 Timer::ID Timer::id() const { return id_; }
\ No newline at end of file
@@ -3,6 +3,7 @@
 /* Standard headers */
 #include <functional>
 #include <atomic>
+#include <cstdint>
 
 /* Local headers */
 #include "utils/Timestamp.h"
@@ -11,7 +12,17 @@ namespace esynet::timer {
 
 using utils::Timestamp;
 
-class Timer {
+class TimingWheel;
+class TimerQueue;
+
+/* 侵入式链表节点，时间轮的每个槽以哨兵节点构成双向循环链表，
+ * 跨线程提交定时器时复用 next 串入无锁队列 */
+struct TimerNode {
+    TimerNode* prev {nullptr};
+    TimerNode* next {nullptr};
+};
+
+class Timer : public TimerNode {
 public:
     using Callback = std::function<void()>;
     using ID = int64_t;
@@ -23,10 +34,14 @@ public:
     void restart();
 
     auto expiration() const -> Timestamp;
+    auto interval() const -> double;
     bool repeat() const;
     ID id() const;
 
 private:
+    friend class TimingWheel;
+    friend class TimerQueue;
+
     static std::atomic<ID> idCounter_;
     static ID nextId();
 
@@ -37,6 +52,11 @@ private:
     const double interval_; /* 单位：毫秒 */
     const Callback callback_;
 
+    /* 以下由 TimingWheel 与 TimerQueue 维护 */
+    uint64_t deadline_ {0};     /* 单调时钟刻度，单位：毫秒 */
+    int level_ {-1};            /* 所在时间轮的层级，-1 表示不在任何槽中 */
+    unsigned slot_ {0};
+    Timer* hashNext_ {nullptr}; /* ID 索引表中的下一个节点 */
 };
 
-} /* namespace esynet::timer */
\ No newline at end of file
+} /* namespace esynet::timer */
@@ -1,7 +1,13 @@
 #include "net/timer/TimerQueue.h"
 
+/* Standard headers */
+#include <cmath>
+#include <algorithm>
+
 /* Linux headers */
 #include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
 
 /* Local headers */
 #include "net/base/Looper.h"
@@ -9,25 +15,54 @@
 #include "utils/ErrorInfo.h"
 
 using esynet::timer::TimerQueue;
+using esynet::timer::TimerNode;
 using esynet::timer::Timer;
+using esynet::utils::Timestamp;
+
+static const int64_t kNanoSecondsPerTick = 1000 * 1000;
+static const size_t kInitialBuckets = 64;
+
+static int64_t monotonicNanoSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000 * kNanoSecondsPerTick + now.tv_nsec;
+}
+
+/* 将墙上时间表示的到期时间换算为单调时钟刻度，未来的时间向上取整保证不会提前触发，
+ * 已经到期的定时器取当前刻度，在下一次推进时间轮时立刻执行 */
+static uint64_t deadlineOf(Timestamp expiration) {
+    int64_t delay = static_cast<int64_t>((expiration - Timestamp::now()) * kNanoSecondsPerTick);
+    int64_t now = monotonicNanoSeconds();
+    if(delay <= 0) {
+        return static_cast<uint64_t>(now / kNanoSecondsPerTick);
+    }
+    return static_cast<uint64_t>((now + delay + kNanoSecondsPerTick - 1) / kNanoSecondsPerTick);
+}
+
+uint64_t TimerQueue::now() {
+    return static_cast<uint64_t>(monotonicNanoSeconds() / kNanoSecondsPerTick);
+}
 
 int TimerQueue::createTimerFd() {
-    int timerfd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    int timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
     if(timerfd < 0) {
         LOG_FATAL("Failed to create timerfd(err: {})", errnoStr(errno));
     }
     return timerfd;
 }
 
-/* 将超时时间更新为最近的超时时间 */
+/* 只有时间轮的下一个推进刻度变化时才调用 timerfd_settime */
 void TimerQueue::updateTimerFd() {
+    uint64_t next = wheel_.nextExpiry();
+    if(next == armedTick_) return;
+    armedTick_ = next;
+
     struct itimerspec closeTime;
     bzero(&closeTime, sizeof closeTime);
-
-    if(!timerMap_.empty()) {    /* 精度到微秒 */
-        auto latest = timerMap_.begin()->first;
-        closeTime.it_value.tv_sec = latest.secondsSinceEpoch();
-        closeTime.it_value.tv_nsec = latest.microSecondsSinceEpoch() % Timestamp::kMicroSecondsPerSecond * 1000;
+    if(next != TimingWheel::kNever) {
+        closeTime.it_value.tv_sec = next / 1000;
+        closeTime.it_value.tv_nsec = next % 1000 * kNanoSecondsPerTick;
+        if(next == 0) closeTime.it_value.tv_nsec = 1;   /* 全零表示解除定时 */
     }
     if(timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &closeTime, nullptr) == -1) {
         LOG_ERROR("Failed to set timerfd(err: {})", errnoStr(errno));
@@ -35,65 +70,156 @@ void TimerQueue::updateTimerFd() {
 }
 
 TimerQueue::TimerQueue(Looper& looper):
-                looper_(looper),
                 timerFd_(createTimerFd()),
-                timerEvent_(looper, timerFd_) {
+                looper_(looper),
+                timerEvent_(looper, timerFd_),
+                wheel_(now()) {
     timerEvent_.setReadCallback(std::bind(&TimerQueue::handle, this));
     timerEvent_.enableRead();
 }
 TimerQueue::~TimerQueue() {
     looper_.removeEvent(timerEvent_);
     close(timerFd_);
+    for(TimerNode* node = submissions_.popAll(); node;) {
+        TimerNode* next = node->next;
+        delete static_cast<Timer*>(node);
+        node = next;
+    }
+    for(Timer* timer : buckets_) {
+        while(timer) {
+            Timer* next = timer->hashNext_;
+            delete timer;
+            timer = next;
+        }
+    }
 }
 
+/* Looper 线程内直接放入时间轮，其他线程经无锁队列提交，
+ * 只有使队列由空变为非空的那一次提交需要通知 Looper */
 Timer::ID TimerQueue::addTimer(Timer::Callback callback, Timestamp expiration, double interval) {
-    TimerPtr tp = std::make_unique<Timer>(callback, expiration, interval);
-    Timer::ID id = tp->id();
-
-    looper_.run([this, expiration, &tp] {
-        timerMap_[expiration] = std::move(tp);
-        timerPositionMap_[timerMap_[expiration]->id()] = expiration;
-        updateTimerFd();
-    });
+    Timer* timer = new Timer(std::move(callback), expiration, interval);
+    timer->deadline_ = deadlineOf(expiration);
+    Timer::ID id = timer->id();
 
+    if(looper_.isInLoopThread()) {
+        schedule(timer);
+    } else if(submissions_.push(timer)) {
+        looper_.queue([this] { drainSubmissions(); });
+    }
     return id;
 }
 void TimerQueue::cancel(Timer::ID id) {
-    looper_.run([this, id] {
-        auto iter = timerPositionMap_.find(id);
-        if(iter != timerPositionMap_.end()) {
-            timerMap_.erase(iter->second);
-            timerPositionMap_.erase(id);
-            updateTimerFd();
-        }
-    });
+    looper_.run([this, id] { cancelInLoop(id); });
 }
 
+esynet::Event& TimerQueue::event() { return timerEvent_; }
+size_t TimerQueue::size() const { return wheel_.size(); }
+
 void TimerQueue::handle() {
-    TimerList expiredList = getExpired(Timestamp::now());
-    LOG_DEBUG("{} timers expired", expiredList.size());
-    for(auto& timer : expiredList) {
-        timer->run();
-
-        /* 维护 timerMap_ 和 timerPositionMap_
-         * 删除过期 Timer 以及重新注册周期 Timer */
-        TimerPtr temp = std::move(timerMap_[timer->expiration()]);
-        timerMap_.erase(temp->expiration());
-        if(temp->repeat()) {
-            temp->restart();
-            timerPositionMap_[temp->id()] = temp->expiration();
-            timerMap_[temp->expiration()] = std::move(temp);
-        } else {
-            timerPositionMap_.erase(temp->id());
-        }
+    uint64_t expirations;
+    if(::read(timerFd_, &expirations, sizeof expirations) < 0 && errno != EAGAIN) {
+        LOG_ERROR("Failed to read timerfd(err: {})", errnoStr(errno));
     }
+    handling_ = true;
+    drainSubmissions();
+    uint64_t tick = now();
+    size_t count = 0;
+    while(Timer* timer = wheel_.popExpired(tick)) {
+        expire(timer);
+        ++count;
+    }
+    handling_ = false;
+    LOG_DEBUG("{} timers expired", count);
     updateTimerFd();
 }
-TimerQueue::TimerList TimerQueue::getExpired(Timestamp now) const {
-    TimerList expiredList;
-    auto iter = timerMap_.begin();
-    for(; iter != timerMap_.end() && !(iter->first > now); ++iter) {
-        expiredList.push_back(iter->second.get());
+
+void TimerQueue::schedule(Timer* timer) {
+    insertIndex(timer);
+    wheel_.insert(timer, timer->deadline_);
+    if(!handling_ && timer->deadline_ < armedTick_) {
+        updateTimerFd();
+    }
+}
+/* 取消前先接收其他线程已提交的定时器，保证先添加后取消的顺序 */
+void TimerQueue::cancelInLoop(Timer::ID id) {
+    drainSubmissions();
+    Timer* timer = find(id);
+    if(!timer) return;
+    eraseIndex(timer);
+    if(timer == running_) {
+        runningCanceled_ = true;
+    } else {
+        wheel_.remove(timer);
+        delete timer;
+    }
+}
+void TimerQueue::drainSubmissions() {
+    TimerNode* node = submissions_.popAll();
+    while(node) {
+        TimerNode* next = node->next;
+        node->next = nullptr;
+        schedule(static_cast<Timer*>(node));
+        node = next;
+    }
+}
+
+/* 执行回调，周期定时器以上次的到期刻度为基准重新放入时间轮，避免取整误差累积，
+ * 已经落后（例如回调阻塞过久）时改为从当前时间起算 */
+void TimerQueue::expire(Timer* timer) {
+    running_ = timer;
+    runningCanceled_ = false;
+    timer->run();
+    running_ = nullptr;
+
+    if(timer->repeat() && !runningCanceled_) {
+        timer->restart();
+        uint64_t interval = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(timer->interval())), 1);
+        uint64_t deadline = timer->deadline_ + interval;
+        if(deadline < wheel_.current()) {
+            deadline = now() + interval;
+        }
+        wheel_.insert(timer, deadline);
+    } else {
+        if(!runningCanceled_) {
+            eraseIndex(timer);
+        }
+        delete timer;
+    }
+}
+
+Timer* TimerQueue::find(Timer::ID id) const {
+    if(buckets_.empty()) return nullptr;
+    Timer* timer = buckets_[id & (buckets_.size() - 1)];
+    while(timer && timer->id_ != id) {
+        timer = timer->hashNext_;
     }
-    return expiredList;
-}
\ No newline at end of file
+    return timer;
+}
+void TimerQueue::insertIndex(Timer* timer) {
+    if(numOfTimers_ >= buckets_.size()) {
+        TimerList buckets(std::max(buckets_.size() * 2, kInitialBuckets), nullptr);
+        for(Timer* head : buckets_) {
+            while(head) {
+                Timer* next = head->hashNext_;
+                Timer*& bucket = buckets[head->id_ & (buckets.size() - 1)];
+                head->hashNext_ = bucket;
+                bucket = head;
+                head = next;
+            }
+        }
+        buckets_.swap(buckets);
+    }
+    Timer*& bucket = buckets_[timer->id_ & (buckets_.size() - 1)];
+    timer->hashNext_ = bucket;
+    bucket = timer;
+    ++numOfTimers_;
+}
+void TimerQueue::eraseIndex(Timer* timer) {
+    Timer** link = &buckets_[timer->id_ & (buckets_.size() - 1)];
+    while(*link != timer) {
+        link = &(*link)->hashNext_;
+    }
+    *link = timer->hashNext_;
+    timer->hashNext_ = nullptr;
+    --numOfTimers_;
+}
@@ -2,44 +2,70 @@
 
 /* Standard headers */
 #include <vector>
-#include <map>
+#include <cstdint>
 
 /* Local headers */
 #include "net/timer/Timer.h"
+#include "net/timer/TimingWheel.h"
 #include "net/base/Event.h"
+#include "utils/MpscQueue.h"
 
 namespace esynet::timer {
 
 /* 负责定时器任务的注册、回调、管理，不保证回调
- * 函数一定会准时执行，有可能会因为繁忙而延后 */
+ * 函数一定会准时执行，有可能会因为繁忙而延后
+ *
+ * 定时器按 CLOCK_MONOTONIC 的毫秒刻度挂在分层时间轮上，添加与取消均为 O(1)；
+ * 其他线程添加的定时器经无锁队列交给 Looper 线程，timerfd 只在最早到期时间
+ * 变化时才重新设置 */
 class TimerQueue {
 public:
-    using TimerPtr         = std::unique_ptr<Timer>;
-    using TimerList        = std::vector<Timer*>;
-    using TimerMap         = std::map<Timestamp, TimerPtr>; /* 有序表，按到期时间从小到大排序 */
-    using TimerPositionMap = std::map<Timer::ID, Timestamp>;
+    using TimerList = std::vector<Timer*>;
 
 public:
     TimerQueue(Looper&);
     ~TimerQueue();
 
+    /* 线程安全 */
     auto addTimer(Timer::Callback, Timestamp expiration, double interval) -> Timer::ID;
     void cancel(Timer::ID);
 
     /* 由 Looper 调用 */
     void handle();
+    auto event() -> Event&;
+    auto size() const -> size_t;    /* 已交给时间轮的定时器数 */
+
+    /* 单调时钟的当前刻度，单位：毫秒 */
+    static auto now() -> uint64_t;
 
 private:
-    auto getExpired(Timestamp now) const -> TimerList; /* 获取所有超时事件 */
-    int createTimerFd();
+    using SubmitQueue = utils::MpscQueue<TimerNode>;
+
+    void schedule(Timer*);
+    void cancelInLoop(Timer::ID);
+    void drainSubmissions();
+    void expire(Timer*);
     void updateTimerFd();
 
+    /* ID -> Timer 的侵入式哈希表，ID 连续递增，以低位作为桶下标 */
+    auto find(Timer::ID) const -> Timer*;
+    void insertIndex(Timer*);
+    void eraseIndex(Timer*);
+
+    int createTimerFd();
+
 private:
     int timerFd_;
     Looper& looper_;
     Event timerEvent_;
-    TimerMap timerMap_;
-    TimerPositionMap timerPositionMap_; /* 记录Timer在timerMap_中的位置用于取消 */
+    TimingWheel wheel_;
+    SubmitQueue submissions_;
+    TimerList buckets_;
+    size_t numOfTimers_ {0};
+    uint64_t armedTick_ {TimingWheel::kNever};
+    Timer* running_ {nullptr};      /* 正在执行回调的定时器 */
+    bool runningCanceled_ {false};
+    bool handling_ {false};
 };
 
-} /* namespace esynet::timer */
\ No newline at end of file
+} /* namespace esynet::timer */
@@ -0,0 +1,174 @@
+#include "net/timer/TimingWheel.h"
+
+/* Standard headers */
+#include <algorithm>
+
+using esynet::timer::TimingWheel;
+using esynet::timer::TimerNode;
+using esynet::timer::Timer;
+
+/* 各层的起始位移与槽数：256/64/64/64 */
+static const unsigned kShifts[TimingWheel::kLevels] = { 0, 8, 14, 20 };
+static const unsigned kSlots[TimingWheel::kLevels]  = { 256, 64, 64, 64 };
+
+/* 在 bits 位的循环位图中查找从 start 起的第一个置位，返回相对 start 的偏移，不存在时返回 -1 */
+static int findNextSet(const std::array<uint64_t, 4>& words, unsigned bits, unsigned start) {
+    unsigned numWords = bits / 64;
+    unsigned index = start / 64;
+    uint64_t word = words[index] & (~0ULL << (start % 64));
+    for(unsigned i = 0; i <= numWords; ++i) {
+        if(word) {
+            unsigned position = index * 64 + __builtin_ctzll(word);
+            return static_cast<int>((position - start) & (bits - 1));
+        }
+        index = (index + 1) % numWords;
+        word = words[index];
+    }
+    return -1;
+}
+
+TimingWheel::TimingWheel(uint64_t now): current_(now) {
+    for(int i = 0; i < kLevels; ++i) {
+        Level& level = levels_[i];
+        level.shift = kShifts[i];
+        level.mask = kSlots[i] - 1;
+        level.slots.resize(kSlots[i]);
+        for(TimerNode& head : level.slots) {
+            head.prev = head.next = &head;
+        }
+    }
+    pending_.prev = pending_.next = &pending_;
+}
+
+void TimingWheel::link(TimerNode& head, Timer* timer) {
+    timer->prev = head.prev;
+    timer->next = &head;
+    head.prev->next = timer;
+    head.prev = timer;
+}
+void TimingWheel::unlink(Timer* timer) {
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->prev = timer->next = nullptr;
+    timer->level_ = -1;
+}
+
+void TimingWheel::insert(Timer* timer, uint64_t deadline) {
+    timer->deadline_ = deadline;
+    place(timer);
+    ++size_;
+}
+void TimingWheel::remove(Timer* timer) {
+    if(!timer->prev) return;
+    int index = timer->level_;
+    unsigned slot = timer->slot_;
+    unlink(timer);
+    --size_;
+    if(index >= 0) {
+        Level& level = levels_[index];
+        TimerNode& head = level.slots[slot];
+        if(head.next == &head) {
+            level.occupied[slot / 64] &= ~(1ULL << (slot % 64));
+        }
+    }
+}
+
+/* 按距离当前刻度的远近选择层级，超出覆盖范围的先放在最高层的最远槽 */
+void TimingWheel::place(Timer* timer) {
+    uint64_t deadline = std::max(timer->deadline_, current_);
+    uint64_t delta = deadline - current_;
+    int index = 0;
+    while(index < kLevels - 1 && delta >= (static_cast<uint64_t>(kSlots[index]) << kShifts[index])) {
+        ++index;
+    }
+    Level& level = levels_[index];
+    uint64_t span = static_cast<uint64_t>(level.mask + 1) << level.shift;
+    if(delta >= span) {
+        deadline = current_ + span - 1;
+    }
+    unsigned slot = (deadline >> level.shift) & level.mask;
+    timer->level_ = index;
+    timer->slot_ = slot;
+    link(level.slots[slot], timer);
+    level.occupied[slot / 64] |= 1ULL << (slot % 64);
+}
+
+/* 将高层槽中的定时器按剩余时间重新放置到低层 */
+void TimingWheel::cascade(Level& level, unsigned slot) {
+    TimerNode& head = level.slots[slot];
+    TimerNode list;
+    list.prev = list.next = &list;
+    while(head.next != &head) {
+        Timer* timer = static_cast<Timer*>(head.next);
+        unlink(timer);
+        link(list, timer);
+    }
+    level.occupied[slot / 64] &= ~(1ULL << (slot % 64));
+    while(list.next != &list) {
+        Timer* timer = static_cast<Timer*>(list.next);
+        unlink(timer);
+        place(timer);
+    }
+}
+
+/* 处理 current_ 这一刻度：必要时逐层降级，然后将第 0 层对应槽移入 pending_ */
+void TimingWheel::tick() {
+    for(int i = 1; i < kLevels; ++i) {
+        Level& level = levels_[i];
+        if(current_ & ((1ULL << level.shift) - 1)) break;
+        cascade(level, (current_ >> level.shift) & level.mask);
+    }
+    Level& level = levels_[0];
+    unsigned slot = current_ & level.mask;
+    TimerNode& head = level.slots[slot];
+    while(head.next != &head) {
+        Timer* timer = static_cast<Timer*>(head.next);
+        unlink(timer);
+        link(pending_, timer);
+    }
+    level.occupied[slot / 64] &= ~(1ULL << (slot % 64));
+    ++current_;
+}
+
+Timer* TimingWheel::popExpired(uint64_t now) {
+    while(pending_.next == &pending_) {
+        if(current_ > now) return nullptr;
+        /* 跳过中间没有任何定时器的刻度 */
+        uint64_t next = nextExpiry();
+        if(next > now) {
+            current_ = now + 1;
+            return nullptr;
+        }
+        current_ = next;
+        tick();
+    }
+    Timer* timer = static_cast<Timer*>(pending_.next);
+    unlink(timer);
+    --size_;
+    return timer;
+}
+
+uint64_t TimingWheel::nextExpiry() const {
+    if(size_ == 0) return kNever;
+    if(pending_.next != &pending_) return current_ - 1;
+
+    uint64_t next = kNever;
+    const Level& wheel = levels_[0];
+    int offset = findNextSet(wheel.occupied, wheel.mask + 1, current_ & wheel.mask);
+    if(offset >= 0) {
+        next = current_ + offset;
+    }
+    /* 高层槽在其覆盖范围的起点降级 */
+    for(int i = 1; i < kLevels; ++i) {
+        const Level& level = levels_[i];
+        uint64_t aligned = (current_ + (1ULL << level.shift) - 1) >> level.shift;
+        offset = findNextSet(level.occupied, level.mask + 1, aligned & level.mask);
+        if(offset >= 0) {
+            next = std::min(next, (aligned + offset) << level.shift);
+        }
+    }
+    return next;
+}
+
+uint64_t TimingWheel::current() const { return current_; }
+size_t TimingWheel::size() const { return size_; }
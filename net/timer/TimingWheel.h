@@ -0,0 +1,61 @@
+#pragma once
+
+/* Standard headers */
+#include <array>
+#include <vector>
+#include <cstdint>
+
+/* Local headers */
+#include "net/timer/Timer.h"
+#include "utils/NonCopyable.h"
+
+namespace esynet::timer {
+
+/* 分层时间轮，各层槽数为 256/64/64/64，一个刻度为 1 毫秒，可覆盖约 18.6 小时，
+ * 更远的定时器先挂在最高层的最远槽中，降级时再按真实到期刻度重新放置
+ *
+ * 插入与删除均为 O(1)，节点由 Timer 自身提供（侵入式），时间轮不负责定时器的内存
+ * 非线程安全，仅由所属 Looper 线程使用 */
+class TimingWheel : public utils::NonCopyable {
+public:
+    static const int kLevels = 4;
+    static const uint64_t kNever = UINT64_MAX;
+
+public:
+    explicit TimingWheel(uint64_t now);
+
+    /* 到期刻度早于当前刻度的定时器在下一个刻度到期 */
+    void insert(Timer*, uint64_t deadline);
+    void remove(Timer*);
+
+    /* 依次取出到期刻度不晚于 now 的定时器，全部取出后返回 nullptr，
+     * 两次调用之间可以插入或删除其他定时器 */
+    auto popExpired(uint64_t now) -> Timer*;
+    /* 下一次需要推进时间轮的刻度（槽内定时器到期或高层槽降级），为空时返回 kNever */
+    auto nextExpiry() const -> uint64_t;
+
+    auto current() const -> uint64_t;
+    auto size() const -> size_t;
+
+private:
+    struct Level {
+        unsigned shift;
+        unsigned mask;
+        std::vector<TimerNode> slots;   /* 各槽的哨兵节点 */
+        std::array<uint64_t, 4> occupied {};
+    };
+
+    void place(Timer*);
+    void tick();
+    void cascade(Level&, unsigned slot);
+
+    static void link(TimerNode& head, Timer*);
+    static void unlink(Timer*);
+
+    std::array<Level, kLevels> levels_;
+    TimerNode pending_;     /* 当前刻度已到期、尚未取出的定时器 */
+    uint64_t current_;      /* 下一个待处理的刻度 */
+    size_t size_ {0};
+};
+
+} /* namespace esynet::timer */
@@ -0,0 +1,161 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kEchoPort  = 24689;
+const int kEvictPort = 24692;
+const size_t kHighWaterMark = 256_KB;
+const size_t kLowWaterMark  = 64_KB;
+const size_t kTotalBytes    = 32_MB;
+
+static char patternAt(size_t pos) {
+    return static_cast<char>(pos % 251);
+}
+
+/* 对端只写不读时，回显服务器在发送缓冲区超过高水位后暂停读取，内存占用保持有界；
+ * 对端开始读取后恢复，所有数据按顺序回显 */
+/* 每种模式使用不同的端口，避免与上一个服务器的监听套接字冲突 */
+static void runEcho(int port, Looper::Backend backend, TcpConnection::IoMode mode, bool edgeTriggered, size_t maxFootprint) {
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<size_t> peakPending{0};
+    std::atomic<bool> paused{false};
+    std::thread serverThread([&] {
+        TcpServer echo(port, "Backpressure", backend);
+        echo.setThreadNumInPool(1);
+        echo.setIoMode(mode);
+        echo.setEdgeTriggered(edgeTriggered);
+        echo.setFlowControl({ kHighWaterMark, kLowWaterMark, 0.0 });
+        echo.setMessageCallback([&](TcpConnection& conn, utils::Buffer& buffer, utils::Timestamp) {
+            conn.send(buffer.retrieveAllAsString());
+            if(conn.bufferFootprint() > peakPending) peakPending = conn.bufferFootprint();
+            if(conn.isReadingPaused()) paused = true;
+        });
+        server = &echo;
+        ready = true;
+        echo.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int fd = connectTo(port);
+    REQUIRE(fd >= 0);
+    std::atomic<size_t> written{0};
+    std::thread writer([&] {
+        std::string chunk(64_KB, '\0');
+        while(written < kTotalBytes) {
+            size_t len = std::min(chunk.size(), kTotalBytes - written);
+            for(size_t i = 0; i < len; ++i) chunk[i] = patternAt(written + i);
+            ssize_t n = ::send(fd, chunk.data(), len, MSG_NOSIGNAL);
+            if(n <= 0) break;
+            written += n;
+        }
+    });
+
+    /* 不读取时双方的套接字缓冲区填满后服务器暂停读取，之后写入停滞 */
+    CHECK(waitFor([&] { return paused.load(); }, 10000));
+    size_t stalled = 0;
+    CHECK(waitFor([&] {
+        size_t before = written;
+        std::this_thread::sleep_for(milliseconds(200));
+        stalled = written;
+        return stalled == before;
+    }, 10000));
+    CHECK(stalled < kTotalBytes);
+
+    /* 开始读取后全部回显 */
+    std::string chunk(64_KB, '\0');
+    size_t received = 0;
+    bool intact = true;
+    while(received < kTotalBytes) {
+        ssize_t n = ::read(fd, chunk.data(), chunk.size());
+        if(n <= 0) break;
+        for(ssize_t i = 0; i < n && intact; ++i) {
+            if(chunk[i] != patternAt(received + i)) intact = false;
+        }
+        received += n;
+    }
+    writer.join();
+    CHECK(written == kTotalBytes);
+    CHECK(received == kTotalBytes);
+    CHECK(intact);
+    /* 缓冲区占用远小于对端写入的总量 */
+    CHECK(peakPending < maxFootprint);
+
+    ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
+
+TEST_CASE("Backpressure_Test"){
+    Logger::setLogger([](const std::string&) {});
+    /* 就绪模式下发送缓冲区不超过高水位加上一次读取的数据量 */
+    SUBCASE("LevelTriggered") {
+        runEcho(kEchoPort, Looper::kEpoll, TcpConnection::kReadiness, false, 2_MB);
+    }
+    SUBCASE("EdgeTriggered") {
+        runEcho(kEchoPort + 1, Looper::kEpoll, TcpConnection::kReadiness, true, 2_MB);
+    }
+    /* 完成模式下内核在取消生效之前已经收下的数据仍会进入读缓冲区 */
+    SUBCASE("Completion") {
+        runEcho(kEchoPort + 2, Looper::kIoUring, TcpConnection::kCompletion, false, 16_MB);
+    }
+}
+
+/* 持续超过高水位达到期限的慢速消费者被强制关闭 */
+TEST_CASE("Eviction_Test"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<bool> closed{false};
+    std::thread serverThread([&] {
+        TcpServer evict(kEvictPort, "Eviction");
+        evict.setThreadNumInPool(1);
+        evict.setFlowControl({ kHighWaterMark, kLowWaterMark, 100.0 });
+        evict.setCloseCallback([&closed](TcpConnection&) { closed = true; });
+        evict.setMessageCallback([](TcpConnection& conn, utils::Buffer& buffer, utils::Timestamp) {
+            conn.send(buffer.retrieveAllAsString());
+        });
+        server = &evict;
+        ready = true;
+        evict.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int fd = connectTo(kEvictPort);
+    REQUIRE(fd >= 0);
+    std::thread writer([fd] {
+        std::string chunk(64_KB, 'e');
+        for(size_t written = 0; written < kTotalBytes; ) {
+            ssize_t n = ::send(fd, chunk.data(), chunk.size(), MSG_NOSIGNAL);
+            if(n <= 0) break;
+            written += n;
+        }
+    });
+
+    CHECK(waitFor([&] { return closed.load(); }, 10000));
+    /* 服务器关闭连接后对端读到错误或结束 */
+    std::string chunk(64_KB, '\0');
+    ssize_t n;
+    while((n = ::read(fd, chunk.data(), chunk.size())) > 0) {}
+    CHECK(n <= 0);
+    ::shutdown(fd, SHUT_RDWR);
+    writer.join();
+
+    ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
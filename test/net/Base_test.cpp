@@ -2,9 +2,11 @@
 #define DOCTEST_CONFIG_COLORS_ANSI
 #include <doctest/doctest.h>
 #include <thread>
+#include <poll.h>
 #include <sys/stat.h>
 #include "net/base/Socket.h"
 #include "net/base/NetAddress.h"
+#include "exception/NetworkException.h"
 
 using namespace esynet;
 using namespace esynet::utils;
@@ -28,40 +30,38 @@ TEST_CASE("InetAddress_Test"){
 }
 
 TEST_CASE("Socket_Test"){
-    std::thread client([] {
-        sleep(1);
-        Socket client;
-        NetAddress addr("127.0.0.1", 8888);
-        auto ret = client.connect(addr);
-    });
-
-    Socket sock;
-
     int sockfd = socket(AF_INET, SOCK_STREAM, 0);
     Socket sock2(sockfd);
-
     CHECK(sock2.fd() == sockfd);
-    NetAddress local(8888);
+    sock2.close();
+
+    Socket sock;
+    NetAddress local("127.0.0.1", 8888);
+    sock.setReuseAddr(true);
     sock.bind(local);
     sock.listen();
-    NetAddress peerAddr(-1);
-    auto ret = sock.accept(peerAddr);
-    CHECK(peerAddr.ip() == "0.0.0.0");
-    CHECK(peerAddr.port() == 8888);
 
-    client.join();
-    int temp;
-    struct stat s;
-    {
-        Socket s1;
-        temp = s1.fd();
-        CHECK(fstat(s1.fd(), &s) != -1);
-
-        Socket s2 = s1;
-        Socket s3 = std::move(s2);
-        Socket s4(s1);
-        Socket s5(std::move(s1));
-        CHECK(fstat(s5.fd(), &s) != -1);
+    /* Socket 是非阻塞的，连接在后台完成，等监听套接字可读后再 accept */
+    Socket client;
+    try {
+        client.connect(local);
+    } catch(exception::NetworkException& e) {
+        CHECK(e.err() == EINPROGRESS);
     }
-    CHECK(fstat(temp, &s) == -1);
-}
\ No newline at end of file
+    struct pollfd pfd { sock.fd(), POLLIN, 0 };
+    REQUIRE(::poll(&pfd, 1, 1000) == 1);
+    NetAddress peerAddr;
+    Socket conn = sock.accept(peerAddr);
+    CHECK(peerAddr.ip() == "127.0.0.1");
+    CHECK(peerAddr.port() == NetAddress::getLocalAddr(client)->port());
+
+    /* 副本共享同一个描述符，close 之后所有副本都失效 */
+    struct stat s;
+    Socket copy = conn;
+    CHECK(copy.fd() == conn.fd());
+    CHECK(fstat(copy.fd(), &s) != -1);
+    conn.close();
+    CHECK(fstat(copy.fd(), &s) == -1);
+    client.close();
+    sock.close();
+}
@@ -0,0 +1,92 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "utils/SharedPayload.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPort = 24686;
+const int kClients = 8;
+const size_t kPayloadSize = 64_KB;
+
+TEST_CASE("SharedPayload_Test"){
+    std::string message(100, 's');
+    utils::SharedPayload payload(message);
+    CHECK(payload.size() == 100);
+    CHECK(payload.view() == utils::StringPiece(message));
+    CHECK(payload.data() != message.data());
+
+    utils::SharedPayload copy = payload;
+    auto owner = copy.owner();
+    CHECK(copy.data() == payload.data());
+    CHECK(payload.useCount() == 3);
+    owner.reset();
+    CHECK(payload.useCount() == 2);
+    CHECK(utils::SharedPayload().empty());
+}
+
+/* 同一份数据广播给分布在两个 Looper 上的连接，filter 排除一半连接 */
+TEST_CASE("Broadcast_Test"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<int> connected{0};
+    std::thread serverThread([&] {
+        TcpServer broadcast(kPort, "Broadcast");
+        broadcast.setThreadNumInPool(2);
+        broadcast.setConnectionCallback([&connected](TcpConnection& conn) {
+            if(conn.connected()) {
+                conn.setContext(connected++);
+            }
+        });
+        server = &broadcast;
+        ready = true;
+        broadcast.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    std::vector<int> clients;
+    for(int i = 0; i < kClients; ++i) {
+        clients.push_back(connectTo(kPort));
+        REQUIRE(clients.back() >= 0);
+        /* 按连接顺序编号，filter 以此区分 */
+        REQUIRE(waitFor([&] { return connected == i + 1; }));
+    }
+
+    std::string content(kPayloadSize, '\0');
+    for(size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>(i * 31 % 251);
+    }
+    utils::SharedPayload payload(content);
+    server->broadcast(payload, [](const TcpConnection& conn) {
+        return std::any_cast<int>(conn.getContext()) % 2 == 0;
+    });
+    utils::SharedPayload ending("end");
+    server->broadcast(ending);
+
+    for(int i = 0; i < kClients; ++i) {
+        if(i % 2 == 0) {
+            CHECK(readExactly(clients[i], kPayloadSize) == content);
+        }
+        CHECK(readExactly(clients[i], 3) == "end");
+    }
+    /* 全部发送完成后只剩下本地的引用 */
+    CHECK(waitFor([&] { return payload.useCount() == 1; }));
+
+    for(int fd : clients) ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
@@ -0,0 +1,73 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPort = 24681;
+const size_t kMessageSize = 512_KB;
+
+TEST_CASE("BufferShrink_Test"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<TcpConnection*> connection{nullptr};
+    std::atomic<size_t> received{0};
+    std::thread serverThread([&] {
+        TcpServer shrink(kPort, "Shrink");
+        shrink.setThreadNumInPool(1);
+        shrink.setShrinkPolicy({ 4_KB, 4, 0.25, 50.0 });
+        shrink.setConnectionCallback([&connection](TcpConnection& conn) {
+            connection = conn.connected() ? &conn : nullptr;
+        });
+        /* 凑齐一整条大消息后才取走，读缓冲区会随之增长 */
+        shrink.setMessageCallback([&received](TcpConnection&, utils::Buffer& buffer, utils::Timestamp) {
+            if(buffer.readableBytes() >= kMessageSize) {
+                received += buffer.readableBytes();
+                buffer.retrieveAll();
+            }
+        });
+        shrink.setCloseCallback([&connection](TcpConnection&) { connection = nullptr; });
+        server = &shrink;
+        ready = true;
+        shrink.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int fd = connectTo(kPort);
+    REQUIRE(fd >= 0);
+    REQUIRE(waitFor([&] { return connection.load() != nullptr; }));
+    auto bufferBytes = [&] { return server->threadPoll().getAllMetrics().at(0).bufferBytes; };
+
+    std::string message(kMessageSize, 'm');
+    size_t sent = 0;
+    while(sent < message.size()) {
+        ssize_t n = ::write(fd, message.data() + sent, message.size() - sent);
+        REQUIRE(n > 0);
+        sent += n;
+    }
+    REQUIRE(waitFor([&] { return received == kMessageSize; }));
+
+    /* 大消息处理完后读缓冲区仍然很大，空闲一段时间后收缩 */
+    CHECK(waitFor([&] { return connection.load()->bufferFootprint() <= 16_KB; }));
+    CHECK(bufferBytes() == connection.load()->bufferFootprint());
+
+    /* 连接析构后不再计入 */
+    ::close(fd);
+    CHECK(waitFor([&] { return bufferBytes() == 0; }));
+
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
@@ -0,0 +1,218 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "net/TcpServer.h"
+#include "net/codec/LengthFieldCodec.h"
+#include "net/codec/LineCodec.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::codec;
+using esynet::utils::Buffer;
+using esynet::test::connectTo;
+using esynet::test::readExactly;
+using esynet::test::waitFor;
+
+const int kPort = 24702;
+
+/* 依次解码缓冲区中的全部完整帧 */
+static std::vector<std::string> decodeAll(const Codec& codec, Buffer& buffer, Codec::Result& last) {
+    std::vector<std::string> frames;
+    Codec::Frame frame;
+    while((last = codec.decode(buffer, frame)) == Codec::kFrame) {
+        frames.push_back(frame.payload.asString());
+        buffer.retrieve(frame.length);
+    }
+    return frames;
+}
+
+TEST_CASE("LengthFieldCodec_Test"){
+    Logger::setLogger([](const std::string&) {});
+    SUBCASE("RoundTrip") {
+        for(int size : { 1, 2, 4, 8 }) {
+            LengthFieldCodec codec(size, 200);
+            Buffer stream;
+            for(const std::string& payload : std::vector<std::string> { "", "a", "hello", std::string(200, 'x') }) {
+                Buffer frame;
+                frame.append(payload);
+                const char* address = frame.beginRead();
+                codec.encode(frame);
+                /* 帧头写入 prepend 区，载荷没有移动 */
+                CHECK(frame.beginRead() + size == address);
+                CHECK(frame.readableBytes() == size + payload.size());
+                stream.append(frame.beginRead(), frame.readableBytes());
+            }
+            Codec::Result last;
+            auto frames = decodeAll(codec, stream, last);
+            CHECK(last == Codec::kIncomplete);
+            REQUIRE(frames.size() == 4);
+            CHECK(frames[0] == "");
+            CHECK(frames[2] == "hello");
+            CHECK(frames[3] == std::string(200, 'x'));
+        }
+    }
+    SUBCASE("NetworkOrder") {
+        LengthFieldCodec codec(2);
+        Buffer buffer;
+        buffer.append(std::string(258, 'n'));
+        codec.encode(buffer);
+        CHECK(static_cast<uint8_t>(buffer.beginRead()[0]) == 1);
+        CHECK(static_cast<uint8_t>(buffer.beginRead()[1]) == 2);
+    }
+    SUBCASE("Partial") {
+        /* 帧头到达后预留整帧空间，载荷视图指向缓冲区内部 */
+        LengthFieldCodec codec(4);
+        Buffer frame;
+        frame.append(std::string(100_KB, 'p'));
+        codec.encode(frame);
+
+        Buffer buffer;
+        buffer.append(frame.beginRead(), 3);
+        Codec::Frame decoded;
+        CHECK(codec.decode(buffer, decoded) == Codec::kIncomplete);
+        buffer.append(frame.beginRead() + 3, 1);
+        CHECK(codec.decode(buffer, decoded) == Codec::kIncomplete);
+        CHECK(buffer.writableBytes() >= LengthFieldCodec::kDefaultMaxReserve);
+        /* 连接收缩读缓冲区时保留预留的空间 */
+        buffer.shrink(0);
+        CHECK(buffer.writableBytes() >= LengthFieldCodec::kDefaultMaxReserve);
+        buffer.append(frame.beginRead() + 4, frame.readableBytes() - 4);
+        REQUIRE(codec.decode(buffer, decoded) == Codec::kFrame);
+        CHECK(decoded.payload.data() == buffer.beginRead() + 4);
+        CHECK(decoded.payload.size() == 100_KB);
+        CHECK(decoded.length == 100_KB + 4);
+        /* 整帧取走后预留失效，可以正常收缩 */
+        buffer.retrieve(decoded.length);
+        buffer.shrink(0);
+        CHECK(buffer.capacity() < 100_KB);
+    }
+    SUBCASE("ReserveCap") {
+        /* 帧头声明的长度不会一次性占用整帧的内存，预留随数据到达逐步扩大 */
+        LengthFieldCodec codec(4, 4_MB, 8_KB);
+        Buffer buffer;
+        buffer.append("\0\x3f\xff\xff", 4);
+        Codec::Frame decoded;
+        CHECK(codec.decode(buffer, decoded) == Codec::kIncomplete);
+        CHECK(buffer.writableBytes() >= 8_KB);
+        CHECK(buffer.capacity() <= 16_KB);
+        buffer.append(std::string(8_KB, 'r'));
+        CHECK(codec.decode(buffer, decoded) == Codec::kIncomplete);
+        CHECK(buffer.writableBytes() >= 8_KB);
+        CHECK(buffer.capacity() <= 64_KB);
+    }
+    SUBCASE("TooLarge") {
+        LengthFieldCodec codec(4, 16);
+        Buffer buffer;
+        buffer.append(std::string(17, 'l'));
+        buffer.prepend("\0\0\0\x11", 4);
+        Codec::Frame frame;
+        CHECK(codec.decode(buffer, frame) == Codec::kError);
+    }
+    SUBCASE("EncodeTooLarge") {
+        /* 超过 maxFrameSize 或帧头表示范围的载荷不编码，缓冲区保持不变 */
+        Buffer buffer;
+        buffer.append(std::string(17, 'l'));
+        CHECK_FALSE(LengthFieldCodec(4, 16).encode(buffer));
+        CHECK(buffer.readableBytes() == 17);
+        buffer.append(std::string(256 - 17, 'l'));
+        CHECK_FALSE(LengthFieldCodec(1, 1_KB).encode(buffer));
+        CHECK(buffer.readableBytes() == 256);
+        CHECK(LengthFieldCodec(2, 1_KB).encode(buffer));
+        CHECK(buffer.readableBytes() == 258);
+    }
+}
+
+TEST_CASE("LineCodec_Test"){
+    Logger::setLogger([](const std::string&) {});
+    SUBCASE("CRLF") {
+        LineCodec codec;
+        Buffer buffer;
+        buffer.append("GET / HTTP/1.1\r\nHost: a\r\n\r\npartial");
+        Codec::Result last;
+        auto frames = decodeAll(codec, buffer, last);
+        CHECK(last == Codec::kIncomplete);
+        REQUIRE(frames.size() == 3);
+        CHECK(frames[0] == "GET / HTTP/1.1");
+        CHECK(frames[1] == "Host: a");
+        CHECK(frames[2] == "");
+        CHECK(buffer.retrieveAllAsString() == "partial");
+    }
+    SUBCASE("LF") {
+        LineCodec codec(LineCodec::kLF);
+        Buffer buffer;
+        buffer.append("one\ntwo\r\n");
+        Codec::Result last;
+        auto frames = decodeAll(codec, buffer, last);
+        REQUIRE(frames.size() == 2);
+        CHECK(frames[0] == "one");
+        CHECK(frames[1] == "two");
+        CHECK(buffer.readableBytes() == 0);
+    }
+    SUBCASE("Encode") {
+        LineCodec codec;
+        Buffer buffer;
+        buffer.append("PING");
+        codec.encode(buffer);
+        CHECK(buffer.retrieveAllAsString() == "PING\r\n");
+    }
+    SUBCASE("TooLong") {
+        LineCodec codec(LineCodec::kCRLF, 8);
+        Buffer buffer;
+        buffer.append("123456789");
+        Codec::Frame frame;
+        CHECK(codec.decode(buffer, frame) == Codec::kError);
+    }
+}
+
+/* 第一帧的回调中 shutdown，连接进入 kDisconnecting，同一次读到的后续帧仍然全部解码 */
+TEST_CASE("Codec_Shutdown_Test"){
+    Logger::setLogger([](const std::string&) {});
+    LengthFieldCodec codec;
+    std::vector<std::string> frames;
+    std::atomic<int> decoded{0};
+    codec.setFrameCallback([&](TcpConnection& conn, utils::StringPiece frame, utils::Timestamp) {
+        frames.push_back(frame.asString());
+        ++decoded;
+        if(frames.size() == 1) conn.shutdown();
+    });
+
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::thread serverThread([&] {
+        TcpServer framed(kPort, "Codec");
+        framed.setThreadNumInPool(1);
+        framed.setMessageCallback(codec.messageCallback());
+        server = &framed;
+        ready = true;
+        framed.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    /* 三帧在一次写入中发出 */
+    Buffer stream;
+    for(const char* payload : { "first", "second", "third" }) {
+        Buffer frame;
+        frame.append(payload);
+        REQUIRE(codec.encode(frame));
+        stream.append(frame.beginRead(), frame.readableBytes());
+    }
+    int fd = connectTo(kPort);
+    REQUIRE(fd >= 0);
+    CHECK(::write(fd, stream.beginRead(), stream.readableBytes()) == static_cast<ssize_t>(stream.readableBytes()));
+
+    /* 服务端关闭写端后对端读到 EOF */
+    CHECK(readExactly(fd, 1).empty());
+    CHECK(waitFor([&] { return decoded == 3; }));
+    ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+    REQUIRE(frames.size() == 3);
+    CHECK(frames[0] == "first");
+    CHECK(frames[1] == "second");
+    CHECK(frames[2] == "third");
+}
@@ -0,0 +1,87 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPort = 24700;
+const int kWarmup = 20;
+const int kChurn = 200;
+
+/* 建立连接、收发一次、关闭，等待服务端析构该连接 */
+static bool churnOnce(std::atomic<int>& closed) {
+    int before = closed;
+    int fd = connectTo(kPort);
+    if(fd < 0) return false;
+    const char request[] = "ping";
+    char reply[sizeof request - 1];
+    bool ok = ::write(fd, request, sizeof reply) == sizeof reply;
+    size_t got = 0;
+    while(ok && got < sizeof reply) {
+        ssize_t n = ::read(fd, reply + got, sizeof reply - got);
+        ok = n > 0;
+        if(ok) got += n;
+    }
+    ::close(fd);
+    return ok && waitFor([&] { return closed > before; }, 2000, 1);
+}
+
+TEST_CASE("ConnectionChurn_Test"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<int> closed{0};
+    std::thread serverThread([&] {
+        TcpServer churn(kPort, "Churn");
+        churn.setThreadNumInPool(2);
+        churn.setConnectionCallback([](TcpConnection&) {});
+        churn.setMessageCallback([](TcpConnection& conn, utils::Buffer& buffer, utils::Timestamp) {
+            conn.send(buffer.retrieveAllAsString());
+        });
+        churn.setCloseCallback([&closed](TcpConnection&) { ++closed; });
+        server = &churn;
+        ready = true;
+        churn.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    auto poolStats = [&] {
+        utils::BlockPool::Stats total;
+        for(Looper* looper : server->threadPoll().getAllReactors()) {
+            auto stats = looper->blockPool().stats();
+            total.hits   += stats.hits;
+            total.misses += stats.misses;
+        }
+        return total;
+    };
+
+    for(int i = 0; i < kWarmup; ++i) REQUIRE(churnOnce(closed));
+    auto reactorBefore = poolStats();
+    auto acceptorBefore = server->looper().blockPool().stats();
+    for(int i = 0; i < kChurn; ++i) REQUIRE(churnOnce(closed));
+    auto reactorAfter = poolStats();
+    auto acceptorAfter = server->looper().blockPool().stats();
+
+    /* 连接的缓冲区在所属 Looper 上分配与归还，预热之后全部命中该线程的缓存 */
+    uint64_t hits   = reactorAfter.hits - reactorBefore.hits;
+    uint64_t misses = reactorAfter.misses - reactorBefore.misses;
+    CHECK(hits >= static_cast<uint64_t>(kChurn));
+    CHECK(misses == 0);
+    /* 接受连接的线程不再为新连接分配缓冲区 */
+    CHECK(acceptorAfter.hits + acceptorAfter.misses == acceptorBefore.hits + acceptorBefore.misses);
+
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
@@ -0,0 +1,137 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPort = 24688;
+
+/* 投递的任务再排入一个任务，后者在下一轮循环中执行，返回时 Looper 至少完整地走过了一轮钩子 */
+static void nextIteration(Looper* looper) {
+    std::atomic<bool> done{false};
+    looper->run([looper, &done] {
+        looper->queue([&done] { done = true; });
+    });
+    while(!done) std::this_thread::yield();
+}
+
+TEST_CASE("LooperHook_Test"){
+    Logger::setLogger([](const std::string&) {});
+    Looper* looper = nullptr;
+    std::atomic<bool> ready{false};
+    std::thread loopThread([&] {
+        Looper loop;
+        looper = &loop;
+        ready = true;
+        loop.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    /* 钩子在 Looper 线程中执行，前后两个钩子交替出现 */
+    std::atomic<int> pre{0}, post{0};
+    std::atomic<bool> ordered{true};
+    std::atomic<bool> inLoop{true};
+    std::atomic<Looper::HookID> preId{0}, postId{0};
+    /* 在同一个任务中添加，两个钩子在同一个任务阶段生效 */
+    looper->run([&] {
+        preId = looper->addPrePollHook([&] {
+            if(pre != post) ordered = false;
+            if(!looper->isInLoopThread()) inLoop = false;
+            ++pre;
+        });
+        postId = looper->addPostPollHook([&] {
+            if(pre != post + 1) ordered = false;
+            ++post;
+        });
+    });
+    /* 添加在注册任务之后的任务阶段生效 */
+    nextIteration(looper);
+    for(int i = 0; i < 10; ++i) {
+        int before = post;
+        nextIteration(looper);
+        CHECK(post > before);
+    }
+    CHECK(post >= 10);
+    CHECK(ordered);
+    CHECK(inLoop);
+
+    /* 移除后不再执行 */
+    looper->removeHook(preId);
+    looper->removeHook(postId);
+    nextIteration(looper);
+    int stopped = post;
+    nextIteration(looper);
+    nextIteration(looper);
+    CHECK(post == stopped);
+
+    /* 钩子可以移除自身 */
+    std::atomic<int> once{0};
+    auto self = std::make_shared<Looper::HookID>();
+    looper->run([&once, looper, self] {
+        *self = looper->addPrePollHook([&once, looper, self] {
+            if(++once == 1) looper->removeHook(*self);
+        });
+    });
+    for(int i = 0; i < 5; ++i) {
+        nextIteration(looper);
+    }
+    CHECK(once == 1);
+
+    looper->run([&] { looper->stop(); });
+    loopThread.join();
+}
+
+/* 合并写出时一次回调中的多次发送在刷新阶段一起写出，顺序不变；关闭写端等到数据写完之后 */
+TEST_CASE("Cork_Test"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<bool> appendOnly{true};
+    std::thread serverThread([&] {
+        TcpServer cork(kPort, "Cork");
+        cork.setThreadNumInPool(1);
+        cork.setCorked(true);
+        cork.setMessageCallback([&appendOnly](TcpConnection& conn, utils::Buffer& buffer, utils::Timestamp) {
+            std::string request = buffer.retrieveAllAsString();
+            size_t before = conn.bufferFootprint();
+            conn.send("HTTP/1.1 200 OK\r\n");
+            conn.send("Content-Length: " + std::to_string(request.size()) + "\r\n");
+            conn.send("\r\n");
+            conn.send(std::string(request));
+            conn.send(std::string(4_KB, 'z'));
+            /* 回调返回之前数据仍在发送缓冲区中 */
+            if(conn.bufferFootprint() <= before) appendOnly = false;
+            conn.shutdown();
+        });
+        server = &cork;
+        ready = true;
+        cork.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int fd = connectTo(kPort);
+    REQUIRE(fd >= 0);
+    REQUIRE(::write(fd, "ping", 4) == 4);
+    std::string expected = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nping" + std::string(4_KB, 'z');
+    CHECK(readExactly(fd, expected.size()) == expected);
+    /* 之后对端关闭写端 */
+    char c;
+    CHECK(::read(fd, &c, 1) == 0);
+    CHECK(appendOnly);
+
+    ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
@@ -0,0 +1,110 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPort = 24687;
+const int kWorkers = 4;
+const int kMessages = 2000;
+
+/* 多个工作线程同时向同一连接发送，各线程轮流使用不同的发送接口；
+ * 拷贝发送的数据在返回后立刻被覆盖，对端收到的每个线程的消息应当完整且保持顺序 */
+TEST_CASE("CrossThreadSend_Test"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<TcpConnection*> connection{nullptr};
+    std::thread serverThread([&] {
+        TcpServer cross(kPort, "CrossThread");
+        cross.setThreadNumInPool(1);
+        cross.setConnectionCallback([&connection](TcpConnection& conn) {
+            connection = conn.connected() ? &conn : nullptr;
+        });
+        server = &cross;
+        ready = true;
+        cross.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int fd = connectTo(kPort);
+    REQUIRE(fd >= 0);
+    REQUIRE(waitFor([&] { return connection.load() != nullptr; }));
+    TcpConnection* conn = connection;
+
+    std::vector<std::thread> workers;
+    for(int w = 0; w < kWorkers; ++w) {
+        workers.emplace_back([conn, w] {
+            char scratch[64];
+            for(int i = 0; i < kMessages; ++i) {
+                std::string line = std::to_string(w) + ":" + std::to_string(i) + "\n";
+                switch(i % 4) {
+                case 0:
+                    snprintf(scratch, sizeof scratch, "%s", line.c_str());
+                    conn->send(scratch, line.size());
+                    memset(scratch, 'x', sizeof scratch);
+                    break;
+                case 1:
+                    conn->send(std::move(line));
+                    break;
+                case 2: {
+                    utils::Buffer buffer;
+                    buffer.append(line);
+                    conn->send(std::move(buffer));
+                    break;
+                }
+                default:
+                    conn->send(utils::SharedPayload(line));
+                    break;
+                }
+            }
+        });
+    }
+    for(std::thread& worker : workers) worker.join();
+
+    /* 按行解析，检查每个工作线程的消息序号连续 */
+    std::vector<int> next(kWorkers, 0);
+    std::string pending;
+    char buf[64 * 1024];
+    int total = 0;
+    while(total < kWorkers * kMessages) {
+        ssize_t n = ::read(fd, buf, sizeof buf);
+        REQUIRE(n > 0);
+        pending.append(buf, n);
+        size_t pos;
+        while((pos = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, pos);
+            pending.erase(0, pos + 1);
+            size_t colon = line.find(':');
+            REQUIRE(colon != std::string::npos);
+            int w = std::stoi(line.substr(0, colon));
+            int i = std::stoi(line.substr(colon + 1));
+            REQUIRE(w < kWorkers);
+            CHECK(i == next[w]);
+            next[w] = i + 1;
+            ++total;
+        }
+    }
+    CHECK(pending.empty());
+    for(int w = 0; w < kWorkers; ++w) {
+        CHECK(next[w] == kMessages);
+    }
+
+    ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
@@ -1,10 +1,13 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #define DOCTEST_CONFIG_COLORS_ANSI
 #include <doctest/doctest.h>
+#include <memory>
 #include <functional>
+#include <fcntl.h>
+#include <strings.h>
 #include <sys/timerfd.h>
-#include "net/Looper.h"
-#include "net/Event.h"
+#include "net/base/Looper.h"
+#include "net/base/Event.h"
 
 using namespace esynet;
 
@@ -34,7 +37,7 @@ void stopLoop(Looper& loop) {
 TEST_CASE("EventLoop_Test"){
     SUBCASE("PollPoller") {
         gStrForTest.clear();
-        Looper loop(false);
+        Looper loop(Looper::kPoll);
 
         /* 用于关闭loop */
         int close_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
@@ -123,4 +126,158 @@ TEST_CASE("EventLoop_Test"){
         close(timer_fd);
         CHECK(gStrForTest == "ewr");
     }
-}
\ No newline at end of file
+
+    SUBCASE("IoUringPoller") {
+        gStrForTest.clear();
+        Looper loop(Looper::kIoUring);
+
+        /* 用于关闭loop */
+        int close_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        struct itimerspec closetime;
+        bzero(&closetime, sizeof closetime);
+        closetime.it_value.tv_sec = 2;
+        timerfd_settime(close_fd, 0, &closetime, NULL);
+        Event stopEvent(loop, close_fd);
+        stopEvent.setReadCallback(std::bind(stopLoop, std::ref(loop)));
+        stopEvent.enableRead();
+        stopEvent.disableRead();
+        stopEvent.enableRead();
+        stopEvent.disableWrite();
+
+        /* 测试读事件监听 */
+        int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        struct itimerspec howlong;
+        bzero(&howlong, sizeof howlong);
+        howlong.it_value.tv_sec = 1;
+        timerfd_settime(timer_fd, 0, &howlong, NULL);
+
+        Event readEvent(loop, timer_fd);
+        readEvent.setReadCallback(std::bind(readCallBack, std::ref(readEvent)));
+        readEvent.enableRead(); /* 会委托 loop 更新 poll */
+
+        /* 测试写事件监听 */
+        int write_fd = fileno(stdout);
+
+        Event writeEvent(loop, write_fd);
+        writeEvent.setWriteCallback(std::bind(writeCallBack, std::ref(writeEvent)));
+        writeEvent.enableWrite(); /* 会委托 loop 更新 poll */
+
+        /* 测试错误事件监听 */
+        Event errorEvent(loop, 1024);
+        errorEvent.setErrorCallback(std::bind(errorCallBack, std::ref(errorEvent)));
+        errorEvent.enableRead();
+
+        loop.start();
+        close(timer_fd);
+        /* 完成事件的顺序不固定 */
+        CHECK(gStrForTest.size() == 3);
+        CHECK(gStrForTest.find('r') != std::string::npos);
+        CHECK(gStrForTest.find('w') != std::string::npos);
+        CHECK(gStrForTest.find('e') != std::string::npos);
+    }
+}
+TEST_CASE("EdgeTriggered_Test") {
+    int fds[2];
+    REQUIRE(pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0);
+
+    SUBCASE("EpollPoller") {
+        Looper loop;
+        int times = 0;
+        Event readEvent(loop, fds[0]);
+        readEvent.setEdgeTriggered(true);
+        /* 不读取数据，边沿触发只会通知一次 */
+        readEvent.setReadCallback([&] { ++times; });
+        readEvent.enableRead();
+        write(fds[1], "x", 1);
+        loop.runAfter(300, [&] { loop.stop(); });
+        loop.start();
+        readEvent.cancel();
+        CHECK(times == 1);
+    }
+
+    SUBCASE("Defer") {
+        Looper loop;
+        int times = 0;
+        Event readEvent(loop, fds[0]);
+        readEvent.setEdgeTriggered(true);
+        /* 推迟的事件在下一轮中不经过新的就绪通知再次处理 */
+        readEvent.setReadCallback([&] {
+            if(++times < 3) readEvent.defer(Event::kReadEvent);
+        });
+        readEvent.enableRead();
+        write(fds[1], "x", 1);
+        loop.runAfter(300, [&] { loop.stop(); });
+        loop.start();
+        readEvent.cancel();
+        CHECK(times == 3);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_CASE("Changelist_Test") {
+    int fds[2];
+    REQUIRE(pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0);
+
+    Looper loop;
+    /* 先运行一轮，提交 Looper 自身的注册 */
+    loop.runAfter(10, [&] { loop.stop(); });
+    loop.start();
+
+    Event event(loop, fds[1]);
+    uint64_t changes = loop.poller().numOfChanges();
+    uint64_t commits = loop.poller().numOfCommits();
+    /* 同一轮内的多次修改只提交最终结果，开启又关闭可写事件不产生系统调用 */
+    event.enableRead();
+    event.enableWrite();
+    event.disableWrite();
+    loop.runAfter(100, [&] { loop.stop(); });
+    loop.start();
+    CHECK(loop.poller().numOfChanges() - changes == 3);
+    CHECK(loop.poller().numOfCommits() - commits == 1);
+
+    event.cancel();
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/* fd 在同一轮内关闭并被复用，监听相同事件的新 Event 仍然需要被通知 */
+static void checkFdReuse(Looper::Backend backend) {
+    int fds[2], reuse[2];
+    REQUIRE(pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0);
+    REQUIRE(pipe2(reuse, O_NONBLOCK | O_CLOEXEC) == 0);
+
+    Looper loop(backend);
+    auto oldEvent = std::make_unique<Event>(loop, fds[0]);
+    oldEvent->setReadCallback([] {});
+    oldEvent->enableRead();
+    Event newEvent(loop, fds[0]);
+    int fired = 0;
+    newEvent.setReadCallback([&] { ++fired; loop.stop(); });
+
+    /* 先运行一轮使旧的注册提交到内核 */
+    loop.runAfter(10, [&] {
+        oldEvent->cancel();
+        oldEvent.reset();
+        close(fds[0]);
+        CHECK(dup2(reuse[0], fds[0]) == fds[0]);
+        close(reuse[0]);
+        write(reuse[1], "x", 1);
+        newEvent.enableRead();
+    });
+    loop.runAfter(500, [&] { loop.stop(); });
+    loop.start();
+    newEvent.cancel();
+    CHECK(fired == 1);
+
+    close(fds[0]);
+    close(fds[1]);
+    close(reuse[1]);
+}
+
+TEST_CASE("FdReuse_Test") {
+    SUBCASE("PollPoller")   { checkFdReuse(Looper::kPoll); }
+    SUBCASE("EpollPoller")  { checkFdReuse(Looper::kEpoll); }
+    SUBCASE("IoUringPoller") { checkFdReuse(Looper::kIoUring); }
+}
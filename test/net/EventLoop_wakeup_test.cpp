@@ -3,8 +3,8 @@
 #include <doctest/doctest.h>
 #include <functional>
 #include <sys/timerfd.h>
-#include "net/Looper.h"
-#include "net/Event.h"
+#include "net/base/Looper.h"
+#include "net/base/Event.h"
 
 using namespace esynet;
 using namespace esynet::utils;
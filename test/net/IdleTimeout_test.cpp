@@ -0,0 +1,68 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPort = 24680;
+const double kAllIdleMs = 150;
+
+TEST_CASE("IdleTimeout_Test"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<int> closed{0};
+    std::thread serverThread([&] {
+        TcpServer idle(kPort, "Idle");
+        idle.setThreadNumInPool(1);
+        idle.setIdleTimeout(0, 0, kAllIdleMs);
+        idle.setMessageCallback([](TcpConnection&, utils::Buffer& buffer, utils::Timestamp) {
+            buffer.retrieveAll();
+        });
+        idle.setCloseCallback([&closed](TcpConnection&) { ++closed; });
+        server = &idle;
+        ready = true;
+        idle.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int silent = connectTo(kPort);
+    int active = connectTo(kPort);
+    REQUIRE(silent >= 0);
+    REQUIRE(active >= 0);
+    auto start = steady_clock::now();
+
+    /* 持续发送数据的连接不会超时 */
+    for(int i = 0; i < 8; ++i) {
+        std::this_thread::sleep_for(milliseconds(50));
+        CHECK(::write(active, "x", 1) == 1);
+    }
+
+    /* 空闲的连接被服务端关闭 */
+    char byte;
+    CHECK(::read(silent, &byte, 1) == 0);
+    CHECK(duration_cast<milliseconds>(steady_clock::now() - start).count() >= kAllIdleMs);
+    CHECK(::recv(active, &byte, 1, MSG_DONTWAIT) == -1);
+    CHECK(closed == 1);
+
+    /* 停止发送后同样会超时 */
+    CHECK(::read(active, &byte, 1) == 0);
+    std::this_thread::sleep_for(milliseconds(50));
+    CHECK(closed == 2);
+
+    ::close(silent);
+    ::close(active);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
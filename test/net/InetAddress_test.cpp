@@ -28,7 +28,7 @@ TEST_CASE("InetAddress_Test"){
     NetAddress ad("0.0.0.0", 4567);
     NetAddress local("0.0.0.0", 12345);
     sock3.bind(local);
-    auto ret = sock3.connect(ad);
+    sock3.connect(ad);
     auto addr4 = NetAddress::getLocalAddr(sock3);
     CHECK(addr4.has_value());
     CHECK(addr4->ip() == "127.0.0.1");
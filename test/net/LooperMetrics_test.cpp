@@ -0,0 +1,69 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <thread>
+#include "net/base/Looper.h"
+#include "net/thread/ReactorThreadPoll.h"
+
+using namespace esynet;
+
+TEST_CASE("LooperMetrics_Test"){
+    SUBCASE("Looper") {
+        Looper* looper = nullptr;
+        std::atomic<bool> ready{false};
+        std::thread thread([&] {
+            Looper loop;
+            looper = &loop;
+            ready = true;
+            loop.start();
+        });
+        while(!ready) std::this_thread::yield();
+
+        for(int i = 0; i < 100; ++i) {
+            looper->queue([] {});
+        }
+        looper->queue([looper] {
+            looper->runAfter(0.05, [] {});
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        /* 在其他线程中获取快照 */
+        LooperMetrics::Snapshot snapshot = looper->metrics();
+        CHECK(snapshot.iterations > 0);
+        CHECK(snapshot.tasks >= 100);
+        CHECK(snapshot.timers >= 1);
+        CHECK(snapshot.uptime > 0.1);
+        CHECK(snapshot.cpuTime > 0.0);
+        CHECK(snapshot.pollWait.count == snapshot.iterations);
+        CHECK(snapshot.queueDepth.sum == snapshot.tasks);
+        CHECK(snapshot.queueDepth.max >= 1);
+        CHECK(snapshot.iterationsPerSecond() > 0.0);
+
+        looper->stop();
+        thread.join();
+    }
+
+    SUBCASE("ReactorThreadPoll") {
+        Looper loop;
+        ReactorThreadPoll pool(loop);
+        pool.setThreadNum(2);
+        pool.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        for(Looper* reactor : pool.getAllReactors()) {
+            reactor->queue([] {});
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        std::vector<LooperMetrics::Snapshot> metrics = pool.getAllMetrics();
+        REQUIRE(metrics.size() == 2);
+        LooperMetrics::Snapshot total;
+        for(auto& snapshot : metrics) {
+            CHECK(snapshot.iterations > 0);
+            total.merge(snapshot);
+        }
+        CHECK(total.iterations == metrics[0].iterations + metrics[1].iterations);
+        CHECK(total.uptime > metrics[0].uptime);
+        pool.stop();
+    }
+}
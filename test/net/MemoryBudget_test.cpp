@@ -0,0 +1,156 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPausePort = 24693;
+const int kShedPort  = 24694;
+const int kWaitMs    = 5000;  /* 治理器按周期汇总占用，留出更长的等待时间 */
+
+/* 只写不读的对端，写满双方的套接字缓冲区或被关闭后停止 */
+static std::thread flood(int fd, std::atomic<size_t>& written) {
+    return std::thread([fd, &written] {
+        std::string chunk(64_KB, 'm');
+        while(written < 64_MB) {
+            ssize_t n = ::send(fd, chunk.data(), chunk.size(), MSG_NOSIGNAL);
+            if(n <= 0) break;
+            written += n;
+        }
+    });
+}
+
+/* 服务器不取走收到的数据，读缓冲区持续增长；越过接受阈值后不再接受新连接，
+ * 越过暂停阈值后占用最大的连接被暂停读取，该连接关闭、占用回落后恢复接受 */
+TEST_CASE("MemoryBudget_PauseTest"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<int> accepted{0};
+    std::weak_ptr<TcpConnection> first;
+    std::thread serverThread([&] {
+        TcpServer hoard(kPausePort, "Hoard");
+        hoard.setThreadNumInPool(2);
+        MemoryGovernor::Budget budget;
+        budget.limit       = 16_MB;
+        budget.acceptRatio = 0.05;
+        budget.pauseRatio  = 0.1;
+        budget.shedRatio   = 1.0;
+        budget.resumeRatio = 0.02;
+        budget.intervalMs  = 10.0;
+        hoard.setMemoryBudget(budget);
+        hoard.setConnectionCallback([&accepted, &first](TcpConnection& conn) {
+            if(!conn.connected()) return;
+            if(++accepted == 1) first = conn.shared_from_this();
+        });
+        hoard.setMessageCallback([](TcpConnection&, utils::Buffer&, utils::Timestamp) {});
+        server = &hoard;
+        ready = true;
+        hoard.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int fd = connectTo(kPausePort);
+    REQUIRE(fd >= 0);
+    CHECK(waitFor([&] { return accepted == 1; }, kWaitMs));
+    std::atomic<size_t> written{0};
+    std::thread writer = flood(fd, written);
+
+    CHECK(waitFor([&] { return server->memoryStats().pausedReaders == 1; }, kWaitMs));
+    MemoryGovernor::Stats stats = server->memoryStats();
+    CHECK(stats.limit == 16_MB);
+    CHECK(stats.acceptPauses == 1);
+    CHECK(stats.readPauses == 1);
+    CHECK(stats.sheds == 0);
+    CHECK(stats.level >= MemoryGovernor::kPauseRead);
+
+    /* 暂停接受期间新连接停留在 backlog 中 */
+    int late = connectTo(kPausePort);
+    REQUIRE(late >= 0);
+    std::this_thread::sleep_for(milliseconds(100));
+    CHECK(accepted == 1);
+    /* 被暂停读取后占用不再增长，远小于对端写入的总量 */
+    CHECK(server->memoryStats().usage < 16_MB);
+    CHECK(server->memoryStats().sheds == 0);
+
+    /* 被暂停读取的连接察觉不到对端关闭，由应用关闭；占用回落后恢复接受，backlog 中的连接被接受 */
+    if(auto conn = first.lock()) {
+        conn->looper().run([conn] { conn->forceClose(); });
+    }
+    writer.join();
+    ::close(fd);
+    CHECK(waitFor([&] { return accepted == 2; }, kWaitMs));
+    CHECK(waitFor([&] { return server->memoryStats().level == MemoryGovernor::kNormal; }, kWaitMs));
+    CHECK(server->memoryStats().pausedReaders == 0);
+
+    ::close(late);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
+
+/* 越过上限时关闭占用最大的连接，其余连接不受影响 */
+TEST_CASE("MemoryBudget_ShedTest"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<int> accepted{0};
+    std::atomic<int> closed{0};
+    std::thread serverThread([&] {
+        TcpServer hoard(kShedPort, "Hoard");
+        hoard.setThreadNumInPool(2);
+        MemoryGovernor::Budget budget;
+        budget.limit      = 256_KB;
+        budget.intervalMs = 10.0;
+        hoard.setMemoryBudget(budget);
+        hoard.setConnectionCallback([&accepted](TcpConnection& conn) {
+            if(conn.connected()) ++accepted;
+        });
+        hoard.setCloseCallback([&closed](TcpConnection&) { ++closed; });
+        hoard.setMessageCallback([](TcpConnection&, utils::Buffer&, utils::Timestamp) {});
+        server = &hoard;
+        ready = true;
+        hoard.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int idle = connectTo(kShedPort);
+    REQUIRE(idle >= 0);
+    REQUIRE(::write(idle, "hi", 2) == 2);
+    int fd = connectTo(kShedPort);
+    REQUIRE(fd >= 0);
+    CHECK(waitFor([&] { return accepted == 2; }, kWaitMs));
+    std::atomic<size_t> written{0};
+    std::thread writer = flood(fd, written);
+
+    CHECK(waitFor([&] { return closed == 1; }, kWaitMs));
+    writer.join();
+    CHECK(written < 64_MB);
+    MemoryGovernor::Stats stats = server->memoryStats();
+    CHECK(stats.sheds >= 1);
+    CHECK(stats.acceptPauses >= 1);
+    CHECK(stats.readPauses >= 1);
+
+    /* 被关闭的是写入数据的连接，空闲连接仍然可用 */
+    char c;
+    CHECK(::recv(idle, &c, 1, MSG_DONTWAIT) == -1);
+    CHECK(errno == EAGAIN);
+    CHECK(waitFor([&] { return server->memoryStats().level == MemoryGovernor::kNormal; }, kWaitMs));
+    CHECK(closed == 1);
+
+    ::close(fd);
+    ::close(idle);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
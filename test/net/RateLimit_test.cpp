@@ -0,0 +1,206 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kWritePort     = 24695;
+const int kReadPort      = 24698;
+const int kAggregatePort = 24699;
+const double kRate       = 1024.0 * 1024.0;     /* 1 MB/s */
+const size_t kBurst      = 64_KB;
+const size_t kTotalBytes = 768_KB;
+/* 扣除初始的突发量后至少需要 (768 - 64) / 1024 秒，留出余量 */
+const double kMinSeconds = 0.5;
+const double kMaxSeconds = 5.0;
+
+static char patternAt(size_t pos) {
+    return static_cast<char>(pos % 251);
+}
+
+static std::string pattern(size_t len) {
+    std::string data(len, '\0');
+    for(size_t i = 0; i < len; ++i) data[i] = patternAt(i);
+    return data;
+}
+
+/* 读取 len 字节并校验内容，返回实际读到的字节数 */
+static size_t receive(int fd, size_t len, bool& intact) {
+    std::string chunk(64_KB, '\0');
+    size_t received = 0;
+    intact = true;
+    while(received < len) {
+        ssize_t n = ::read(fd, chunk.data(), chunk.size());
+        if(n <= 0) break;
+        for(ssize_t i = 0; i < n && intact; ++i) {
+            if(chunk[i] != patternAt(received + i)) intact = false;
+        }
+        received += n;
+    }
+    return received;
+}
+
+static double secondsSince(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+/* 服务器在连接建立时一次性发送全部数据，写带宽限制使对端按速率收到；
+ * 被限速期间 Looper 由定时器唤醒，循环次数保持有界 */
+static void runWrite(int port, Looper::Backend backend, TcpConnection::IoMode mode, bool edgeTriggered) {
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<Looper*> ioLooper{nullptr};
+    std::thread serverThread([&] {
+        TcpServer sender(port, "RateLimit", backend);
+        sender.setThreadNumInPool(1);
+        sender.setIoMode(mode);
+        sender.setEdgeTriggered(edgeTriggered);
+        sender.setRateLimit(0.0, kRate, kBurst);
+        sender.setConnectionCallback([&ioLooper](TcpConnection& conn) {
+            if(!conn.connected()) return;
+            ioLooper = &conn.looper();
+            conn.send(pattern(kTotalBytes));
+        });
+        sender.setMessageCallback([](TcpConnection&, utils::Buffer&, utils::Timestamp) {});
+        server = &sender;
+        ready = true;
+        sender.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    auto start = steady_clock::now();
+    int fd = connectTo(port);
+    REQUIRE(fd >= 0);
+    while(!ioLooper) std::this_thread::yield();
+    uint64_t iterations = ioLooper.load()->metrics().iterations;
+    bool intact = false;
+    CHECK(receive(fd, kTotalBytes, intact) == kTotalBytes);
+    double elapsed = secondsSince(start);
+    CHECK(intact);
+    CHECK(elapsed >= kMinSeconds);
+    CHECK(elapsed < kMaxSeconds);
+    CHECK(ioLooper.load()->metrics().iterations - iterations < 2000);
+
+    ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
+
+TEST_CASE("RateLimit_WriteTest"){
+    Logger::setLogger([](const std::string&) {});
+    SUBCASE("LevelTriggered") {
+        runWrite(kWritePort, Looper::kEpoll, TcpConnection::kReadiness, false);
+    }
+    SUBCASE("EdgeTriggered") {
+        runWrite(kWritePort + 1, Looper::kEpoll, TcpConnection::kReadiness, true);
+    }
+    SUBCASE("Completion") {
+        runWrite(kWritePort + 2, Looper::kIoUring, TcpConnection::kCompletion, false);
+    }
+}
+
+/* 读带宽限制使服务器按速率取走数据，对端的写入随之被套接字缓冲区阻塞 */
+TEST_CASE("RateLimit_ReadTest"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<size_t> received{0};
+    std::atomic<bool> intact{true};
+    std::thread serverThread([&] {
+        TcpServer sink(kReadPort, "RateLimit");
+        sink.setThreadNumInPool(1);
+        sink.setRateLimit(kRate, 0.0, kBurst);
+        sink.setMessageCallback([&](TcpConnection&, utils::Buffer& buffer, utils::Timestamp) {
+            std::string data = buffer.retrieveAllAsString();
+            for(size_t i = 0; i < data.size() && intact; ++i) {
+                if(data[i] != patternAt(received + i)) intact = false;
+            }
+            received += data.size();
+        });
+        server = &sink;
+        ready = true;
+        sink.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    auto start = steady_clock::now();
+    int fd = connectTo(kReadPort);
+    REQUIRE(fd >= 0);
+    std::string data = pattern(kTotalBytes);
+    std::thread writer([fd, &data] {
+        for(size_t written = 0; written < data.size(); ) {
+            ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+            if(n <= 0) break;
+            written += n;
+        }
+    });
+    while(received < kTotalBytes && secondsSince(start) < kMaxSeconds) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    double elapsed = secondsSince(start);
+    writer.join();
+    CHECK(received == kTotalBytes);
+    CHECK(intact);
+    CHECK(elapsed >= kMinSeconds);
+    CHECK(elapsed < kMaxSeconds);
+
+    ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
+
+/* 服务器级的总带宽由分布在不同 Looper 上的连接共享 */
+TEST_CASE("RateLimit_AggregateTest"){
+    Logger::setLogger([](const std::string&) {});
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::thread serverThread([&] {
+        TcpServer sender(kAggregatePort, "RateLimit");
+        sender.setThreadNumInPool(2);
+        sender.setAggregateRateLimit(0.0, kRate, kBurst);
+        sender.setConnectionCallback([](TcpConnection& conn) {
+            if(conn.connected()) conn.send(pattern(kTotalBytes / 2));
+        });
+        sender.setMessageCallback([](TcpConnection&, utils::Buffer&, utils::Timestamp) {});
+        server = &sender;
+        ready = true;
+        sender.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    auto start = steady_clock::now();
+    int first = connectTo(kAggregatePort);
+    int second = connectTo(kAggregatePort);
+    REQUIRE(first >= 0);
+    REQUIRE(second >= 0);
+    bool firstIntact = false;
+    bool secondIntact = false;
+    size_t firstReceived = 0;
+    std::thread reader([&] { firstReceived = receive(first, kTotalBytes / 2, firstIntact); });
+    CHECK(receive(second, kTotalBytes / 2, secondIntact) == kTotalBytes / 2);
+    reader.join();
+    double elapsed = secondsSince(start);
+    CHECK(firstReceived == kTotalBytes / 2);
+    CHECK(firstIntact);
+    CHECK(secondIntact);
+    /* 两个连接合计的速率不超过限制 */
+    CHECK(elapsed >= kMinSeconds);
+    CHECK(elapsed < kMaxSeconds);
+
+    ::close(first);
+    ::close(second);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
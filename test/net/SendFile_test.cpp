@@ -0,0 +1,105 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPort = 24682;
+const size_t kFileSize = 2_MB;
+
+/* 读到对端关闭为止 */
+static std::string readAll(int fd) {
+    std::string data;
+    char buf[64 * 1024];
+    ssize_t n;
+    while((n = ::read(fd, buf, sizeof buf)) > 0) {
+        data.append(buf, n);
+    }
+    return data;
+}
+
+/* 文件分段与内存数据交错发送，对端收到的数据按调用顺序排列 */
+/* 每种模式使用不同的端口，避免与上一个服务器的监听套接字冲突 */
+static void runSendFile(int port, Looper::Backend backend, TcpConnection::IoMode mode, bool edgeTriggered) {
+    std::string path = (std::filesystem::temp_directory_path() / "esynet_sendfile_test").string();
+    std::string content(kFileSize, '\0');
+    for(size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>('a' + i * 7 % 26);
+    }
+    std::ofstream(path, std::ios::binary).write(content.data(), content.size());
+    int fd = ::open(path.c_str(), O_RDONLY);
+    REQUIRE(fd >= 0);
+
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<bool> released{false};
+    std::atomic<bool> opened{true};
+    std::atomic<bool> rejected{false};
+    std::atomic<int> writeCompletes{0};
+    std::thread serverThread([&] {
+        TcpServer files(port, "SendFile", backend);
+        files.setThreadNumInPool(1);
+        files.setIoMode(mode);
+        files.setEdgeTriggered(edgeTriggered);
+        files.setConnectionCallback([&](TcpConnection& conn) {
+            if(!conn.connected()) return;
+            conn.send("head:");
+            rejected = !conn.sendFile(path, -1);
+            opened = conn.sendFile(path);
+            conn.send(":mid:");
+            conn.sendFile(fd, 100, 1000, [&released] { released = true; });
+            conn.send(std::string(4_KB, 't'));
+            conn.shutdown();
+        });
+        files.setWriteCompleteCallback([&writeCompletes](TcpConnection&) { ++writeCompletes; });
+        server = &files;
+        ready = true;
+        files.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int sock = connectTo(port);
+    REQUIRE(sock >= 0);
+    std::string received = readAll(sock);
+    CHECK(opened);
+    CHECK(rejected);
+    std::string expected = "head:" + content + ":mid:" + content.substr(100, 1000) + std::string(4_KB, 't');
+    CHECK(received.size() == expected.size());
+    CHECK(received == expected);
+    CHECK(waitFor([&] { return released.load(); }));
+    CHECK(writeCompletes > 0);
+
+    ::close(sock);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+    ::close(fd);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("SendFile_Test"){
+    Logger::setLogger([](const std::string&) {});
+    SUBCASE("LevelTriggered") {
+        runSendFile(kPort, Looper::kEpoll, TcpConnection::kReadiness, false);
+    }
+    SUBCASE("EdgeTriggered") {
+        runSendFile(kPort + 1, Looper::kEpoll, TcpConnection::kReadiness, true);
+    }
+    SUBCASE("Completion") {
+        runSendFile(kPort + 2, Looper::kIoUring, TcpConnection::kCompletion, false);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+/* 网络测试共用的客户端辅助函数，服务端运行在单独的线程中，测试线程以阻塞套接字充当客户端 */
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace esynet::test {
+
+/* 连接本机的 port，服务端可能尚未开始监听，失败时每 10 毫秒重试一次，最多 100 次
+ * rcvbuf 大于 0 时在连接前设置接收缓冲区大小，用于制造发送端的积压 */
+inline int connectTo(int port, int rcvbuf = 0) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for(int retry = 0; retry < 100; ++retry) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if(rcvbuf > 0) ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof rcvbuf);
+        if(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0) return fd;
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+/* 每 pollMs 毫秒检查一次 pred，在 timeoutMs 毫秒内成立时返回 true */
+template <typename Pred>
+bool waitFor(Pred pred, int timeoutMs = 2000, int pollMs = 5) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while(!pred()) {
+        if(std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(pollMs));
+    }
+    return true;
+}
+
+/* 读取 len 字节，连接关闭或出错时返回已读到的部分 */
+inline std::string readExactly(int fd, size_t len) {
+    std::string data(len, '\0');
+    size_t got = 0;
+    while(got < len) {
+        ssize_t n = ::read(fd, data.data() + got, len - got);
+        if(n <= 0) break;
+        got += n;
+    }
+    data.resize(got);
+    return data;
+}
+
+} /* namespace esynet::test */
@@ -0,0 +1,100 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <memory>
+#include <vector>
+#include "net/timer/TimingWheel.h"
+
+using namespace esynet::timer;
+
+/* 以刻度驱动时间轮，记录每个定时器实际到期的刻度 */
+struct Fired {
+    Timer* timer;
+    uint64_t tick;
+};
+
+static std::vector<Fired> advance(TimingWheel& wheel, uint64_t to) {
+    std::vector<Fired> fired;
+    for(uint64_t tick = wheel.current(); tick <= to; ++tick) {
+        while(Timer* timer = wheel.popExpired(tick)) {
+            fired.push_back({ timer, tick });
+        }
+    }
+    return fired;
+}
+
+static std::unique_ptr<Timer> makeTimer() {
+    return std::make_unique<Timer>([] {}, Timestamp(), 0);
+}
+
+TEST_CASE("TimingWheel_Test"){
+    SUBCASE("SameDeadline") {
+        TimingWheel wheel(1000);
+        auto a = makeTimer(), b = makeTimer();
+        wheel.insert(a.get(), 1010);
+        wheel.insert(b.get(), 1010);
+        CHECK(wheel.size() == 2);
+        CHECK(wheel.nextExpiry() == 1010);
+        auto fired = advance(wheel, 1010);
+        CHECK(fired.size() == 2);
+        CHECK(fired[0].timer == a.get());
+        CHECK(fired[1].timer == b.get());
+        CHECK(fired[1].tick == 1010);
+        CHECK(wheel.size() == 0);
+        CHECK(wheel.nextExpiry() == TimingWheel::kNever);
+    }
+    SUBCASE("Cascade") {
+        TimingWheel wheel(5);
+        const uint64_t deadlines[] = { 300, 20000, (1ULL << 21) + 7, (1ULL << 26) + 123 };
+        std::vector<std::unique_ptr<Timer>> timers;
+        for(uint64_t deadline : deadlines) {
+            timers.push_back(makeTimer());
+            wheel.insert(timers.back().get(), deadline);
+        }
+        /* 高层槽的推进刻度不晚于真实到期刻度，跳跃推进也不会错过降级 */
+        std::vector<uint64_t> ticks;
+        while(wheel.size() > 0) {
+            uint64_t next = wheel.nextExpiry();
+            REQUIRE(next != TimingWheel::kNever);
+            while(Timer* timer = wheel.popExpired(next)) {
+                CHECK(timer->id() == timers[ticks.size()]->id());
+                ticks.push_back(next);
+            }
+        }
+        REQUIRE(ticks.size() == 4);
+        for(size_t i = 0; i < ticks.size(); ++i) {
+            CHECK(ticks[i] == deadlines[i]);
+        }
+    }
+    SUBCASE("Remove") {
+        TimingWheel wheel(0);
+        auto a = makeTimer(), b = makeTimer(), c = makeTimer();
+        wheel.insert(a.get(), 10);
+        wheel.insert(b.get(), 10);
+        wheel.insert(c.get(), 5000);
+        wheel.remove(a.get());
+        wheel.remove(c.get());
+        wheel.remove(c.get());
+        CHECK(wheel.size() == 1);
+        auto fired = advance(wheel, 6000);
+        REQUIRE(fired.size() == 1);
+        CHECK(fired[0].timer == b.get());
+        CHECK(wheel.nextExpiry() == TimingWheel::kNever);
+    }
+    SUBCASE("Late") {
+        TimingWheel wheel(100);
+        auto a = makeTimer();
+        wheel.insert(a.get(), 50);
+        CHECK(wheel.nextExpiry() == 100);
+        CHECK(wheel.popExpired(99) == nullptr);
+        CHECK(wheel.popExpired(100) == a.get());
+    }
+    SUBCASE("Jump") {
+        TimingWheel wheel(0);
+        auto a = makeTimer();
+        wheel.insert(a.get(), 70000);
+        CHECK(wheel.popExpired(69999) == nullptr);
+        CHECK(wheel.current() == 70000);
+        CHECK(wheel.popExpired(70000) == a.get());
+    }
+}
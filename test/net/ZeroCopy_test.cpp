@@ -0,0 +1,135 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "net/TcpServer.h"
+#include "net/base/Looper.h"
+#include "logger/Logger.h"
+#include "test/net/TestUtil.h"
+
+using namespace esynet;
+using namespace esynet::test;
+using namespace std::chrono;
+
+const int kPort = 24685;
+const int kClosePort = 24701;
+const int kPayloads = 16;
+const size_t kPayloadSize = 256_KB;
+
+/* 大块数据经零拷贝发送，短数据与之交错；每块数据都在发送完成后释放，内容与顺序不变
+ * 回环连接上内核会回退为拷贝，此后的数据改为普通发送，结果应当相同 */
+TEST_CASE("ZeroCopy_Test"){
+    Logger::setLogger([](const std::string&) {});
+    std::vector<std::string> payloads;
+    std::string expected;
+    for(int i = 0; i < kPayloads; ++i) {
+        payloads.emplace_back(kPayloadSize, static_cast<char>('a' + i));
+        expected += payloads.back() + "|" + std::to_string(i) + "|";
+    }
+
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<int> released{0};
+    std::thread serverThread([&] {
+        TcpServer zeroCopy(kPort, "ZeroCopy");
+        zeroCopy.setThreadNumInPool(1);
+        zeroCopy.setZeroCopy(32_KB);
+        zeroCopy.setConnectionCallback([&](TcpConnection& conn) {
+            if(!conn.connected()) return;
+            for(int i = 0; i < kPayloads; ++i) {
+                conn.send(payloads[i].data(), payloads[i].size(), [&released] { ++released; });
+                conn.send("|" + std::to_string(i) + "|");
+            }
+            conn.shutdown();
+        });
+        server = &zeroCopy;
+        ready = true;
+        zeroCopy.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int fd = connectTo(kPort);
+    REQUIRE(fd >= 0);
+    std::string received;
+    char buf[64 * 1024];
+    ssize_t n;
+    while((n = ::read(fd, buf, sizeof buf)) > 0) {
+        received.append(buf, n);
+    }
+    CHECK(received.size() == expected.size());
+    CHECK(received == expected);
+    CHECK(waitFor([&] { return released == kPayloads; }));
+
+    ::close(fd);
+    CHECK(waitFor([&] { return server->threadPoll().getAllMetrics().at(0).bufferBytes == 0; }));
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
+
+/* 对端不读取时关闭连接，内核发送队列中的零拷贝数据仍引用着用户内存；
+ * 释放回调会覆写数据，在完成通知到达之前释放的话对端将读到被覆写的内容 */
+TEST_CASE("ZeroCopy_CloseWithPendingSends"){
+    Logger::setLogger([](const std::string&) {});
+    std::vector<std::string> payloads;
+    std::string expected;
+    for(int i = 0; i < kPayloads; ++i) {
+        payloads.emplace_back(kPayloadSize, static_cast<char>('a' + i));
+        expected += payloads.back();
+    }
+
+    TcpServer* server = nullptr;
+    std::atomic<bool> ready{false};
+    std::atomic<bool> closed{false};
+    std::atomic<int> released{0};
+    std::thread serverThread([&] {
+        TcpServer zeroCopy(kClosePort, "ZeroCopyClose");
+        zeroCopy.setThreadNumInPool(1);
+        zeroCopy.setZeroCopy(32_KB);
+        zeroCopy.setConnectionCallback([&](TcpConnection& conn) {
+            if(!conn.connected()) return;
+            for(int i = 0; i < kPayloads; ++i) {
+                std::string& payload = payloads[i];
+                conn.send(payload.data(), payload.size(), [&released, &payload] {
+                    std::fill(payload.begin(), payload.end(), 'X');
+                    ++released;
+                });
+            }
+            conn.forceClose();
+        });
+        zeroCopy.setCloseCallback([&closed](TcpConnection&) { closed = true; });
+        server = &zeroCopy;
+        ready = true;
+        zeroCopy.start();
+    });
+    while(!ready) std::this_thread::yield();
+
+    int fd = connectTo(kClosePort, 64 * 1024);
+    REQUIRE(fd >= 0);
+    REQUIRE(waitFor([&] { return closed.load(); }));
+    /* 已进入内核的数据在对端读取之前不会被释放 */
+    CHECK(released < kPayloads);
+
+    std::string received;
+    char buf[64 * 1024];
+    ssize_t n;
+    while((n = ::read(fd, buf, sizeof buf)) > 0) {
+        received.append(buf, n);
+    }
+    CHECK(received.size() > 0);
+    CHECK(received.size() <= expected.size());
+    CHECK(received.find('X') == std::string::npos);
+    CHECK(expected.compare(0, received.size(), received) == 0);
+    CHECK(waitFor([&] { return released == kPayloads; }));
+    CHECK(waitFor([&] { return server->threadPoll().getAllMetrics().at(0).bufferBytes == 0; }));
+
+    ::close(fd);
+    server->looper().run([&] { server->shutdown(); });
+    serverThread.join();
+}
@@ -0,0 +1,119 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <string>
+#include <thread>
+#include "utils/BlockPool.h"
+#include "utils/Buffer.h"
+
+using namespace esynet::utils;
+
+TEST_CASE("BlockPool_Test"){
+    SUBCASE("SizeClass") {
+        CHECK(BlockPool::roundUp(1) == 1024);
+        CHECK(BlockPool::roundUp(1024) == 1024);
+        CHECK(BlockPool::roundUp(1025) == 4 * 1024);
+        CHECK(BlockPool::roundUp(64 * 1024) == 64 * 1024);
+        CHECK(BlockPool::roundUp(64 * 1024 + 1) == 68 * 1024);
+    }
+    SUBCASE("Reuse") {
+        BlockPool pool;
+        BlockPool::Block first = pool.acquire(3000);
+        CHECK(first.capacity == 4 * 1024);
+        pool.release(first);
+        CHECK(pool.stats().cachedBytes == 4 * 1024);
+
+        BlockPool::Block second = pool.acquire(2000);
+        CHECK(second.data == first.data);
+        pool.release(second);
+
+        auto stats = pool.stats();
+        CHECK(stats.hits == 1);
+        CHECK(stats.misses == 1);
+        CHECK(stats.recycled == 2);
+        CHECK(stats.hitRate() == 0.5);
+    }
+    SUBCASE("Oversize") {
+        /* 超出最大尺寸类的块不进入缓存 */
+        BlockPool pool;
+        BlockPool::Block block = pool.acquire(100 * 1024);
+        pool.release(block);
+        CHECK(pool.stats().released == 1);
+        CHECK(pool.stats().cachedBytes == 0);
+    }
+    SUBCASE("Limit") {
+        BlockPool pool;
+        const size_t max = BlockPool::kMaxCachedBytes / (64 * 1024);
+        std::vector<BlockPool::Block> blocks;
+        for(size_t i = 0; i < max + 2; ++i) {
+            blocks.push_back(pool.acquire(64 * 1024));
+        }
+        for(auto& block : blocks) {
+            pool.release(block);
+        }
+        CHECK(pool.stats().recycled == max);
+        CHECK(pool.stats().released == 2);
+        CHECK(pool.stats().cachedBytes == BlockPool::kMaxCachedBytes);
+    }
+}
+
+TEST_CASE("BlockPool_Buffer_Test"){
+    SUBCASE("Churn") {
+        /* 连接反复建立与关闭时，Buffer 的内存块全部来自缓存 */
+        { Buffer warmup; }
+        auto before = BlockPool::local()->stats();
+        for(int i = 0; i < 100; ++i) {
+            Buffer buffer;
+            buffer.append("GET / HTTP/1.0\r\n\r\n");
+        }
+        auto after = BlockPool::local()->stats();
+        CHECK(after.hits - before.hits == 100);
+        CHECK(after.misses == before.misses);
+    }
+    SUBCASE("Grow") {
+        Buffer buffer;
+        std::string data(10000, 'g');
+        buffer.append("head");
+        buffer.retrieve(2);
+        buffer.append(data);
+        CHECK(buffer.readableBytes() == 2 + data.size());
+        CHECK(buffer.retrieveAsString(2) == "ad");
+        CHECK(buffer.retrieveAllAsString() == data);
+    }
+    SUBCASE("CopyAndMove") {
+        Buffer buffer;
+        buffer.append("payload");
+        Buffer copy(buffer);
+        /* 移动不分配内存块，被移动的 Buffer 在下一次写入时才分配 */
+        auto before = BlockPool::local()->stats();
+        Buffer moved(std::move(buffer));
+        Buffer assigned;
+        assigned = std::move(moved);
+        auto after = BlockPool::local()->stats();
+        CHECK(after.hits + after.misses == before.hits + before.misses + 1);
+        CHECK(buffer.capacity() == 0);
+        CHECK(moved.capacity() == 0);
+        CHECK(copy.retrieveAllAsString() == "payload");
+        CHECK(assigned.retrieveAllAsString() == "payload");
+        CHECK(buffer.readableBytes() == 0);
+        CHECK(buffer.findCRLF() == nullptr);
+        buffer.append("again");
+        CHECK(buffer.capacity() > 0);
+        CHECK(buffer.retrieveAllAsString() == "again");
+
+        Buffer empty(0);
+        CHECK(empty.capacity() == 0);
+        int32_t length = 5;
+        empty.prepend(&length, sizeof length);
+        CHECK(empty.readByte4() == 5);
+    }
+    SUBCASE("CrossThread") {
+        /* 在其他线程析构的 Buffer 归还到该线程的块池 */
+        auto* buffer = new Buffer;
+        std::thread([buffer] {
+            auto before = BlockPool::local()->stats();
+            delete buffer;
+            CHECK(BlockPool::local()->stats().recycled == before.recycled + 1);
+        }).join();
+    }
+}
@@ -2,9 +2,61 @@
 #define DOCTEST_CONFIG_COLORS_ANSI
 #include <doctest/doctest.h>
 #include <cstdio>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
 #include "utils/Buffer.h"
 
+using namespace esynet;
+using namespace esynet::utils;
+
 /* TODO: buffer test */
 TEST_CASE("Buffer_Test"){
 
-}
\ No newline at end of file
+}
+
+TEST_CASE("Buffer_ReadSocket_Test"){
+    int fds[2];
+    REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+    char scratch[4_KB];
+
+    SUBCASE("Direct") {
+        /* 可写空间足够时不经过暂存区 */
+        Buffer buffer;
+        buffer.ensureWritableBytes(2_KB);
+        std::string payload(2_KB, 'd');
+        REQUIRE(::write(fds[1], payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+        memset(scratch, 0, sizeof scratch);
+        CHECK(buffer.readSocket(Socket(fds[0]), scratch, sizeof scratch, 8_KB) == 2_KB);
+        CHECK(buffer.retrieveAllAsString() == payload);
+        CHECK(scratch[0] == 0);
+    }
+    SUBCASE("Spill") {
+        /* 超出可写空间的部分落入暂存区后拷贝进 Buffer */
+        Buffer buffer(16);
+        std::string payload(3_KB, 's');
+        REQUIRE(::write(fds[1], payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+        CHECK(buffer.readSocket(Socket(fds[0]), scratch, sizeof scratch, 8_KB) == 3_KB);
+        CHECK(buffer.retrieveAllAsString() == payload);
+    }
+    SUBCASE("Budget") {
+        /* 单次读取不超过 maxBytes，剩余数据留在内核中 */
+        Buffer buffer;
+        std::string payload(3_KB, 'b');
+        REQUIRE(::write(fds[1], payload.data(), payload.size()) == static_cast<ssize_t>(payload.size()));
+        CHECK(buffer.readSocket(Socket(fds[0]), scratch, sizeof scratch, 2_KB) == 2_KB);
+        CHECK(buffer.readableBytes() == 2_KB);
+        CHECK(buffer.readSocket(Socket(fds[0]), scratch, sizeof scratch, 2_KB) == 1_KB);
+        CHECK(buffer.readableBytes() == 3_KB);
+        CHECK(buffer.readSocket(Socket(fds[0]), scratch, sizeof scratch, 2_KB) == -1);
+    }
+    SUBCASE("NoScratch") {
+        Buffer buffer(0);
+        REQUIRE(::write(fds[1], "ping", 4) == 4);
+        CHECK(buffer.readSocket(Socket(fds[0]), nullptr, 0, 1_KB) == 4);
+        CHECK(buffer.retrieveAllAsString() == "ping");
+    }
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
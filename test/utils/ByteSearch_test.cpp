@@ -0,0 +1,87 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "utils/ByteSearch.h"
+#include "utils/Buffer.h"
+
+using namespace esynet::utils;
+
+static std::vector<const search::Kernels*> allKernels() {
+    std::vector<const search::Kernels*> kernels { &search::kScalar };
+#ifdef ESYNET_SEARCH_X86
+    kernels.push_back(&search::kSse2);
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) kernels.push_back(&search::kAvx2);
+#endif
+    return kernels;
+}
+
+TEST_CASE("ByteSearch_Test"){
+    /* 各实现在所有起止偏移上都与 std::search 的结果一致 */
+    SUBCASE("Kernels") {
+        std::mt19937 rng(20240601);
+        std::uniform_int_distribution<int> alphabet(0, 3);
+        const char letters[] = { 'a', '\r', '\n', 'b' };
+        std::string data(300, 'a');
+        for(char& c : data) c = letters[alphabet(rng)];
+
+        const std::string crlf = "\r\n";
+        int mismatches = 0;
+        for(const search::Kernels* kernels : allKernels()) {
+            for(size_t offset = 0; offset < 40; ++offset) {
+                for(size_t len = 0; offset + len <= data.size(); len += 7) {
+                    const char* begin = data.data() + offset;
+                    const char* end = begin + len;
+                    if(kernels->findByte(begin, end, '\n') != std::find(begin, end, '\n')) ++mismatches;
+                    if(kernels->findPair(begin, end, '\r', '\n') != std::search(begin, end, crlf.begin(), crlf.end())) ++mismatches;
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+    SUBCASE("Sparse") {
+        /* 分隔符位于长数据的末尾、向量块的边界以及不存在的情况 */
+        for(size_t size : { 1, 2, 15, 16, 17, 31, 32, 33, 64, 1000, 4096 }) {
+            std::string data(size, 'x');
+            for(const search::Kernels* kernels : allKernels()) {
+                CHECK(kernels->findByte(data.data(), data.data() + size, '\n') == data.data() + size);
+                CHECK(kernels->findPair(data.data(), data.data() + size, '\r', '\n') == data.data() + size);
+            }
+            data.back() = '\n';
+            if(size >= 2) data[size - 2] = '\r';
+            for(const search::Kernels* kernels : allKernels()) {
+                CHECK(kernels->findByte(data.data(), data.data() + size, '\n') == data.data() + size - 1);
+                if(size >= 2) {
+                    CHECK(kernels->findPair(data.data(), data.data() + size, '\r', '\n') == data.data() + size - 2);
+                }
+            }
+        }
+    }
+    SUBCASE("Bytes") {
+        std::string data = "GET / HTTP/1.1\r\nHost: a\r\nHost: b\r\n\r\nbody";
+        const char* begin = data.data();
+        const char* end = begin + data.size();
+        CHECK(findBytes(begin, end, "\r\n\r\n", 4) == begin + data.find("\r\n\r\n"));
+        CHECK(findBytes(begin, end, "Host: b", 7) == begin + data.find("Host: b"));
+        CHECK(findBytes(begin, end, "body", 4) == begin + data.find("body"));
+        CHECK(findBytes(begin, end, "bodyx", 5) == end);
+        CHECK(findBytes(begin, end, "G", 1) == begin);
+        CHECK(findBytes(begin, end, "", 0) == begin);
+    }
+    SUBCASE("Buffer") {
+        Buffer buffer;
+        buffer.append("line1\r\nline2\nrest");
+        const char* crlf = buffer.findCRLF();
+        REQUIRE(crlf != nullptr);
+        CHECK(crlf - buffer.beginRead() == 5);
+        CHECK(buffer.findEOL() - buffer.beginRead() == 6);
+        CHECK(buffer.findEOL(crlf + 2) - buffer.beginRead() == 12);
+        CHECK(buffer.findCRLF(crlf + 2) == nullptr);
+        CHECK(buffer.find("rest") - buffer.beginRead() == 13);
+        CHECK(buffer.find("none") == nullptr);
+    }
+}
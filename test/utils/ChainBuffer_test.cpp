@@ -0,0 +1,142 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "utils/ChainBuffer.h"
+
+using namespace esynet;
+using namespace esynet::utils;
+
+static std::string flatten(const ChainBuffer& buffer) {
+    struct iovec iov[ChainBuffer::kMaxIovecs];
+    int count = buffer.peek(iov, ChainBuffer::kMaxIovecs);
+    std::string result;
+    for(int i = 0; i < count; ++i) {
+        result.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+    }
+    return result;
+}
+
+TEST_CASE("ChainBuffer_Test"){
+    SUBCASE("Copy") {
+        ChainBuffer buffer;
+        buffer.append("hello, ");
+        buffer.append("world");
+        CHECK(buffer.readableBytes() == 12);
+        CHECK(buffer.numOfSegments() == 1);
+        CHECK(flatten(buffer) == "hello, world");
+
+        /* 超出尾部分段容量时分配新的分段，已有数据不移动 */
+        std::string large(ChainBuffer::kSegmentSize, 'x');
+        buffer.append(large.data(), large.size());
+        CHECK(buffer.numOfSegments() == 2);
+        buffer.retrieve(7);
+        CHECK(flatten(buffer) == "world" + large);
+        buffer.retrieveAll();
+        CHECK(buffer.empty());
+
+        /* 自有分段取自块池，发送完即归还，空的缓冲区不占用内存 */
+        auto before = BlockPool::local()->stats();
+        buffer.append("hello");
+        CHECK(buffer.footprint() == ChainBuffer::kSegmentSize);
+        buffer.retrieve(5);
+        CHECK(buffer.numOfSegments() == 0);
+        CHECK(buffer.footprint() == 0);
+        auto after = BlockPool::local()->stats();
+        CHECK(after.hits == before.hits + 1);
+        CHECK(after.recycled == before.recycled + 1);
+    }
+    SUBCASE("Link") {
+        ChainBuffer buffer;
+        std::string payload(4 * ChainBuffer::kLinkThreshold, 'p');
+        const char* address = payload.data();
+        std::string moved = payload;
+        const char* movedAddress = moved.data();
+        buffer.append("head");
+        buffer.append(std::move(moved));
+        buffer.append("tail");
+        CHECK(buffer.numOfSegments() == 3);
+
+        struct iovec iov[4];
+        CHECK(buffer.peek(iov, 4) == 3);
+        CHECK(iov[1].iov_base == movedAddress);
+        CHECK(iov[1].iov_len == payload.size());
+
+        /* 外部缓冲区在发送完成后才释放 */
+        int released = 0;
+        buffer.append(address, payload.size(), [&released] { ++released; });
+        auto shared = std::make_shared<Buffer>();
+        shared->append(payload);
+        buffer.append(std::shared_ptr<const Buffer>(shared));
+        CHECK(shared.use_count() == 2);
+        CHECK(buffer.readableBytes() == 8 + 3 * payload.size());
+
+        buffer.retrieve(4 + 2 * payload.size() + 4 - 1);
+        CHECK(released == 0);
+        buffer.retrieve(2);
+        CHECK(released == 1);
+        buffer.retrieveAll();
+        CHECK(shared.use_count() == 1);
+
+        /* 较短的数据直接拷贝，release 立刻被调用 */
+        buffer.append("abc", 3, [&released] { ++released; });
+        CHECK(released == 2);
+        CHECK(flatten(buffer) == "abc");
+    }
+    SUBCASE("Queue") {
+        /* 头部分段逐个释放，同时在尾部追加，分段的顺序保持不变 */
+        ChainBuffer buffer;
+        std::string expected;
+        for(int i = 0; i < 64; ++i) {
+            std::string piece(ChainBuffer::kLinkThreshold, static_cast<char>('a' + i % 26));
+            expected += piece;
+            buffer.append(std::move(piece));
+            if(i % 3 == 2) {
+                buffer.retrieve(ChainBuffer::kLinkThreshold);
+                expected.erase(0, ChainBuffer::kLinkThreshold);
+            }
+            CHECK(buffer.numOfSegments() * ChainBuffer::kLinkThreshold == expected.size());
+        }
+        CHECK(flatten(buffer) == expected);
+        buffer.retrieve(ChainBuffer::kLinkThreshold / 2);
+        CHECK(flatten(buffer) == expected.substr(ChainBuffer::kLinkThreshold / 2));
+        buffer.retrieveAll();
+        CHECK(buffer.numOfSegments() == 0);
+        buffer.append("again");
+        CHECK(flatten(buffer) == "again");
+    }
+    SUBCASE("WriteSocket") {
+        int fds[2];
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        ChainBuffer buffer;
+        std::string payload(3 * ChainBuffer::kLinkThreshold, 'z');
+        buffer.append("GET ");
+        buffer.append(std::string(payload));
+        buffer.append(" END");
+        CHECK(buffer.writeSocket(Socket(fds[0])) == static_cast<ssize_t>(payload.size() + 8));
+        CHECK(buffer.empty());
+
+        std::string received(payload.size() + 8, '\0');
+        size_t got = 0;
+        while(got < received.size()) {
+            ssize_t n = ::read(fds[1], received.data() + got, received.size() - got);
+            REQUIRE(n > 0);
+            got += n;
+        }
+        CHECK(received == "GET " + payload + " END");
+
+        /* 每次 writev 至多 kWriteIovecs 个分段，剩余的分段留待下一次写出 */
+        std::string piece(ChainBuffer::kLinkThreshold, 'q');
+        for(int i = 0; i < ChainBuffer::kWriteIovecs + 8; ++i) {
+            buffer.append(std::string(piece));
+        }
+        CHECK(buffer.writeSocket(Socket(fds[0])) == static_cast<ssize_t>(ChainBuffer::kWriteIovecs * piece.size()));
+        CHECK(buffer.numOfSegments() == 8);
+        CHECK(buffer.writeSocket(Socket(fds[0])) == static_cast<ssize_t>(8 * piece.size()));
+        CHECK(buffer.empty());
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+}
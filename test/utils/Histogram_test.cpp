@@ -0,0 +1,52 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include "utils/Histogram.h"
+
+using namespace esynet::utils;
+
+TEST_CASE("Histogram_Test"){
+    CHECK(Histogram().snapshot().count == 0);
+    CHECK(Histogram().snapshot().percentile(0.5) == 0);
+
+    SUBCASE("Record") {
+        Histogram histogram;
+        histogram.record(0);
+        histogram.record(1);
+        histogram.record(3);
+        histogram.record(1000);
+        Histogram::Snapshot snapshot = histogram.snapshot();
+        CHECK(snapshot.count == 4);
+        CHECK(snapshot.sum == 1004);
+        CHECK(snapshot.max == 1000);
+        CHECK(snapshot.buckets[0] == 1);
+        CHECK(snapshot.buckets[1] == 1);    /* [1, 2) */
+        CHECK(snapshot.buckets[2] == 1);    /* [2, 4) */
+        CHECK(snapshot.buckets[10] == 1);   /* [512, 1024) */
+        CHECK(snapshot.mean() == 251.0);
+    }
+
+    SUBCASE("Percentile") {
+        Histogram histogram;
+        for(uint64_t i = 1; i <= 100; ++i) {
+            histogram.record(i);
+        }
+        Histogram::Snapshot snapshot = histogram.snapshot();
+        /* 分位数为所在桶的上界 */
+        CHECK(snapshot.percentile(0.5) == 63);
+        CHECK(snapshot.percentile(0.99) == 100);
+        CHECK(snapshot.percentile(0.0) == 1);
+    }
+
+    SUBCASE("Merge") {
+        Histogram histogram, other;
+        histogram.record(10);
+        other.record(20);
+        other.record(5000);
+        Histogram::Snapshot snapshot = histogram.snapshot();
+        snapshot.merge(other.snapshot());
+        CHECK(snapshot.count == 3);
+        CHECK(snapshot.sum == 5030);
+        CHECK(snapshot.max == 5000);
+    }
+}
@@ -0,0 +1,64 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <thread>
+#include <vector>
+#include "utils/MpscQueue.h"
+
+using namespace esynet::utils;
+
+struct Node {
+    int producer;
+    int seq;
+    Node* next {nullptr};
+};
+
+TEST_CASE("MpscQueue_Test"){
+    MpscQueue<Node> queue;
+    CHECK(queue.empty());
+    CHECK(queue.popAll() == nullptr);
+
+    SUBCASE("Order") {
+        Node a{0, 0}, b{0, 1}, c{0, 2};
+        CHECK(queue.push(&a) == true);
+        CHECK(queue.push(&b) == false);
+        CHECK(queue.push(&c) == false);
+        Node* head = queue.popAll();
+        CHECK(queue.empty());
+        CHECK(head == &a);
+        CHECK(head->next == &b);
+        CHECK(head->next->next == &c);
+        CHECK(head->next->next->next == nullptr);
+        CHECK(queue.push(&a) == true);
+        CHECK(queue.popAll() == &a);
+    }
+
+    SUBCASE("MultiProducer") {
+        const int kProducers = 4, kNodes = 10000;
+        std::vector<Node> nodes(kProducers * kNodes);
+        std::vector<std::thread> producers;
+        for(int i = 0; i < kProducers; ++i) {
+            producers.emplace_back([&, i] {
+                for(int j = 0; j < kNodes; ++j) {
+                    Node& node = nodes[i * kNodes + j];
+                    node.producer = i;
+                    node.seq = j;
+                    queue.push(&node);
+                }
+            });
+        }
+        int count = 0;
+        std::vector<int> last(kProducers, -1);
+        bool ordered = true;
+        while(count < kProducers * kNodes) {
+            for(Node* node = queue.popAll(); node; node = node->next) {
+                ordered = ordered && node->seq == last[node->producer] + 1;
+                last[node->producer] = node->seq;
+                ++count;
+            }
+        }
+        for(auto& producer : producers) producer.join();
+        CHECK(ordered);
+        CHECK(queue.empty());
+    }
+}
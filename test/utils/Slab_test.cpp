@@ -0,0 +1,91 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/Slab.h"
+
+using namespace esynet::utils;
+
+TEST_CASE("Slab_Test"){
+    SUBCASE("Reuse") {
+        Slab slab;
+        void* first = slab.allocate(100);
+        CHECK(slab.stats().slotSize == 112);
+        CHECK(slab.stats().chunks == 1);
+        CHECK(slab.stats().slotsInUse == 1);
+        slab.deallocate(first, 100);
+        CHECK(slab.stats().slotsInUse == 0);
+
+        /* 归还的槽位最先被复用 */
+        void* second = slab.allocate(100);
+        CHECK(second == first);
+        slab.deallocate(second, 100);
+    }
+    SUBCASE("Grow") {
+        Slab slab;
+        std::vector<void*> slots;
+        for(size_t i = 0; i < Slab::kSlotsPerChunk + 1; ++i) {
+            slots.push_back(slab.allocate(64));
+        }
+        CHECK(slab.stats().chunks == 2);
+        CHECK(slab.stats().slotsInUse == Slab::kSlotsPerChunk + 1);
+        for(void* slot : slots) slab.deallocate(slot, 64);
+        CHECK(slab.stats().slotsInUse == 0);
+        CHECK(slab.stats().chunks == 2);
+    }
+    SUBCASE("OtherSize") {
+        /* 大小与槽位不同的请求不经过 Slab */
+        Slab slab;
+        void* slot = slab.allocate(64);
+        void* other = slab.allocate(1000);
+        CHECK(slab.stats().slotsInUse == 1);
+        slab.deallocate(other, 1000);
+        slab.deallocate(slot, 64);
+    }
+    SUBCASE("AllocateShared") {
+        auto slab = std::make_shared<Slab>();
+        std::weak_ptr<Slab> weak = slab;
+        auto first = std::allocate_shared<std::string>(SlabAllocator<std::string>(slab), "first");
+        auto second = std::allocate_shared<std::string>(SlabAllocator<std::string>(slab), "second");
+        CHECK(slab->stats().slotsInUse == 2);
+        first.reset();
+        CHECK(slab->stats().slotsInUse == 1);
+
+        /* 最后一个对象释放之前 Slab 保持有效 */
+        slab.reset();
+        CHECK(!weak.expired());
+        CHECK(*second == "second");
+        second.reset();
+        CHECK(weak.expired());
+    }
+    SUBCASE("CrossThread") {
+        auto slab = std::make_shared<Slab>();
+        std::vector<std::shared_ptr<int>> objects;
+        for(int i = 0; i < 1000; ++i) {
+            objects.push_back(std::allocate_shared<int>(SlabAllocator<int>(slab), i));
+        }
+        std::thread other([&objects] { objects.clear(); });
+        other.join();
+        CHECK(slab->stats().slotsInUse == 0);
+    }
+    SUBCASE("RemoteReuse") {
+        /* 其他线程归还的槽位在本线程的空闲链表用尽后被取回，不再申请新的块 */
+        Slab slab;
+        std::vector<void*> slots;
+        for(size_t i = 0; i < Slab::kSlotsPerChunk; ++i) slots.push_back(slab.allocate(sizeof(long)));
+        CHECK(slab.stats().chunks == 1);
+        std::thread other([&slab, &slots] {
+            for(void* slot : slots) slab.deallocate(slot, sizeof(long));
+        });
+        other.join();
+        CHECK(slab.stats().slotsInUse == 0);
+        for(size_t i = 0; i < Slab::kSlotsPerChunk; ++i) slots[i] = slab.allocate(sizeof(long));
+        CHECK(slab.stats().chunks == 1);
+        CHECK(slab.stats().slotsInUse == Slab::kSlotsPerChunk);
+        for(void* slot : slots) slab.deallocate(slot, sizeof(long));
+        CHECK(slab.stats().slotsInUse == 0);
+    }
+}
@@ -0,0 +1,78 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "utils/SlotMap.h"
+
+using namespace esynet::utils;
+
+TEST_CASE("SlotMap_Test"){
+    SUBCASE("InsertFind") {
+        SlotMap<std::string> map;
+        auto nextKey = map.nextKey();
+        auto first = map.insert("first");
+        auto second = map.insert("second");
+        CHECK(first == nextKey);
+        CHECK(first != SlotMap<std::string>::kNullKey);
+        CHECK(map.size() == 2);
+        REQUIRE(map.find(first) != nullptr);
+        CHECK(*map.find(first) == "first");
+        CHECK(*map.find(second) == "second");
+        CHECK(map.find(SlotMap<std::string>::kNullKey) == nullptr);
+    }
+    SUBCASE("Erase") {
+        SlotMap<std::string> map;
+        auto first = map.insert("first");
+        auto second = map.insert("second");
+        auto third = map.insert("third");
+        /* 删除中间的对象后，最后一个对象移入空位，键仍然有效 */
+        CHECK(map.erase(first));
+        CHECK_FALSE(map.erase(first));
+        CHECK(map.find(first) == nullptr);
+        CHECK(*map.find(second) == "second");
+        CHECK(*map.find(third) == "third");
+        CHECK(map.size() == 2);
+    }
+    SUBCASE("Generation") {
+        SlotMap<int> map;
+        auto old = map.insert(1);
+        map.erase(old);
+        /* 槽位被复用，但代数不同，旧的键查不到新对象 */
+        CHECK(map.nextKey() != old);
+        auto reused = map.insert(2);
+        CHECK(static_cast<uint32_t>(reused) == static_cast<uint32_t>(old));
+        CHECK(map.find(old) == nullptr);
+        CHECK(*map.find(reused) == 2);
+    }
+    SUBCASE("UserBits") {
+        /* 高 16 位不参与查找 */
+        SlotMap<int> map;
+        auto key = map.insert(7);
+        auto tagged = key | static_cast<SlotMap<int>::Key>(3) << 48;
+        REQUIRE(map.find(tagged) != nullptr);
+        CHECK(*map.find(tagged) == 7);
+        CHECK(map.erase(tagged));
+        CHECK(map.empty());
+    }
+    SUBCASE("Iterate") {
+        SlotMap<std::shared_ptr<int>> map;
+        std::vector<SlotMap<std::shared_ptr<int>>::Key> keys;
+        for(int i = 0; i < 100; ++i) {
+            keys.push_back(map.insert(std::make_shared<int>(i)));
+        }
+        for(int i = 0; i < 100; i += 2) {
+            map.erase(keys[i]);
+        }
+        int sum = 0;
+        for(const auto& value : map) sum += *value;
+        CHECK(sum == 2500);
+        for(size_t i = 0; i < map.size(); ++i) {
+            CHECK(map.find(map.keys()[i]) == &*(map.begin() + i));
+        }
+        map.clear();
+        CHECK(map.empty());
+        CHECK(map.find(keys[1]) == nullptr);
+    }
+}
@@ -0,0 +1,52 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define DOCTEST_CONFIG_COLORS_ANSI
+#include <doctest/doctest.h>
+#include <thread>
+#include <vector>
+#include "utils/TokenBucket.h"
+
+using namespace esynet::utils;
+
+const int64_t kSecond = 1000 * 1000 * 1000;
+
+TEST_CASE("TokenBucket_Test"){
+    SUBCASE("Refill") {
+        TokenBucket bucket(1000.0, 500);
+        int64_t now = TokenBucket::now();
+        /* 初始为满 */
+        CHECK(bucket.available(now) == 500);
+        CHECK(bucket.waitFor(100, now) == 0);
+
+        bucket.consume(500, now);
+        CHECK(bucket.available(now) == 0);
+        /* 每秒补充 1000 个，0.1 秒后有 100 个 */
+        CHECK(bucket.available(now + kSecond / 10) == 100);
+        CHECK(bucket.waitFor(100, now) == kSecond / 10);
+        /* 不超过容量 */
+        CHECK(bucket.available(now + 10 * kSecond) == 500);
+        CHECK(bucket.waitFor(1000, now) == kSecond / 2);
+    }
+    SUBCASE("Debt") {
+        TokenBucket bucket(1000.0, 100);
+        int64_t now = TokenBucket::now();
+        /* 透支的部分由之后的等待偿还 */
+        bucket.consume(300, now);
+        CHECK(bucket.available(now) == 0);
+        CHECK(bucket.available(now + kSecond / 10) == 0);
+        CHECK(bucket.available(now + kSecond / 5 + kSecond / 10) == 100);
+        CHECK(bucket.waitFor(50, now) == kSecond / 5 + kSecond / 20);
+    }
+    SUBCASE("Shared") {
+        TokenBucket bucket(1.0, 1);
+        int64_t now = TokenBucket::now();
+        std::vector<std::thread> threads;
+        for(int i = 0; i < 4; ++i) {
+            threads.emplace_back([&bucket, now] {
+                for(int j = 0; j < 1000; ++j) bucket.consume(1, now);
+            });
+        }
+        for(std::thread& thread : threads) thread.join();
+        /* 4000 次取令牌都计入，补满需要 4000 秒 */
+        CHECK(bucket.waitFor(1, now) == 4000 * kSecond);
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+#include "NonCopyable.h"
+
+namespace esynet::utils {
+
+/* 线程本地的定长内存块池，尺寸类为 1 KB / 4 KB / 16 KB / 64 KB
+ *
+ * 每个尺寸类以侵入式单链表缓存空闲块（next 指针存放在块的头部），块从不清零；
+ * 超过最大尺寸类的请求直接 malloc/free，不进入缓存
+ * 每个 Looper 线程使用自己的 local() 实例，块可以在一个线程取出、在另一个线程归还，
+ * 归还时进入归还线程的池中；每个尺寸类缓存的字节数有上限，超出的块直接释放
+ *
+ * 除统计信息外非线程安全，统计信息可由任意线程读取 */
+class BlockPool : public NonCopyable {
+public:
+    static const int    kNumOfClasses = 4;
+    static constexpr std::array<size_t, kNumOfClasses> kClassSizes { 1024, 4 * 1024, 16 * 1024, 64 * 1024 };
+    static const size_t kMaxCachedBytes = 1024 * 1024;   /* 每个尺寸类缓存的字节数上限 */
+
+    struct Block {
+        char* data {nullptr};
+        size_t capacity {0};
+    };
+
+    struct Stats {
+        uint64_t hits {0};          /* 从缓存中取得 */
+        uint64_t misses {0};        /* 缓存为空或超出尺寸类，需要 malloc */
+        uint64_t recycled {0};      /* 归还后进入缓存 */
+        uint64_t released {0};      /* 归还时缓存已满或超出尺寸类，直接 free */
+        size_t   cachedBytes {0};
+
+        double hitRate() const {
+            uint64_t total = hits + misses;
+            return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+        }
+    };
+
+    BlockPool() = default;
+    ~BlockPool() {
+        for(FreeList& list : lists_) {
+            while(list.head) {
+                FreeNode* next = list.head->next;
+                std::free(list.head);
+                list.head = next;
+            }
+        }
+    }
+
+    /* 当前线程的块池，线程退出、块池析构之后返回 nullptr */
+    static BlockPool* local() {
+        struct Local {
+            BlockPool pool;
+            ~Local() { destroyed_ = true; }
+        };
+        if(destroyed_) return nullptr;
+        thread_local Local local;
+        return &local.pool;
+    }
+    /* 经由当前线程的块池分配与归还，块池不可用时退化为 malloc/free */
+    static Block allocate(size_t size) {
+        BlockPool* pool = local();
+        return pool ? pool->acquire(size) : Block { static_cast<char*>(std::malloc(roundUp(size))), roundUp(size) };
+    }
+    static void deallocate(Block block) {
+        BlockPool* pool = local();
+        if(pool) {
+            pool->release(block);
+        } else {
+            std::free(block.data);
+        }
+    }
+
+    /* 向上取整到尺寸类，超出最大尺寸类时按 4 KB 对齐 */
+    static size_t roundUp(size_t size) {
+        int index = classOf(size);
+        if(index >= 0) return kClassSizes[index];
+        return (size + kClassSizes[1] - 1) / kClassSizes[1] * kClassSizes[1];
+    }
+
+    /* 取得至少 size 字节的块，块的实际容量为所在尺寸类的大小，内容未初始化 */
+    Block acquire(size_t size) {
+        int index = classOf(size);
+        if(index >= 0) {
+            FreeList& list = lists_[index];
+            if(list.head) {
+                FreeNode* node = list.head;
+                list.head = node->next;
+                --list.count;
+                bump(hits_);
+                cachedBytes_.fetch_sub(kClassSizes[index], std::memory_order_relaxed);
+                return { reinterpret_cast<char*>(node), kClassSizes[index] };
+            }
+        }
+        bump(misses_);
+        size_t capacity = roundUp(size);
+        return { static_cast<char*>(std::malloc(capacity)), capacity };
+    }
+    void release(Block block) {
+        if(!block.data) return;
+        int index = classOf(block.capacity);
+        if(index >= 0 && kClassSizes[index] == block.capacity) {
+            FreeList& list = lists_[index];
+            if((list.count + 1) * block.capacity <= kMaxCachedBytes) {
+                FreeNode* node = reinterpret_cast<FreeNode*>(block.data);
+                node->next = list.head;
+                list.head = node;
+                ++list.count;
+                bump(recycled_);
+                cachedBytes_.fetch_add(block.capacity, std::memory_order_relaxed);
+                return;
+            }
+        }
+        bump(released_);
+        std::free(block.data);
+    }
+
+    Stats stats() const {
+        Stats stats;
+        stats.hits        = hits_.load(std::memory_order_relaxed);
+        stats.misses      = misses_.load(std::memory_order_relaxed);
+        stats.recycled    = recycled_.load(std::memory_order_relaxed);
+        stats.released    = released_.load(std::memory_order_relaxed);
+        stats.cachedBytes = cachedBytes_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+    struct FreeList {
+        FreeNode* head {nullptr};
+        size_t count {0};
+    };
+
+    /* 返回能容纳 size 字节的最小尺寸类，超出时返回 -1 */
+    static int classOf(size_t size) {
+        for(int i = 0; i < kNumOfClasses; ++i) {
+            if(size <= kClassSizes[i]) return i;
+        }
+        return -1;
+    }
+    /* 只有所属线程写入，不需要原子的读-改-写 */
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static inline thread_local bool destroyed_ {false};
+
+    std::array<FreeList, kNumOfClasses> lists_ {};
+    std::atomic<uint64_t> hits_ {0};
+    std::atomic<uint64_t> misses_ {0};
+    std::atomic<uint64_t> recycled_ {0};
+    std::atomic<uint64_t> released_ {0};
+    std::atomic<size_t>   cachedBytes_ {0};
+};
+
+} /* namespace esynet::utils */
@@ -1,13 +1,15 @@
 #pragma once
 
 #include <cstddef>
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include <sys/types.h>
-#include <vector>
 #include <sys/uio.h>
 
 #include "StringPiece.h"
+#include "BlockPool.h"
+#include "ByteSearch.h"
 #include "logger/Logger.h"
 #include "net/base/Socket.h"
 #include "exception/SocketException.h"
@@ -72,58 +74,69 @@ private:
  * |                   |                  |                  |
  * 0      <=      readerIndex   <=   writerIndex    <=     size
  *
+ * 存储取自当前线程的 BlockPool，不做清零，扩容时按倍数增长并只拷贝可读数据，
+ * 析构时归还给析构所在线程的 BlockPool
+ * 初始容量为 0 的 Buffer 与被移动的 Buffer 不持有内存块，第一次写入时才从写入所在线程的块池中分配
  */
 
 class Buffer {
 public:
-    static const size_t kCheapPrepend = 8_B;
-    static const size_t kInitialSize = 1_KB;
+    static constexpr size_t kCheapPrepend = 8_B;
+    /* 初始块恰好落入 BlockPool 最小的尺寸类 */
+    static constexpr size_t kInitialSize = 1_KB - kCheapPrepend;
 
     Buffer(size_t initSize = kInitialSize)
-            : buffer_(kCheapPrepend + initSize),
+            : block_(initSize > 0 ? BlockPool::allocate(kCheapPrepend + initSize) : BlockPool::Block {}),
               readerIndex_(kCheapPrepend),
               writerIndex_(kCheapPrepend) {}
+    Buffer(const Buffer& rhs)
+            : block_(BlockPool::allocate(kCheapPrepend + rhs.readableBytes())),
+              readerIndex_(kCheapPrepend),
+              writerIndex_(kCheapPrepend + rhs.readableBytes()) {
+        std::copy(rhs.beginRead(), rhs.endRead(), begin() + kCheapPrepend);
+    }
+    /* 被移动的 Buffer 不持有内存块，仍然可以继续使用 */
+    Buffer(Buffer&& rhs) : Buffer(0) { swap(rhs); }
+    Buffer& operator=(Buffer rhs) {
+        swap(rhs);
+        return *this;
+    }
+    ~Buffer() { BlockPool::deallocate(block_); }
 
     void swap(Buffer& rhs) {
-        buffer_.swap(rhs.buffer_);
+        std::swap(block_, rhs.block_);
         std::swap(readerIndex_, rhs.readerIndex_);
         std::swap(writerIndex_, rhs.writerIndex_);
+        std::swap(reserved_, rhs.reserved_);
     }
 
     size_t readableBytes() const { return writerIndex_ - readerIndex_; }
-    size_t writableBytes() const { return buffer_.size() - writerIndex_; }
+    size_t writableBytes() const { return block_.capacity > writerIndex_ ? block_.capacity - writerIndex_ : 0; }
     size_t prependableBytes() const { return readerIndex_; }
+    /* 底层内存块的大小，即该 Buffer 实际占用的内存 */
+    size_t capacity() const { return block_.capacity; }
 
+    /* 分隔符查找均由 ByteSearch 中按 CPU 选择的向量化实现完成，找不到时返回 nullptr */
     const char* findCRLF() const {
-        std::string CRLF = "\r\n";
-        const char* crlf = std::search(beginRead(), endRead(), CRLF.begin(), CRLF.end());
-        return crlf == endRead() ? nullptr : crlf;
+        return found(findPair(beginRead(), endRead(), '\r', '\n'));
     }
     const char* findCRLF(const char* start) const {
         checkStart(start);
-        std::string CRLF = "\r\n";
-        const char* crlf = std::search(start, endRead(), CRLF.begin(), CRLF.end());
-        return crlf == endRead() ? nullptr : crlf;
+        return found(findPair(start, endRead(), '\r', '\n'));
     }
     const char* findEOL() const {
-        std::string EOL = "\n";
-        const char* eol = std::search(beginRead(), endRead(), EOL.begin(), EOL.end());
-        return eol == endRead() ? nullptr : eol;
+        return found(findByte(beginRead(), endRead(), '\n'));
     }
     const char* findEOL(const char* start) const {
         checkStart(start);
-        std::string EOL = "\n";
-        const char* eol = std::search(start, endRead(), EOL.begin(), EOL.end());
-        return eol == endRead() ? nullptr : eol;
+        return found(findByte(start, endRead(), '\n'));
     }
     const char* find(StringPiece target) const {
-        const char* pos = std::search(beginRead(), endRead(), target.begin(), target.end());
-        return pos == endRead() ? nullptr : pos;
+        return found(findBytes(beginRead(), endRead(), target.data(), target.size()));
     }
     const char* find(StringPiece target, const char* start) const {
         checkStart(start);
-        const char* pos = std::search(start, endRead(), target.begin(), target.end());
-        return pos == endRead() ? nullptr : pos;
+        return found(findBytes(start, endRead(), target.data(), target.size()));
     }
 
     using ReadableRange = std::pair<const char*, const char*>;
@@ -185,6 +198,7 @@ public:
     void retrieve(size_t len) {
         if (len < readableBytes()) {
             readerIndex_ += len;
+            reserved_ = 0;
         } else {
             retrieveAll();
         }
@@ -199,6 +213,7 @@ public:
     void retrieveAll() {
         readerIndex_ = kCheapPrepend;
         writerIndex_ = kCheapPrepend;
+        reserved_ = 0;
     }
     std::string retrieveAllAsString() {
         return retrieveAsString(readableBytes());
@@ -241,50 +256,112 @@ public:
         if(len > prependableBytes()) {
             LOG_FATAL("prepend out of bound(len: {})", len);
         }
+        if(!block_.data) makeSpace(kInitialSize);
         readerIndex_ -= len;
         const char* dataBytes = static_cast<const char*>(data);
         std::copy(dataBytes, dataBytes + len, beginPrepend());
     }
 
-    /* 从Socket中读取数据，错误时会将error设为值，水平触发不用担心一次读取不完的问题
-     * 如果是边沿触发，则需要考虑 */
-    size_t readSocket(Socket sock) {
-        char extraBuf[64_KB];
+    /* 换用容量不小于 capacity 且能容纳当前数据（以及 reserve 预留的数据）的较小的块，
+     * 当前块已经足够小时不做任何事，返回释放的字节数 */
+    size_t shrink(size_t capacity) {
+        size_t readable = readableBytes();
+        size_t target = BlockPool::roundUp(std::max(capacity, kCheapPrepend + std::max(readable, reserved_)));
+        if(target >= block_.capacity) return 0;
+        BlockPool::Block block = BlockPool::allocate(target);
+        if(readable > 0) {
+            std::copy(beginRead(), endRead(), block.data + kCheapPrepend);
+        }
+        size_t released = block_.capacity - block.capacity;
+        BlockPool::deallocate(block_);
+        block_ = block;
+        readerIndex_ = kCheapPrepend;
+        writerIndex_ = readerIndex_ + readable;
+        return released;
+    }
+
+    /* 保证至少有 len 字节的可写空间，必要时腾挪或扩容 */
+    void ensureWritableBytes(size_t len) {
+        if(writableBytes() < len) {
+            makeSpace(len);
+        }
+    }
+    /* 为即将到达的 len 字节预留可写空间，下一次取出数据之前 shrink 不会收回这部分空间 */
+    void reserve(size_t len) {
+        ensureWritableBytes(len);
+        reserved_ = readableBytes() + len;
+    }
+
+    /* 从Socket中读取数据，暂时无数据可读时返回 -1，其余错误抛出异常
+     * 边沿触发时需要由调用者循环读取直至返回 -1 */
+    ssize_t readSocket(Socket sock) {
+        static thread_local char extraBuf[64_KB];
+        return readSocket(sock, extraBuf, sizeof extraBuf, writableBytes() + sizeof extraBuf);
+    }
+    /* 至多读取 maxBytes 字节，先填满 Buffer 的可写空间，超出部分落入调用者提供的 scratch，
+     * 读取完成后再拷贝进 Buffer
+     *
+     * Buffer空间足够时，不会使用scratch，当空间不够时，才使用scratch，这样做的理由是
+     * 只需要一次系统调用就可以获得足够大的数据，而不必预先在Buffer中预留大量的空间来准备
+     * 可能（很少）来临的大数据；scratch 通常由 Looper 提供，被同一线程上的所有连接复用 */
+    ssize_t readSocket(Socket sock, char* scratch, size_t scratchSize, size_t maxBytes) {
+        if(maxBytes == 0) return -1;
+        if(!scratch || scratchSize == 0) {
+            ensureWritableBytes(std::min(maxBytes, kInitialSize));
+        }
         struct iovec vec[2];
-        const size_t writable = writableBytes();
-        vec[0].iov_base = begin() + writerIndex_;
-        vec[0].iov_len = writable;
-        vec[1].iov_base = extraBuf;
-        vec[1].iov_len = sizeof extraBuf;
+        const size_t writable = std::min(writableBytes(), maxBytes);
+        int count = 0;
+        if(writable > 0) {
+            vec[count].iov_base = begin() + writerIndex_;
+            vec[count].iov_len = writable;
+            ++count;
+        }
+        if(writable < maxBytes && scratch && scratchSize > 0) {
+            vec[count].iov_base = scratch;
+            vec[count].iov_len = std::min(scratchSize, maxBytes - writable);
+            ++count;
+        }
 
-        /* Buffer空间足够时，不会使用extraBuf，当空间不够时，才使用extraBuf，并在
-         * 后续填充至Buffer中，这样做的理由是只需要一次系统调用就可以获得足够大的
-         * 数据，而不必预先在Buffer中预留大量的空间来准备可能（很少）来临的大数据 */
-        ssize_t n = sock.readv(vec, 2);
-        if (n <= writable) {
+        ssize_t n = sock.readv(vec, count);
+        if (n < 0) {
+            return n;
+        } else if (static_cast<size_t>(n) <= writable) {
             writerIndex_ += n;
         } else {
-            writerIndex_ = buffer_.size();
-            append(extraBuf, n - writable);
+            writerIndex_ += writable;
+            append(scratch, n - writable);
         }
         return n;
     }
 
 private:
-    const char* begin() const { return &*buffer_.begin(); }
-    char* begin() { return &*buffer_.begin(); }
+    /* 没有内存块时指向一段空的前缀区，使空 Buffer 的读指针仍然有效 */
+    const char* begin() const { return block_.data ? block_.data : emptyPrepend_; }
+    char* begin() { return block_.data ? block_.data : emptyPrepend_; }
     char* beginWrite() { return begin() + writerIndex_; }
     char* beginPrepend() { return begin() + readerIndex_; }
+    const char* found(const char* pos) const { return pos == endRead() ? nullptr : pos; }
     /* 检查start指针合法性,非法会abort程序 */
     void checkStart(const char* start) const {
         if(start >= endRead() || start < beginRead()) {
             LOG_FATAL("start out of bound(start: {:p})", static_cast<const void*>(start));
         }
     }
-    /* 在当前数据内部腾挪出空间 */
+    /* 在当前数据内部腾挪出空间，不够时换用至少两倍大的块，同时把数据移到头部
+     * 没有内存块时分配一个恰好够用的块 */
     void makeSpace(size_t len) {
-        if (writableBytes() + prependableBytes() < len + kCheapPrepend) {
-            buffer_.resize(writerIndex_+len);
+        if (!block_.data || writableBytes() + prependableBytes() < len + kCheapPrepend) {
+            size_t readable = readableBytes();
+            size_t required = kCheapPrepend + readable + len;
+            BlockPool::Block block = BlockPool::allocate(std::max(required, block_.capacity * 2));
+            if(readable > 0) {
+                std::copy(beginRead(), endRead(), block.data + kCheapPrepend);
+            }
+            BlockPool::deallocate(block_);
+            block_ = block;
+            readerIndex_ = kCheapPrepend;
+            writerIndex_ = readerIndex_ + readable;
         } else {
             /* 将数据往前移 */
             size_t readable = readableBytes();
@@ -295,9 +372,13 @@ private:
     }
 
 private:
-    std::vector<char> buffer_;
+    BlockPool::Block block_;
     size_t readerIndex_;
     size_t writerIndex_;
+    /* reserve 预留后可读数据的目标长度，取出数据时清零 */
+    size_t reserved_ {0};
+
+    static inline char emptyPrepend_[kCheapPrepend] {};
 };
 
 } /* namespace esynet::utils */
\ No newline at end of file
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ESYNET_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace esynet::utils {
+
+/* 分隔符查找：单字节（如 '\n'）、双字节（如 "\r\n"）与任意子串
+ *
+ * x86 上提供 SSE2 与 AVX2 两组向量化实现，首次调用时按 CPU 支持的指令集选择，
+ * 其他平台使用标量实现；所有函数在 [begin, end) 中查找，找不到时返回 end */
+namespace search {
+
+using FindByte = const char* (*)(const char* begin, const char* end, char c);
+using FindPair = const char* (*)(const char* begin, const char* end, char first, char second);
+
+/* 一组实现，name 用于日志与基准测试 */
+struct Kernels {
+    const char* name;
+    FindByte findByte;
+    FindPair findPair;
+};
+
+inline const char* findByteScalar(const char* begin, const char* end, char c) {
+    const void* pos = memchr(begin, c, end - begin);
+    return pos ? static_cast<const char*>(pos) : end;
+}
+inline const char* findPairScalar(const char* begin, const char* end, char first, char second) {
+    const char* pos = begin;
+    while(end - pos >= 2) {
+        pos = findByteScalar(pos, end - 1, first);
+        if(pos == end - 1) break;
+        if(pos[1] == second) return pos;
+        ++pos;
+    }
+    return end;
+}
+
+#ifdef ESYNET_SEARCH_X86
+__attribute__((target("sse2")))
+inline const char* findByteSse2(const char* begin, const char* end, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    const char* pos = begin;
+    for(; end - pos >= 16; pos += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if(mask) return pos + __builtin_ctz(mask);
+    }
+    return findByteScalar(pos, end, c);
+}
+/* 同时比较相邻的两个位置：pos[i] == first 且 pos[i + 1] == second */
+__attribute__((target("sse2")))
+inline const char* findPairSse2(const char* begin, const char* end, char first, char second) {
+    const __m128i needle1 = _mm_set1_epi8(first);
+    const __m128i needle2 = _mm_set1_epi8(second);
+    const char* pos = begin;
+    for(; end - pos >= 17; pos += 16) {
+        __m128i chunk1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+        __m128i chunk2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + 1));
+        __m128i match = _mm_and_si128(_mm_cmpeq_epi8(chunk1, needle1), _mm_cmpeq_epi8(chunk2, needle2));
+        int mask = _mm_movemask_epi8(match);
+        if(mask) return pos + __builtin_ctz(mask);
+    }
+    return findPairScalar(pos, end, first, second);
+}
+
+/* AVX2 先以一次非对齐加载处理开头，之后按 32 字节对齐、每轮处理 128 字节，
+ * 四个向量的比较结果合并后只做一次判断 */
+__attribute__((target("avx2")))
+inline const char* findByteAvx2(const char* begin, const char* end, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    if(end - begin < 32) return findByteSse2(begin, end, c);
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin)), needle)));
+    if(mask) return begin + __builtin_ctz(mask);
+    const char* pos = reinterpret_cast<const char*>((reinterpret_cast<uintptr_t>(begin) + 32) & ~uintptr_t(31));
+    for(; end - pos >= 128; pos += 128) {
+        __m256i m0 = _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos)), needle);
+        __m256i m1 = _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos + 32)), needle);
+        __m256i m2 = _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos + 64)), needle);
+        __m256i m3 = _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos + 96)), needle);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(m0, m1), _mm256_or_si256(m2, m3));
+        if(_mm256_testz_si256(any, any)) continue;
+        uint64_t low  = static_cast<uint32_t>(_mm256_movemask_epi8(m0)) |
+                        static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(m1))) << 32;
+        if(low) return pos + __builtin_ctzll(low);
+        uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(m2)) |
+                        static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(m3))) << 32;
+        return pos + 64 + __builtin_ctzll(high);
+    }
+    for(; end - pos >= 32; pos += 32) {
+        mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos)), needle)));
+        if(mask) return pos + __builtin_ctz(mask);
+    }
+    return findByteSse2(pos, end, c);
+}
+/* 热循环中只比较首字节，四个向量都没有命中时直接跳过，首字节稀疏时与单字节查找一样快；
+ * 命中后再逐个向量比较第二个字节，首字节密集时不会像逐个 memchr 那样退化 */
+__attribute__((target("avx2")))
+inline const char* findPairAvx2(const char* begin, const char* end, char first, char second) {
+    const __m256i needle1 = _mm256_set1_epi8(first);
+    const __m256i needle2 = _mm256_set1_epi8(second);
+    if(end - begin < 33) return findPairSse2(begin, end, first, second);
+    unsigned head = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin)), needle1),
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 1)), needle2))));
+    if(head) return begin + __builtin_ctz(head);
+    const char* pos = reinterpret_cast<const char*>((reinterpret_cast<uintptr_t>(begin) + 32) & ~uintptr_t(31));
+    for(; end - pos >= 129; pos += 128) {
+        const __m256i f[4] = {
+            _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos)), needle1),
+            _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos + 32)), needle1),
+            _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos + 64)), needle1),
+            _mm256_cmpeq_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(pos + 96)), needle1),
+        };
+        __m256i any = _mm256_or_si256(_mm256_or_si256(f[0], f[1]), _mm256_or_si256(f[2], f[3]));
+        if(_mm256_testz_si256(any, any)) continue;
+        for(int i = 0; i < 4; ++i) {
+            __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + i * 32 + 1));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+                _mm256_and_si256(f[i], _mm256_cmpeq_epi8(next, needle2))));
+            if(mask) return pos + i * 32 + __builtin_ctz(mask);
+        }
+    }
+    for(; end - pos >= 33; pos += 32) {
+        __m256i chunk1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+        __m256i chunk2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(chunk1, needle1), _mm256_cmpeq_epi8(chunk2, needle2))));
+        if(mask) return pos + __builtin_ctz(mask);
+    }
+    return findPairSse2(pos, end, first, second);
+}
+#endif
+
+inline const Kernels kScalar { "scalar", findByteScalar, findPairScalar };
+#ifdef ESYNET_SEARCH_X86
+inline const Kernels kSse2 { "sse2", findByteSse2, findPairSse2 };
+inline const Kernels kAvx2 { "avx2", findByteAvx2, findPairAvx2 };
+#endif
+
+/* 当前 CPU 可用的最快实现，只在首次调用时检测 */
+inline const Kernels& kernels() {
+    static const Kernels& selected = [] () -> const Kernels& {
+#ifdef ESYNET_SEARCH_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) return kAvx2;
+        if(__builtin_cpu_supports("sse2")) return kSse2;
+#endif
+        return kScalar;
+    }();
+    return selected;
+}
+
+} /* namespace search */
+
+inline const char* findByte(const char* begin, const char* end, char c) {
+    return search::kernels().findByte(begin, end, c);
+}
+inline const char* findPair(const char* begin, const char* end, char first, char second) {
+    return search::kernels().findPair(begin, end, first, second);
+}
+/* 以前两个字节查找候选位置，再比较剩余部分；needle 为空时返回 begin */
+inline const char* findBytes(const char* begin, const char* end, const char* needle, size_t len) {
+    if(len == 0) return begin;
+    if(static_cast<size_t>(end - begin) < len) return end;
+    if(len == 1) return findByte(begin, end, needle[0]);
+    const char* last = end - len + 1;   /* 候选位置的尾后 */
+    const char* pos = begin;
+    while(pos < last) {
+        pos = findPair(pos, last + 1, needle[0], needle[1]);
+        if(pos >= last) break;
+        if(memcmp(pos + 2, needle + 2, len - 2) == 0) return pos;
+        ++pos;
+    }
+    return end;
+}
+
+} /* namespace esynet::utils */
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <climits>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "Buffer.h"
+#include "net/base/Socket.h"
+
+namespace esynet::utils {
+
+/* 由引用计数分段组成的发送缓冲区（非线程安全）
+ *
+ * +---------+    +-----------------+    +------------------+
+ * | 自有分段 | -> | std::string&&   | -> | 自有分段（可追加） |
+ * +---------+    +-----------------+    +------------------+
+ *
+ * 小块数据拷贝到链表尾部的自有分段中，分段写满后再分配新的分段，已有数据不会被移动；
+ * 自有分段的内存块取自当前线程的 BlockPool，发送完即归还；分段数组在第一次追加时才分配，
+ * 未使用过的发送缓冲区不占用内存，发送完后至多保留 kKeepSegments 个分段的数组；
+ * 调用者转交所有权的缓冲区直接挂入链表，不做拷贝，发送完成或缓冲区被清空时释放
+ * 文件分段只记录 fd 与偏移，数据由内核以 sendfile 直接从文件发出，不经过用户态
+ * 发送时以一次 writev 把至多 kWriteIovecs 个内存分段交给内核，遇到文件分段时单独发送 */
+class ChainBuffer {
+public:
+    using ReleaseCallback = std::function<void()>;
+
+    static constexpr size_t kSegmentSize   = 4_KB;  /* 自有分段的最小容量，落入 BlockPool 的 4 KB 尺寸类 */
+    static constexpr size_t kLinkThreshold = 1_KB;  /* 更短的数据直接拷贝，避免过多的小分段 */
+    static constexpr int    kMaxIovecs     = IOV_MAX;
+    /* writeSocket 每次 writev 的分段数上限，iovec 数组位于栈上，64 个分段已远超一次写入能被接收的量 */
+    static constexpr int    kWriteIovecs   = 64;
+    /* 发送完后保留的分段数组容量，超过时释放数组，避免偶尔的大量分段长期占用内存 */
+    static constexpr size_t kKeepSegments  = 4;
+
+    ChainBuffer() = default;
+    ChainBuffer(const ChainBuffer&) = delete;
+    ChainBuffer& operator=(const ChainBuffer&) = delete;
+
+    void swap(ChainBuffer& rhs) {
+        segments_.swap(rhs.segments_);
+        std::swap(head_, rhs.head_);
+        std::swap(readable_, rhs.readable_);
+    }
+
+    size_t readableBytes() const { return readable_; }
+    size_t numOfSegments() const { return segments_.size() - head_; }
+    /* 占用的内存：自有分段按容量计算，外部分段按尚未发送的字节数计算，文件分段不占用内存 */
+    size_t footprint() const {
+        size_t bytes = 0;
+        for(auto iter = segments_.begin() + head_; iter != segments_.end(); ++iter) {
+            const Segment& segment = *iter;
+            if(segment.fd >= 0) continue;
+            bytes += segment.block ? segment.capacity : segment.end - segment.begin;
+        }
+        return bytes;
+    }
+    bool empty() const { return readable_ == 0; }
+
+    /* 拷贝追加 */
+    void append(const StringPiece& str) { append(str.data(), str.size()); }
+    void append(const char* str) { append(str, strlen(str)); }
+    void append(const void* data, size_t len) {
+        const char* bytes = static_cast<const char*>(data);
+        readable_ += len;
+        if(numOfSegments() > 0 && segments_.back().block) {
+            Segment& tail = segments_.back();
+            size_t copied = std::min(len, tail.capacity - tail.end);
+            memcpy(tail.block + tail.end, bytes, copied);
+            tail.end += copied;
+            bytes += copied;
+            len -= copied;
+        }
+        if(len > 0) {
+            Segment& tail = allocate(std::max(len, kSegmentSize));
+            memcpy(tail.block, bytes, len);
+            tail.end = len;
+        }
+    }
+    /* 零拷贝追加，owner 保证 data 在发送完成之前有效
+     * owner 为空（数据由调用者持有）或数据较短时退化为拷贝 */
+    void link(const void* data, size_t len, std::shared_ptr<const void> owner) {
+        if(!owner || len < kLinkThreshold) {
+            append(data, len);
+            return;
+        }
+        Segment segment;
+        segment.data = static_cast<const char*>(data);
+        segment.end = len;
+        segment.owner = std::move(owner);
+        segments_.push_back(std::move(segment));
+        readable_ += len;
+    }
+    void append(std::string&& str) {
+        if(str.size() < kLinkThreshold) {
+            append(str.data(), str.size());
+            return;
+        }
+        auto owner = std::make_shared<std::string>(std::move(str));
+        link(owner->data(), owner->size(), owner);
+    }
+    void append(std::shared_ptr<const Buffer> buffer) {
+        if(!buffer) return;
+        link(buffer->beginRead(), buffer->readableBytes(), buffer);
+    }
+    /* data 在 release 被调用之前需要保持有效 */
+    void append(const void* data, size_t len, ReleaseCallback release) {
+        link(data, len, releaseOwner(data, std::move(release)));
+    }
+
+    /* 文件 fd 中 [offset, offset + len) 的数据，owner 保证 fd 在发送完成之前保持打开 */
+    void appendFile(int fd, off_t offset, size_t len, std::shared_ptr<const void> owner) {
+        if(len == 0) return;
+        Segment segment;
+        segment.fd = fd;
+        segment.offset = offset;
+        segment.end = len;
+        segment.owner = std::move(owner);
+        segments_.push_back(std::move(segment));
+        readable_ += len;
+    }
+
+    /* 在 owner 的最后一个引用释放时调用 release */
+    static std::shared_ptr<const void> releaseOwner(const void* data, ReleaseCallback release) {
+        return std::shared_ptr<const void>(data, [release = std::move(release)](const void*) {
+            if(release) release();
+        });
+    }
+
+    /* 按顺序填充至多 maxIovecs 个 iovec，返回填充的个数，遇到文件分段时停止 */
+    int peek(struct iovec* iov, int maxIovecs) const {
+        int count = 0;
+        for(auto iter = segments_.begin() + head_; iter != segments_.end() && count < maxIovecs; ++iter) {
+            if(iter->begin == iter->end) continue;
+            if(iter->fd >= 0) break;
+            iov[count].iov_base = const_cast<char*>(iter->data + iter->begin);
+            iov[count].iov_len  = iter->end - iter->begin;
+            ++count;
+        }
+        return count;
+    }
+
+    /* 截断 iov 使总长度不超过 maxBytes，返回截断后的个数 */
+    static int clamp(struct iovec* iov, int count, size_t maxBytes) {
+        for(int i = 0; i < count; ++i) {
+            if(iov[i].iov_len >= maxBytes) {
+                iov[i].iov_len = maxBytes;
+                return maxBytes == 0 ? i : i + 1;
+            }
+            maxBytes -= iov[i].iov_len;
+        }
+        return count;
+    }
+
+    /* 移动数据头，释放已经发送完的分段，自有分段的内存块归还 BlockPool */
+    void retrieve(size_t len) {
+        len = std::min(len, readable_);
+        readable_ -= len;
+        while(len > 0) {
+            Segment& head = segments_[head_];
+            size_t consumed = std::min(len, head.end - head.begin);
+            head.begin += consumed;
+            len -= consumed;
+            if(head.begin == head.end) popFront();
+        }
+    }
+    void retrieveAll() {
+        reset();
+        readable_ = 0;
+    }
+
+    /* 头部为不短于 minBytes 的外部分段时返回 true，并给出其待发送的数据与 owner，
+     * 零拷贝发送需要在内核的完成通知到达之前持有 owner */
+    bool peekLinked(size_t minBytes, struct iovec& iov, std::shared_ptr<const void>& owner) {
+        auto head = firstPending();
+        if(head == segments_.end() || head->block || head->fd >= 0) return false;
+        if(head->end - head->begin < minBytes) return false;
+        iov.iov_base = const_cast<char*>(head->data + head->begin);
+        iov.iov_len  = head->end - head->begin;
+        owner = head->owner;
+        return true;
+    }
+
+    /* 以一次 writev 发送至多 maxBytes 字节，头部为文件分段时以一次 sendfile 发送
+     * 暂时无法写入时返回 -1，其余错误抛出异常 */
+    ssize_t writeSocket(Socket sock, size_t maxBytes = SIZE_MAX) {
+        auto head = firstPending();
+        if(head != segments_.end() && head->fd >= 0) {
+            size_t len = std::min(head->end - head->begin, maxBytes);
+            ssize_t n = sock.sendFile(head->fd, head->offset + head->begin, len);
+            if(n > 0) retrieve(n);
+            return n;
+        }
+        struct iovec iov[kWriteIovecs];
+        int count = clamp(iov, peek(iov, kWriteIovecs), maxBytes);
+        if(count == 0) return 0;
+        ssize_t n = sock.writev(iov, count);
+        if(n > 0) retrieve(n);
+        return n;
+    }
+
+    /* 头部为文件分段时把其中至多 maxBytes 读入一个自有分段，供不能使用 sendfile 的发送路径使用
+     * 返回读入的字节数，头部不是文件分段时返回 0，读取失败或文件提前结束时返回 -1 */
+    ssize_t loadFile(size_t maxBytes) {
+        auto head = firstPending();
+        if(head == segments_.end() || head->fd < 0) return 0;
+        size_t len = std::min(maxBytes, head->end - head->begin);
+        Segment segment(BlockPool::allocate(len));
+        ssize_t n = ::pread(head->fd, segment.block, len, head->offset + head->begin);
+        if(n <= 0) return -1;
+        head->begin += n;
+        segment.end = n;
+        /* 读完的文件分段直接由新分段替换 */
+        if(head->begin == head->end) {
+            *head = std::move(segment);
+        } else {
+            segments_.insert(head, std::move(segment));
+        }
+        return n;
+    }
+
+private:
+    /* 自有分段独占其内存块，析构时归还给所在线程的 BlockPool，只能移动 */
+    struct Segment {
+        Segment() = default;
+        explicit Segment(BlockPool::Block memory)
+                : data(memory.data), block(memory.data), capacity(memory.capacity) {}
+        Segment(Segment&& rhs) noexcept { swap(rhs); }
+        Segment& operator=(Segment&& rhs) noexcept {
+            Segment(std::move(rhs)).swap(*this);
+            return *this;
+        }
+        ~Segment() {
+            if(block) BlockPool::deallocate({ block, capacity });
+        }
+        void swap(Segment& rhs) noexcept {
+            std::swap(data, rhs.data);
+            std::swap(begin, rhs.begin);
+            std::swap(end, rhs.end);
+            std::swap(block, rhs.block);
+            std::swap(capacity, rhs.capacity);
+            std::swap(fd, rhs.fd);
+            std::swap(offset, rhs.offset);
+            std::swap(owner, rhs.owner);
+        }
+
+        const char* data {nullptr};
+        size_t begin {0};               /* 已发送到的位置 */
+        size_t end {0};                 /* 有效数据的尾后位置 */
+        char* block {nullptr};          /* 自有分段的可写内存，外部分段为空 */
+        size_t capacity {0};
+        int fd {-1};                    /* 文件分段的 fd，内存分段为 -1 */
+        off_t offset {0};               /* 文件分段在文件中的起始偏移 */
+        std::shared_ptr<const void> owner; /* 保证外部分段的 data 在分段存在期间有效 */
+    };
+
+    Segment& allocate(size_t capacity) {
+        segments_.emplace_back(BlockPool::allocate(capacity));
+        return segments_.back();
+    }
+    /* 第一个尚有数据的分段 */
+    std::vector<Segment>::iterator firstPending() {
+        auto iter = segments_.begin() + head_;
+        while(iter != segments_.end() && iter->begin == iter->end) ++iter;
+        return iter;
+    }
+    /* 头部分段立刻释放，数组在全部发送完时清空，已发送的分段占到一半时整体前移 */
+    void popFront() {
+        segments_[head_++] = Segment();
+        if(head_ == segments_.size()) {
+            reset();
+        } else if(head_ * 2 >= segments_.size()) {
+            segments_.erase(segments_.begin(), segments_.begin() + head_);
+            head_ = 0;
+        }
+    }
+    void reset() {
+        if(segments_.capacity() > kKeepSegments) {
+            std::vector<Segment>().swap(segments_);
+        } else {
+            segments_.clear();
+        }
+        head_ = 0;
+    }
+
+    /* 以数组代替 std::deque，后者在构造时就会分配内存 */
+    std::vector<Segment> segments_;     /* [head_, size) 为尚未释放的分段 */
+    size_t head_ {0};
+    size_t readable_ {0};
+};
+
+} /* namespace esynet::utils */
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+namespace esynet::utils {
+
+/* 以 2 的幂为桶边界的直方图，第 0 个桶统计 0，第 i 个桶统计 [2^(i-1), 2^i) 内的值
+ * 记录只能由单个线程完成（不使用原子读改写指令），任意线程都可以调用 snapshot */
+class Histogram {
+public:
+    static const int kBuckets = 64;
+
+    struct Snapshot {
+        uint64_t count {0};
+        uint64_t sum   {0};
+        uint64_t max   {0};
+        std::array<uint64_t, kBuckets> buckets {};
+
+        double mean() const {
+            return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+        }
+        /* 近似分位数，返回所在桶的上界，不超过最大值 */
+        uint64_t percentile(double p) const {
+            if(count == 0) return 0;
+            uint64_t rank = static_cast<uint64_t>(p * count);
+            uint64_t seen = 0;
+            for(int i = 0; i < kBuckets; ++i) {
+                seen += buckets[i];
+                if(seen > rank) {
+                    uint64_t upper = i == 0 ? 0 : (1ULL << i) - 1;
+                    return std::min(upper, max);
+                }
+            }
+            return max;
+        }
+        Snapshot& merge(const Snapshot& other) {
+            count += other.count;
+            sum   += other.sum;
+            max    = std::max(max, other.max);
+            for(int i = 0; i < kBuckets; ++i) {
+                buckets[i] += other.buckets[i];
+            }
+            return *this;
+        }
+    };
+
+public:
+    void record(uint64_t value) {
+        int bucket = value == 0 ? 0 : std::min(64 - __builtin_clzll(value), kBuckets - 1);
+        increase(buckets_[bucket], 1);
+        increase(count_, 1);
+        increase(sum_, value);
+        if(value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+    Snapshot snapshot() const {
+        Snapshot snapshot;
+        snapshot.count = count_.load(std::memory_order_relaxed);
+        snapshot.sum   = sum_.load(std::memory_order_relaxed);
+        snapshot.max   = max_.load(std::memory_order_relaxed);
+        for(int i = 0; i < kBuckets; ++i) {
+            snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+private:
+    static void increase(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_ {};
+    std::atomic<uint64_t> count_ {0};
+    std::atomic<uint64_t> sum_   {0};
+    std::atomic<uint64_t> max_   {0};
+};
+
+} /* namespace esynet::utils */
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+
+namespace esynet::utils {
+
+/* 无锁多生产者单消费者队列（侵入式）
+ * Node 需包含 `Node* next` 成员，由使用者负责节点内存的分配与释放
+ *
+ * 生产者通过 CAS 将节点压入链表头，消费者一次性 exchange 取走整条链表
+ * 并翻转为入队顺序，因此消费者每次取出的是一个确定的快照，不会与后续的
+ * 生产者交错。push 的返回值标识该次入队是否使队列由空变为非空，调用者可以
+ * 据此只让“第一个”生产者去唤醒消费者 */
+template <typename Node>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue(MpscQueue&&) = delete;
+    ~MpscQueue() = default;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    MpscQueue& operator=(MpscQueue&&) = delete;
+
+    /* 线程安全，返回 true 表示队列此前为空 */
+    bool push(Node* node) {
+        Node* head = head_.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while(!head_.compare_exchange_weak(head, node,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+        return head == nullptr;
+    }
+
+    /* 仅消费者线程调用，按入队顺序返回链表头，队列为空时返回 nullptr */
+    Node* popAll() {
+        Node* head = head_.exchange(nullptr, std::memory_order_acquire);
+        Node* reversed = nullptr;
+        while(head) {
+            Node* next = head->next;
+            head->next = reversed;
+            reversed = head;
+            head = next;
+        }
+        return reversed;
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    std::atomic<Node*> head_{nullptr};
+};
+
+} /* namespace esynet::utils */
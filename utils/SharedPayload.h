@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstring>
+
+#include "Buffer.h"
+#include "StringPiece.h"
+
+namespace esynet::utils {
+
+/* 不可变、原子引用计数的发送数据，用于把同一条消息发送给大量连接
+ *
+ * 数据与引用计数在一次分配中构造，之后只读；可以被任意 Looper 上的连接同时持有，
+ * 每个连接的发送缓冲区只挂入一个引用，不做拷贝，所有连接发送完成后释放
+ * 副本之间共享数据，可以任意复制与跨线程传递 */
+class SharedPayload {
+public:
+    SharedPayload() = default;
+    SharedPayload(const void* data, size_t len)
+            : data_(std::make_shared_for_overwrite<char[]>(len)), size_(len) {
+        memcpy(data_.get(), data, len);
+    }
+    explicit SharedPayload(const StringPiece& str): SharedPayload(str.data(), str.size()) {}
+    explicit SharedPayload(const Buffer& buffer): SharedPayload(buffer.beginRead(), buffer.readableBytes()) {}
+
+    const char* data()  const { return data_.get(); }
+    size_t      size()  const { return size_; }
+    bool        empty() const { return size_ == 0; }
+    StringPiece view()  const { return StringPiece(data(), static_cast<int>(size_)); }
+    /* 当前持有该数据的引用数，包括发送缓冲区中尚未发送完的 */
+    long useCount() const { return data_.use_count(); }
+
+    /* 挂入发送缓冲区时使用的 owner，与本对象共享引用计数 */
+    std::shared_ptr<const void> owner() const { return data_; }
+
+private:
+    std::shared_ptr<char[]> data_;
+    size_t size_ {0};
+};
+
+} /* namespace esynet::utils */
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "NonCopyable.h"
+
+namespace esynet::utils {
+
+/* 定长对象的内存池，每次向系统申请 kSlotsPerChunk 个槽位，释放的槽位以侵入式单链表缓存，不归还系统
+ *
+ * 槽位大小由第一次分配确定，之后大小不同的请求直接使用 operator new/delete
+ * 只有创建 Slab 的线程（所属线程）可以分配，本线程的空闲链表不加锁；
+ * 其他线程归还的槽位（例如连接的最后一个引用在其他线程中释放）压入无锁的远程链表，
+ * 所属线程的空闲链表用尽时一次取走全部远程槽位 */
+class Slab : public NonCopyable {
+public:
+    static const size_t kSlotsPerChunk = 64;
+
+    struct Stats {
+        size_t slotSize {0};
+        size_t chunks {0};
+        size_t slotsInUse {0};
+    };
+
+    Slab() : owner_(std::this_thread::get_id()) {}
+    ~Slab() {
+        for(char* chunk : chunks_) ::operator delete(chunk);
+    }
+
+    /* 仅限所属线程调用 */
+    void* allocate(size_t size) {
+        if(slotSize_ == 0) slotSize_ = roundUp(size);
+        if(roundUp(size) != slotSize_) return ::operator new(size);
+        if(!head_) head_ = remote_.exchange(nullptr, std::memory_order_acquire);
+        if(!head_) grow();
+        FreeNode* node = head_;
+        head_ = node->next;
+        ++allocated_;
+        return node;
+    }
+    void deallocate(void* ptr, size_t size) {
+        if(roundUp(size) != slotSize_) {
+            ::operator delete(ptr);
+            return;
+        }
+        FreeNode* node = static_cast<FreeNode*>(ptr);
+        if(std::this_thread::get_id() == owner_) {
+            node->next = head_;
+            head_ = node;
+            --allocated_;
+            return;
+        }
+        /* 只有压入与整体取走两种操作，不存在 ABA 问题 */
+        node->next = remote_.load(std::memory_order_relaxed);
+        while(!remote_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                               std::memory_order_relaxed)) {}
+        remoteFreed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /* 仅限所属线程调用 */
+    Stats stats() const {
+        return { slotSize_, chunks_.size(), allocated_ - remoteFreed_.load(std::memory_order_relaxed) };
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    /* 槽位按 max_align_t 对齐，且能容纳空闲链表的指针 */
+    static size_t roundUp(size_t size) {
+        const size_t align = alignof(std::max_align_t);
+        size = std::max(size, sizeof(FreeNode));
+        return (size + align - 1) / align * align;
+    }
+    void grow() {
+        char* chunk = static_cast<char*>(::operator new(slotSize_ * kSlotsPerChunk));
+        chunks_.push_back(chunk);
+        for(size_t i = kSlotsPerChunk; i > 0; --i) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(chunk + (i - 1) * slotSize_);
+            node->next = head_;
+            head_ = node;
+        }
+    }
+
+    const std::thread::id owner_;
+    size_t slotSize_ {0};
+    size_t allocated_ {0};                  /* 分配数减去所属线程归还的数量 */
+    FreeNode* head_ {nullptr};
+    std::vector<char*> chunks_;
+    std::atomic<FreeNode*> remote_ {nullptr};
+    std::atomic<size_t> remoteFreed_ {0};
+};
+
+/* 从 Slab 分配的分配器，用于 std::allocate_shared，对象与控制块共用一个槽位
+ * 控制块持有分配器的副本，因此 Slab 的生命周期延续到最后一个对象被释放 */
+template<typename T>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    explicit SlabAllocator(std::shared_ptr<Slab> slab) : slab_(std::move(slab)) {}
+    template<typename U>
+    SlabAllocator(const SlabAllocator<U>& other) : slab_(other.slab()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(slab_->allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) {
+        slab_->deallocate(ptr, n * sizeof(T));
+    }
+
+    auto slab() const -> const std::shared_ptr<Slab>& { return slab_; }
+
+    template<typename U>
+    bool operator==(const SlabAllocator<U>& other) const { return slab_ == other.slab(); }
+
+private:
+    std::shared_ptr<Slab> slab_;
+};
+
+} /* namespace esynet::utils */
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+namespace esynet::utils {
+
+/* 以整数键索引的对象表，插入、查找、删除均为 O(1)
+ *
+ * 键的低 32 位为槽位序号，其上 16 位为槽位的代数，槽位每次被释放时代数加一，
+ * 因此已删除对象的键不会查到复用同一槽位的新对象；键的高 16 位不参与查找，留给使用者附加信息
+ * 对象紧密存放在数组中，删除时以最后一个对象填补空位，遍历的顺序与插入顺序无关
+ * 非线程安全 */
+template<typename T>
+class SlotMap {
+public:
+    using Key = uint64_t;
+
+    static const int kIndexBits      = 32;
+    static const int kGenerationBits = 16;
+    static const Key kKeyMask        = (Key(1) << (kIndexBits + kGenerationBits)) - 1;
+    /* 代数从 1 开始，0 不会是有效的键 */
+    static const Key kNullKey        = 0;
+
+    /* 下一次 insert 返回的键 */
+    auto nextKey() const -> Key {
+        if(freeHead_ != kNone) return makeKey(freeHead_, slots_[freeHead_].generation);
+        return makeKey(static_cast<uint32_t>(slots_.size()), 1);
+    }
+    auto insert(T value) -> Key {
+        uint32_t slot;
+        if(freeHead_ != kNone) {
+            slot = freeHead_;
+            freeHead_ = slots_[slot].index;
+        } else {
+            slot = static_cast<uint32_t>(slots_.size());
+            slots_.push_back({ 0, 1 });
+        }
+        Key key = makeKey(slot, slots_[slot].generation);
+        slots_[slot].index = static_cast<uint32_t>(values_.size());
+        values_.push_back(std::move(value));
+        keys_.push_back(key);
+        return key;
+    }
+    auto find(Key key) -> T* {
+        uint32_t dense = locate(key);
+        return dense == kNone ? nullptr : &values_[dense];
+    }
+    auto find(Key key) const -> const T* {
+        uint32_t dense = locate(key);
+        return dense == kNone ? nullptr : &values_[dense];
+    }
+    bool contains(Key key) const { return locate(key) != kNone; }
+    /* 最后一个对象移入被删除的位置，键不变 */
+    bool erase(Key key) {
+        uint32_t dense = locate(key);
+        if(dense == kNone) return false;
+        uint32_t slot = indexOf(key);
+        uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+        if(dense != last) {
+            values_[dense] = std::move(values_[last]);
+            keys_[dense]   = keys_[last];
+            slots_[indexOf(keys_[dense])].index = dense;
+        }
+        values_.pop_back();
+        keys_.pop_back();
+        Slot& freed = slots_[slot];
+        freed.generation = freed.generation == kMaxGeneration ? 1 : freed.generation + 1;
+        freed.index = freeHead_;
+        freeHead_ = slot;
+        return true;
+    }
+    void clear() {
+        while(!keys_.empty()) erase(keys_.back());
+    }
+
+    auto size() const -> size_t { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+    /* 与对象下标一致的键 */
+    auto keys() const -> const std::vector<Key>& { return keys_; }
+
+    auto begin()       { return values_.begin(); }
+    auto end()         { return values_.end(); }
+    auto begin() const { return values_.begin(); }
+    auto end()   const { return values_.end(); }
+
+private:
+    /* 占用时 index 为对象的下标，空闲时为下一个空闲槽位 */
+    struct Slot {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    static const uint32_t kNone          = UINT32_MAX;
+    static const uint32_t kMaxGeneration = (1u << kGenerationBits) - 1;
+
+    static Key makeKey(uint32_t slot, uint32_t generation) {
+        return static_cast<Key>(slot) | static_cast<Key>(generation) << kIndexBits;
+    }
+    static uint32_t indexOf(Key key) {
+        return static_cast<uint32_t>(key);
+    }
+    /* 返回对象的下标，键无效时返回 kNone */
+    uint32_t locate(Key key) const {
+        key &= kKeyMask;
+        uint32_t slot = indexOf(key);
+        if(slot >= slots_.size()) return kNone;
+        uint32_t dense = slots_[slot].index;
+        if(dense >= keys_.size() || keys_[dense] != key) return kNone;
+        return dense;
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<T> values_;
+    std::vector<Key> keys_;
+    uint32_t freeHead_ {kNone};
+};
+
+} /* namespace esynet::utils */
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+#include "NonCopyable.h"
+
+namespace esynet::utils {
+
+/* 以字节计量的令牌桶，rate 为每秒补充的令牌数，burst 为容量，即允许的突发量
+ *
+ * 以 GCRA 的形式实现：只记录令牌桶被取空的时刻 empty_，当前的令牌数为 (now - empty_) * rate，
+ * 超过容量时按容量计；取出 n 个令牌即把 empty_ 向后推 n / rate
+ * 状态只有一个原子变量，可以由多个 Looper 线程共享（例如服务器级的总带宽）；
+ * 取令牌时允许透支，透支的部分由之后的等待偿还；时间单位均为纳秒 */
+class TokenBucket : public NonCopyable {
+public:
+    TokenBucket(double rate, size_t burst)
+            : rate_(rate), burst_(std::max<size_t>(burst, 1)),
+              burstNs_(costOf(burst_)), empty_(now() - burstNs_) {}
+
+    static int64_t now() {
+        using namespace std::chrono;
+        return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    double rate()  const { return rate_; }
+    size_t burst() const { return burst_; }
+
+    /* 当前可以取出的令牌数 */
+    size_t available(int64_t now = TokenBucket::now()) const {
+        int64_t empty = std::max(empty_.load(std::memory_order_relaxed), now - burstNs_);
+        if(empty >= now) return 0;
+        return static_cast<size_t>(static_cast<double>(now - empty) * rate_ / kNsPerSecond);
+    }
+    void consume(size_t tokens, int64_t now = TokenBucket::now()) {
+        int64_t cost = costOf(tokens);
+        int64_t empty = empty_.load(std::memory_order_relaxed);
+        while(!empty_.compare_exchange_weak(empty, std::max(empty, now - burstNs_) + cost,
+                                            std::memory_order_relaxed)) {}
+    }
+    /* 可以取出的令牌达到 tokens（至多为容量）还需等待的纳秒数 */
+    int64_t waitFor(size_t tokens, int64_t now = TokenBucket::now()) const {
+        int64_t empty = std::max(empty_.load(std::memory_order_relaxed), now - burstNs_);
+        int64_t ready = empty + costOf(std::min(tokens, burst_));
+        return std::max<int64_t>(ready - now, 0);
+    }
+
+private:
+    static constexpr double kNsPerSecond = 1e9;
+
+    int64_t costOf(size_t tokens) const {
+        return static_cast<int64_t>(static_cast<double>(tokens) * kNsPerSecond / rate_);
+    }
+
+    const double  rate_;
+    const size_t  burst_;
+    const int64_t burstNs_;         /* 补满整个令牌桶所需的时间 */
+    std::atomic<int64_t> empty_;
+};
+
+} /* namespace esynet::utils */